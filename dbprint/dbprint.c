@@ -2,7 +2,7 @@
  * @file dbprint.c
  * @brief Homebrew println/printf replacement "DeBugPrint".
  * @details Originally designed for use on the Silicion Labs Happy Gecko EFM32 board (EFM32HG322 -- TQFP48).
- * @version 7.0
+ * @version 7.25
  * @author Brecht Van Eeckhoudt
  *
  * ******************************************************************************
@@ -42,6 +42,42 @@
  *             Removed `extern` from the documentation.
  *   @li v6.2: Removed `static` before the local variables (not necessary).
  *   @li v7.0: Updated documentation.
+ *   @li v7.1: Added an interrupt driven TX queue (ring buffer) so the print methods don't block in interrupt mode.
+ *   @li v7.2: Added `dbprint_INIT_config` and a gapless TX mode using the TX buffer level interrupt and double writes,
+ *             the settings are also available if dbprint is disabled (`DEBUG_DBPRINT` is `0`).
+ *   @li v7.3: Added a DMA TX mode (`DBPRINT_DMA`) which transmits the TX queue in contiguous chunks.
+ *   @li v7.4: Added tokenized logging (`DBPRINT_TOKENIZED`) and the host-side decoder `tools/dbdecode.cpp`.
+ *   @li v7.5: Made `uint32_to_charDec` division-free (reciprocal multiplication and a two-digit lookup table),
+ *             fixed printing `INT32_MIN` and ten digit values.
+ *   @li v7.6: Added compile-time level filtering (`DBPRINT_LEVEL`) and `dbtrace(Int)(_hex)` methods.
+ *   @li v7.7: Info, warning, ... records are assembled from parts (without copying them) and submitted as one unit
+ *             (`dbprint_writev`), redundant color codes are left out.
+ *   @li v7.8: Made the TX queue safe to use from interrupt handlers (multiple producers reserve and commit records),
+ *             records are reserved as one unit (`DBPRINT_RECORD_SIZE`, longer unleveled data is split up) and
+ *             `dbprintln`, `dbprint(ln)Int(_hex)` and `dbprintln_color` are written as one record.
+ *   @li v7.9: Added a selectable overflow policy for the TX queue, a drop counter and a `[N records dropped]` marker
+ *             (formatted and moved with interrupts enabled, queued markers can be dropped and add their count to the next one).
+ *   @li v7.10: Added statistics of the logging path (`dbprint_stats`, `dbprintStats` and `dbprintStats_reset`),
+ *              `dbprint_stats` zeroes them if dbprint is disabled.
+ *   @li v7.11: Replaced the RX buffer by a queue of lines with in-place access (`dbGet_RXline` and `dbRelease_RXline`).
+ *   @li v7.12: Added instances (`dbprint_t`) and `_ctx` methods so USART0 and USART1 can be used at the same time,
+ *              the methods without `_ctx` use a default instance. Interrupts of a peripheral without an instance
+ *              are ignored (and disabled), instances can be declared without warnings if dbprint is disabled.
+ *   @li v7.13: Added a LEUART backend (`init.leuart`, 9600 baud, `DBPRINT_LEUART`) so the TX queue keeps draining in EM2.
+ *   @li v7.14: Added `dbFlush` and `dbFlush_timeout` (only for the data committed before the call), waiting for the TX queue (and `OVERFLOW_BLOCK`) now sleeps in EM1.
+ *   @li v7.15: Added `init.idleGating` (`DBPRINT_IDLE_GATING`) to gate the clock of USARTx while the TX queue is idle.
+ *   @li v7.16: Added optional timestamps (`init.timestamp`), sent as a delta to the previous record (mask `0` - All bits).
+ *              The counter also measures the timeout of `dbFlush_timeout` and the idle time before the clock gets gated
+ *              (`init.idleThreshold`, `dbIdle_poll`).
+ *   @li v7.17: Added a compression stage (`init.compress`, `DBPRINT_COMPRESS`) between the TX queue and USARTx.
+ *   @li v7.18: Added `dbprint_frame` to send binary data in COBS frames with a CRC-16.
+ *   @li v7.19: Added `dbHexdump`, `TO_HEX` now uses a lookup table.
+ *   @li v7.20: Added `dbprintn`, the length of strings is determined one word at a time (through a `may_alias` type, the aligned over-read is excluded from AddressSanitizer).
+ *   @li v7.21: The color codes and prefixes are looked up in tables of literals (length known at compile time).
+ *   @li v7.22: Added `init.banner` (fast start), the pins of USARTx and LEUART0 are looked up in a table.
+ *   @li v7.23: Added a parser for received numbers (`init.rxParse`, `DBPRINT_RX_PARSE`) and `dbGet_RXvalue`.
+ *   @li v7.24: Added `dbShell` to execute received commands (perfect hash table generated by `tools/dbshellgen.cpp`).
+ *   @li v7.25: Added `dbReadAsync` to deliver received lines, byte counts and timeouts to a callback.
  *
  * ******************************************************************************
  *
@@ -86,6 +122,7 @@
  ******************************************************************************/
 
 
+#define DBPRINT_SOURCE         /* The public methods are defined here, not replaced by macros */
 #include "debug_dbprint.h" /* Enable or disable printing to UART for debugging */
 
 #if DEBUG_DBPRINT == 1 /* DEBUG_DBPRINT */
@@ -94,14 +131,75 @@
 #include <stdint.h>        /* (u)intXX_t */
 #include <stdbool.h>       /* "bool", "true", "false" */
 #include "em_cmu.h"        /* Clock Management Unit */
+#include "em_core.h"       /* Core interrupt handling API (critical sections) */
+#include "em_emu.h"        /* Energy Management Unit (EMU) Peripheral API (sleep in EM1) */
 #include "em_gpio.h"       /* General Purpose IO (GPIO) peripheral API */
 #include "em_usart.h"      /* Universal synchr./asynchr. receiver/transmitter (USART/UART) Peripheral API */
+#if DBPRINT_LEUART == 1
+#include "em_leuart.h"     /* Low Energy Universal Asynchronous Receiver/Transmitter (LEUART) Peripheral API */
+#endif
+#if DBPRINT_DMA == 1
+#include "em_dma.h"        /* Direct Memory Access (DMA) API */
+#include "dmactrl.h"       /* DMA control block (dmaControlBlock) */
+#endif
+#if DBPRINT_IDLE_GATING == 1
+#include "gpiointerrupt.h" /* GPIOINT API (interrupt on the RX pin, emdrv) */
+#endif
 
 
 /* Local definitions */
-/* Macro definitions that return a character when given a value */
-#define TO_HEX(i) (i <= 9 ? '0' + i : 'A' - 10 + i) /* "?:" = ternary operator (return ['0' + i] if [i <= 9] = true, ['A' - 10 + i] if false) */
-#define TO_DEC(i) (i <= 9 ? '0' + i : '?') /* return "?" if out of range */
+/* Macro definition that returns a character when given a value (0 - 15, looked up in "hexChars") */
+#define TO_HEX(i) (hexChars[(i)])
+
+/* Mask to wrap the indices of the TX queue (DBPRINT_TX_BUFFER_SIZE is a power of two) */
+#define TX_MASK (DBPRINT_TX_BUFFER_SIZE - 1)
+
+/* Mask to wrap the indices of the RX queue (DBPRINT_RX_LINES is a power of two) */
+#define RX_MASK (DBPRINT_RX_LINES - 1)
+
+/* Mask to wrap the indices of the value queue (DBPRINT_RX_VALUES is a power of two) */
+#define VALUE_MASK (DBPRINT_RX_VALUES - 1)
+
+/* States of the parser for received numbers (see "rx_parse") */
+#define PARSE_IDLE       0 /* Waiting for a number */
+#define PARSE_SIGN       1 /* Sign received, no digits yet */
+#define PARSE_ZERO       2 /* "0" received, can be the start of "0x" */
+#define PARSE_DECIMAL    3 /* Decimal digits */
+#define PARSE_HEX_PREFIX 4 /* "0x" received, no digits yet */
+#define PARSE_HEX        5 /* Hexadecimal digits */
+#define PARSE_INVALID    6 /* Malformed or out of range, skipped until the next separator */
+
+/* Mask to wrap the indices of the record list of the TX queue (DBPRINT_TX_RECORDS is a power of two) */
+#define RECORD_MASK (DBPRINT_TX_RECORDS - 1)
+
+/* Macro definition that returns "true" if an instance uses LEUART0 instead of USARTx (never without DBPRINT_LEUART) */
+#if DBPRINT_LEUART == 1
+#define USES_LEUART(db) ((db)->leuart != NULL)
+#else
+#define USES_LEUART(db) false
+#endif
+
+/* Port of a pin that isn't available on a location (see "usartPins") */
+#define PIN_NONE 0xFF
+
+/* Amount of locations of USARTx (see "usartPins") */
+#define USART_LOCATIONS 7
+
+/* Amount of locations of LEUART0 (see "leuartPins") */
+#define LEUART_LOCATIONS 5
+
+/* Amount of bytes on one line of "dbHexdump" */
+#define HEXDUMP_ROW 16
+
+/* Level of the "[N records dropped]" marker in the record list */
+#define LEVEL_MARKER 0
+
+/* Maximum amount of parts and values of a record (see "record_t") */
+#define RECORD_PARTS   12
+#define RECORD_NUMBERS 2
+
+/* Maximum amount of transfers in one DMA cycle (the descriptor has a 10-bit "n_minus_1" field) */
+#define DMA_MAX_CHUNK 1024
 
 /* ANSI colors */
 #define COLOR_RED     "\x1b[31m"
@@ -113,20 +211,210 @@
 #define COLOR_RESET   "\x1b[0m"
 
 
-/** Local variable to store the settings (pointer). */
-USART_TypeDef* dbpointer;
+/** Local struct type for a string literal with its length (determined at compile time, see `LITERAL`). */
+typedef struct
+{
+	const char *text;
+	uint8_t length;
+} literal_t;
+
+/* Macro definition to initialize a "literal_t" (only works with string literals, not pointers) */
+#define LITERAL(string) { (string), sizeof(string) - 1 }
+
+/* The aligned over-read of "string_length" is intentional, AddressSanitizer (host tests) would report it */
+#if defined(__SANITIZE_ADDRESS__)
+#define NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#endif
+#endif
+#ifndef NO_SANITIZE_ADDRESS
+#define NO_SANITIZE_ADDRESS
+#endif
+
+/** Local type to read four characters at a time (`may_alias`: characters may be read through it, see `string_length`). */
+typedef uint32_t __attribute__((__may_alias__)) word_t;
+
+/** Local struct type for the pins and routing of a location of USARTx or LEUART0 (see `usartPins` and `leuartPins`). */
+typedef struct
+{
+	uint32_t route; /* USART_ROUTE_LOCATION_LOCx or LEUART_ROUTE_LOCATION_LOCx */
+	uint8_t rxPort; /* GPIO_Port_TypeDef, PIN_NONE if the location has no RX pin */
+	uint8_t rxPin;
+	uint8_t txPort; /* GPIO_Port_TypeDef, PIN_NONE if the location has no TX pin */
+	uint8_t txPin;
+} usart_pins_t;
+
+/** Local struct type for a part of a record (see `dbprint_writev`). */
+typedef struct
+{
+	const char *data;
+	uint32_t length;
+} part_t;
+
+/** Local struct type to assemble a record from parts before submitting it as one unit. */
+typedef struct
+{
+	part_t parts[RECORD_PARTS];
+	uint32_t count;
+	char numbers[RECORD_NUMBERS][12]; /* Formatted values ("-2147483648" or "0xFFFF FFFF" + NULL) */
+	uint32_t numberCount;
+	uint8_t level;
+	bool split;    /* Unleveled data: written as several records instead of truncated (see "dbprint_writev") */
+	dbprint_t *db; /* Instance the record is written to */
+} record_t;
+
+/** Local struct type for the records dropped to make room (see `tx_drop` and `tx_move`). */
+typedef struct
+{
+	uint32_t keep;    /* Characters of the oldest record that aren't transmitted yet */
+	uint32_t end;     /* End of the dropped records */
+	uint32_t next;    /* First record that isn't dropped */
+	uint32_t dropped; /* Dropped records (not counting markers) */
+	uint32_t counted; /* Records counted by the dropped markers */
+} drop_t;
+
+/** Local constant with the hexadecimal characters (lookup table of `TO_HEX`). */
+static const char hexChars[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+
+/** Local constant with the color codes (index: `dbprint_color_t`, `DEFAULT_COLOR` resets the color). */
+static const literal_t colorCodes[] =
+{
+	LITERAL(COLOR_RED),
+	LITERAL(COLOR_GREEN),
+	LITERAL(COLOR_BLUE),
+	LITERAL(COLOR_CYAN),
+	LITERAL(COLOR_MAGENTA),
+	LITERAL(COLOR_YELLOW),
+	LITERAL(COLOR_RESET)
+};
+
+/** Local constant with the color of the records (index: `DBPRINT_LEVEL_XXX - 1`). */
+static const dbprint_color_t levelColors[] = { RED, YELLOW, DEFAULT_COLOR, DEFAULT_COLOR };
+
+/** Local constant with the start of the records, color code and prefix as one literal (index: `DBPRINT_LEVEL_XXX - 1`). */
+static const literal_t levelHeads[] =
+{
+	LITERAL(COLOR_RED "CRIT: "),
+	LITERAL(COLOR_YELLOW "WARN: "),
+	LITERAL("INFO: "),
+	LITERAL("TRACE: ")
+};
+
+/** Local constant with the end of a record that is truncated to `DBPRINT_RECORD_SIZE` characters (resets the color). */
+static const literal_t truncatedMarker = LITERAL(COLOR_RESET "[truncated]\r\n");
+
+/** Local constant with the pins of USART0 and USART1 (index: USARTx, location). */
+static const usart_pins_t usartPins[2][USART_LOCATIONS] =
+{
+	{ /* USART0 */
+		{ USART_ROUTE_LOCATION_LOC0, gpioPortE, 11, gpioPortE, 10 },
+		{ USART_ROUTE_LOCATION_LOC1, PIN_NONE, 0, PIN_NONE, 0 },
+		{ USART_ROUTE_LOCATION_LOC2, gpioPortC, 10, PIN_NONE, 0 },
+		{ USART_ROUTE_LOCATION_LOC3, gpioPortE, 12, gpioPortE, 13 },
+		{ USART_ROUTE_LOCATION_LOC4, gpioPortB, 8, gpioPortB, 7 },
+		{ USART_ROUTE_LOCATION_LOC5, gpioPortC, 1, gpioPortC, 0 },
+		{ USART_ROUTE_LOCATION_LOC6, gpioPortC, 1, gpioPortC, 0 }
+	},
+	{ /* USART1 */
+		{ USART_ROUTE_LOCATION_LOC0, gpioPortC, 1, gpioPortC, 0 },
+		{ USART_ROUTE_LOCATION_LOC1, PIN_NONE, 0, PIN_NONE, 0 },
+		{ USART_ROUTE_LOCATION_LOC2, gpioPortD, 6, gpioPortD, 7 },
+		{ USART_ROUTE_LOCATION_LOC3, gpioPortD, 6, gpioPortD, 7 },
+		{ USART_ROUTE_LOCATION_LOC4, gpioPortA, 0, gpioPortF, 2 },
+		{ USART_ROUTE_LOCATION_LOC5, gpioPortC, 2, gpioPortC, 1 },
+		{ USART_ROUTE_LOCATION_LOC6, PIN_NONE, 0, PIN_NONE, 0 }
+	}
+};
+
+#if DBPRINT_LEUART == 1
+/** Local constant with the pins of LEUART0 (index: location). */
+static const usart_pins_t leuartPins[LEUART_LOCATIONS] =
+{
+	{ LEUART_ROUTE_LOCATION_LOC0, gpioPortD, 5, gpioPortD, 4 },
+	{ LEUART_ROUTE_LOCATION_LOC1, gpioPortB, 14, gpioPortB, 13 },
+	{ LEUART_ROUTE_LOCATION_LOC2, gpioPortE, 15, gpioPortE, 14 },
+	{ LEUART_ROUTE_LOCATION_LOC3, gpioPortF, 1, gpioPortF, 0 },
+	{ LEUART_ROUTE_LOCATION_LOC4, gpioPortA, 0, gpioPortF, 2 }
+};
+#endif
+
+/** Local variable with the default instance (used by the methods without `_ctx`). */
+dbprint_t dbdefault;
 
-/* Local variables to store data */
-/*   -> Volatile because it's modified by an interrupt service routine (@RAM) */
-volatile bool dataReceived = false; /* true if there is a line of data received */
-volatile char rx_buffer[DBPRINT_BUFFER_SIZE];
-volatile char tx_buffer[DBPRINT_BUFFER_SIZE];
+/* Local variable with the instances that are served by the USART0, USART1 and LEUART0 interrupt handlers
+ *   -> Set by "dbprint_INIT_config_ctx" (interrupt mode), index 0 for USART0, 1 for USART1 and 2 for LEUART0
+ *   -> A handler disables its interrupt (stray interrupt) if its entry is still NULL */
+dbprint_t *dbcontext[3] = { NULL, NULL, NULL };
 
 
 /* Local prototypes */
+static void dbprint_record (dbprint_t *db, uint8_t level, char *message1, int32_t value, char notation, char *message2);
+static void dbprint_colorRecord (dbprint_t *db, char *message, dbprint_color_t color, bool newline);
+static void dbprint_valueRecord (dbprint_t *db, int32_t value, char notation, bool newline);
+static void record_start (record_t *record, dbprint_t *db, uint8_t level);
+static void record_append (record_t *record, const char *string);
+static void record_appendn (record_t *record, const char *data, uint32_t length);
+static void record_appendInt (record_t *record, int32_t value, char notation);
+static void record_submit (record_t *record);
+static uint8_t token_level (uint32_t token);
+static uint8_t token_start (dbprint_t *db, uint8_t *buf);
+static bool timestamp_delta (dbprint_t *db, uint32_t *delta);
+static bool dbprint_write (dbprint_t *db, const char *data, uint32_t length, uint8_t level);
+static bool dbprint_writev (dbprint_t *db, const part_t *parts, uint32_t count, uint8_t level, bool split);
+static uint32_t tx_copy (dbprint_t *db, uint32_t index, const char *data, uint32_t length);
+static bool tx_reserve (dbprint_t *db, uint32_t length, uint8_t level, uint32_t *index);
+static bool tx_drop (dbprint_t *db, uint32_t length, uint32_t records, uint8_t level, drop_t *drop);
+static void tx_move (dbprint_t *db, const drop_t *drop);
+static void tx_commit (dbprint_t *db);
+static void tx_start (dbprint_t *db);
+static void tx_stop (dbprint_t *db);
+#if DBPRINT_LEUART == 1
+static void leuart_init (dbprint_t *db, uint8_t location);
+#endif
+static void uart_write (dbprint_t *db, char data);
+static char uart_read (dbprint_t *db);
+static void uart_intEnable (dbprint_t *db, uint32_t flags);
+static void uart_intDisable (dbprint_t *db, uint32_t flags);
+static void uart_intSet (dbprint_t *db, uint32_t flags);
+static void uart_intClear (dbprint_t *db, uint32_t flags);
+static uint32_t uart_intGet (dbprint_t *db, bool enabled);
+static bool uart_txIdle (dbprint_t *db);
+#if DBPRINT_IDLE_GATING == 1
+static void gate_init (dbprint_t *db, uint8_t location);
+static bool gate_idle (dbprint_t *db);
+static void gate_check (dbprint_t *db);
+static void gate_close (dbprint_t *db);
+static void gate_open (dbprint_t *db);
+static void gate_rxWake (uint8_t pin);
+#endif
+#if DBPRINT_COMPRESS == 1
+static void pack_block (dbprint_t *db);
+static void pack_handler (dbprint_t *db, uint32_t flags);
+#endif
+static uint8_t uint32_to_varint (uint8_t *buf, uint32_t value);
+static uint32_t string_length (const char *string);
+static bool string_equal (const char *string1, const char *string2);
+static uint32_t shell_hash (const char *name, uint32_t seed);
+static void shell_help (dbprint_t *db, const dbprint_shell_t *shell);
+static uint16_t crc16_update (uint16_t crc, uint8_t data);
+static uint32_t cobs_encode (uint8_t *buf, const uint8_t *data, uint32_t length);
+#if DBPRINT_DMA == 1
+static void dma_init (dbprint_t *db);
+static void dma_next (dbprint_t *db);
+static void dma_done (unsigned int channel, bool primary, void *user);
+#endif
 static void uint32_to_charHex (char *buf, uint32_t value, bool spacing);
 static void uint32_to_charDec (char *buf, uint32_t value);
 static uint32_t charDec_to_uint32 (char *buf);
+static void rx_handler (dbprint_t *db);
+static void rx_queue (dbprint_t *db, uint32_t length, dbprint_rxevent_t event);
+static void rx_deliver (dbprint_t *db);
+#if DBPRINT_RX_PARSE == 1
+static void rx_parse (dbprint_t *db, char received);
+#endif
+static void tx_handler (dbprint_t *db);
 //static uint32_t charHex_to_uint32 (char *buf); // Unused but kept here just in case
 
 
@@ -134,6 +422,9 @@ static uint32_t charDec_to_uint32 (char *buf);
  * @brief
  *   Initialize USARTx.
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] pointer
  *   Pointer to USARTx.
  *
@@ -147,11 +438,129 @@ static uint32_t charDec_to_uint32 (char *buf);
  * @param[in] interrupts
  *   @li `true` - Enable interrupt functionality.
  *   @li `false` - No interrupt functionality is initialized.
+ *
+ * @note
+ *   In interrupt mode the TX buffer level interrupt is used, call
+ *   `dbprint_INIT_config` to select another TX mode.
  *****************************************************************************/
-void dbprint_INIT (USART_TypeDef* pointer, uint8_t location, bool vcom, bool interrupts)
+void dbprint_INIT_ctx (dbprint_t *db, USART_TypeDef* pointer, uint8_t location, bool vcom, bool interrupts)
 {
-	/* Store the pointer in the global variable */
-	dbpointer = pointer;
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+
+	init.pointer = pointer;
+	init.location = location;
+	init.vcom = vcom;
+	init.interrupts = interrupts;
+
+	dbprint_INIT_config_ctx(db, &init);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Initialize USARTx using a struct with all of the settings.
+ *
+ * @details
+ *   Example usage: @n
+ *   `dbprint_init_t init = DBPRINT_INIT_DEFAULT;` @n
+ *   `init.txMode = TX_COMPLETE;` @n
+ *   `dbprint_INIT_config(&init);`
+ *
+ * @note
+ *   `TX_DMA` mode is only available if `DBPRINT_DMA` is `1` (`dbprint.h`).
+ *   The DMA controller only gets (re)initialized if it isn't already enabled,
+ *   so other DMA channels configured by the application keep working.
+ *
+ * @note
+ *   In interrupt mode the welcome banner is put in the TX queue and
+ *   transmitted in the background. Without interrupts it's transmitted
+ *   before this method returns (about 20 ms at 115200 baud), use
+ *   `init.banner = false;` to skip it (fast start).
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] init
+ *   Pointer to the initialization settings, see `dbprint_init_t`.
+ *****************************************************************************/
+void dbprint_INIT_config_ctx (dbprint_t *db, const dbprint_init_t *init)
+{
+	uint8_t location = init->location;
+
+	/* Store the settings in the instance (only one of both pointers is used) */
+#if DBPRINT_LEUART == 1
+	db->leuart = init->leuart;
+	db->pointer = (init->leuart != NULL) ? NULL : init->pointer;
+#else
+	db->pointer = init->pointer;
+#endif
+	db->txMode = init->txMode;
+	db->txOverflow = init->overflow;
+	db->timestamp = init->timestamp;
+	db->timestampMask = init->timestampMask;
+
+	/* Mask 0 (DBPRINT_INIT_DEFAULT) would make every delta 0 and a timeout would never pass: use all bits */
+	if ((db->timestamp != NULL) && (db->timestampMask == 0)) db->timestampMask = 0xFFFFFFFF;
+	db->timestampLast = (init->timestamp != NULL) ? *init->timestamp : 0;
+
+	/* Start with an empty TX queue, only used in interrupt mode */
+	db->txQueued = false;
+	db->txBusy = false;
+	db->txUsed = false;
+	db->txHead = 0;
+	db->txCommit = 0;
+	db->txTail = 0;
+	db->txPending = 0;
+	db->recordHead = 0;
+	db->recordTail = 0;
+	db->txDropped = 0;
+	db->txMoving = false;
+	db->frameSeq = 0;
+	dbprintStats_reset_ctx(db);
+
+	/* Start with an empty RX queue, only used in interrupt mode */
+	db->rxHead = 0;
+	db->rxTail = 0;
+	db->rxIndex = 0;
+	db->rxDropping = false;
+
+	/* Received lines are polled until a callback is registered (dbReadAsync_ctx) */
+	db->rxCallback = NULL;
+	db->rxDeferred = false;
+	db->rxCount = 0;
+	db->rxTimeout = 0;
+	db->rxWaiting = false;
+	db->rxTimedOut = false;
+	db->rxDelivering = false;
+
+#if DBPRINT_IDLE_GATING == 1
+	/* Clock gating is only possible with USARTx in interrupt mode */
+	db->idleGating = init->idleGating && init->interrupts && !USES_LEUART(db);
+	db->gated = false;
+
+	/* The idle threshold is measured with the counter of init.timestamp, without one it's refused (no gating) */
+	db->idleThreshold = init->idleThreshold;
+	db->idleWaiting = false;
+	if ((db->idleThreshold != 0) && (db->timestamp == NULL)) db->idleGating = false;
+#endif
+
+#if DBPRINT_RX_PARSE == 1
+	/* The parser runs in the RX handler, it's only possible in interrupt mode */
+	db->rxParse = init->rxParse && init->interrupts;
+	db->parseState = PARSE_IDLE;
+	db->valueHead = 0;
+	db->valueTail = 0;
+#endif
+
+#if DBPRINT_COMPRESS == 1
+	/* The DMA controller reads the TX queue directly, compression isn't possible then */
+	db->compress = init->compress && init->interrupts;
+#if DBPRINT_DMA == 1
+	if (db->txMode == TX_DMA) db->compress = false;
+#endif
+	db->packIndex = 0;
+	db->packLength = 0;
+#endif
 
 	/*
 	 * USART_INITASYNC_DEFAULT:
@@ -177,160 +586,150 @@ void dbprint_INIT (USART_TypeDef* pointer, uint8_t location, bool vcom, bool int
 
 
 	/* Enable oscillator to USARTx modules */
-	if (dbpointer == USART0)
+	if (db->pointer == USART0)
 	{
 		CMU_ClockEnable(cmuClock_USART0, true);
 	}
-	else if (dbpointer == USART1)
+	else if (db->pointer == USART1)
 	{
 		CMU_ClockEnable(cmuClock_USART1, true);
 	}
 
 
 	/* Set PA9 (EFM_BC_EN) high if necessary to enable the isolation switch */
-	if (vcom)
+	if (init->vcom)
 	{
 		GPIO_PinModeSet(gpioPortA, 9, gpioModePushPull, 1);
 		GPIO_PinOutSet(gpioPortA, 9);
 	}
 
 
-	/* Set pin modes for UART TX and RX pins */
-	if (dbpointer == USART0)
-	{
-		switch (location)
-		{
-			case 0:
-				GPIO_PinModeSet(gpioPortE, 11, gpioModeInput, 0);    /* RX */
-				GPIO_PinModeSet(gpioPortE, 10, gpioModePushPull, 1); /* TX */
-				break;
-			case 2:
-				GPIO_PinModeSet(gpioPortC, 10, gpioModeInput, 0);    /* RX */
-				/* No TX pin in this mode */
-				break;
-			case 3:
-				GPIO_PinModeSet(gpioPortE, 12, gpioModeInput, 0);    /* RX */
-				GPIO_PinModeSet(gpioPortE, 13, gpioModePushPull, 1); /* TX */
-				break;
-			case 4:
-				GPIO_PinModeSet(gpioPortB, 8, gpioModeInput, 0);     /* RX */
-				GPIO_PinModeSet(gpioPortB, 7, gpioModePushPull, 1);  /* TX */
-				break;
-			case 5:
-			case 6:
-				GPIO_PinModeSet(gpioPortC, 1, gpioModeInput, 0);     /* RX */
-				GPIO_PinModeSet(gpioPortC, 0, gpioModePushPull, 1);  /* TX */
-				break;
-			/* default: */
-				/* No default */
-		}
-	}
-	else if (dbpointer == USART1)
+	/* Set pin modes for UART TX and RX pins (looked up in the table, nothing is done for unknown locations) */
+	if (!USES_LEUART(db) && (location < USART_LOCATIONS))
 	{
-		switch (location)
-		{
-			case 0:
-				GPIO_PinModeSet(gpioPortC, 1, gpioModeInput, 0);     /* RX */
-				GPIO_PinModeSet(gpioPortC, 0, gpioModePushPull, 1);  /* TX */
-				break;
-			case 2:
-			case 3:
-				GPIO_PinModeSet(gpioPortD, 6, gpioModeInput, 0);     /* RX */
-				GPIO_PinModeSet(gpioPortD, 7, gpioModePushPull, 1);  /* TX */
-				break;
-			case 4:
-				GPIO_PinModeSet(gpioPortA, 0, gpioModeInput, 0);     /* RX */
-				GPIO_PinModeSet(gpioPortF, 2, gpioModePushPull, 1);  /* TX */
-				break;
-			case 5:
-				GPIO_PinModeSet(gpioPortC, 2, gpioModeInput, 0);     /* RX */
-				GPIO_PinModeSet(gpioPortC, 1, gpioModePushPull, 1);  /* TX */
-				break;
-			/* default: */
-				/* No default */
-		}
-	}
+		const usart_pins_t *pins = &usartPins[(db->pointer == USART1) ? 1 : 0][location];
 
+		if (pins->rxPort != PIN_NONE) GPIO_PinModeSet((GPIO_Port_TypeDef)pins->rxPort, pins->rxPin, gpioModeInput, 0);
+		if (pins->txPort != PIN_NONE) GPIO_PinModeSet((GPIO_Port_TypeDef)pins->txPort, pins->txPin, gpioModePushPull, 1);
+	}
 
-	/* Initialize USART asynchronous mode */
-	USART_InitAsync(dbpointer, &config);
 
-	/* Route pins */
-	switch (location)
+#if DBPRINT_LEUART == 1
+	/* Initialize the LEUART (clocks, pins and routing) if it's used instead of USARTx */
+	if (db->leuart != NULL)
 	{
-		case 0:
-			dbpointer->ROUTE |= USART_ROUTE_TXPEN | USART_ROUTE_RXPEN | USART_ROUTE_LOCATION_LOC0;
-			break;
-		case 1:
-			dbpointer->ROUTE |= USART_ROUTE_TXPEN | USART_ROUTE_RXPEN | USART_ROUTE_LOCATION_LOC1;
-			break;
-		case 2:
-			dbpointer->ROUTE |= USART_ROUTE_TXPEN | USART_ROUTE_RXPEN | USART_ROUTE_LOCATION_LOC2;
-			break;
-		case 3:
-			dbpointer->ROUTE |= USART_ROUTE_TXPEN | USART_ROUTE_RXPEN | USART_ROUTE_LOCATION_LOC3;
-			break;
-		case 4:
-			dbpointer->ROUTE |= USART_ROUTE_TXPEN | USART_ROUTE_RXPEN | USART_ROUTE_LOCATION_LOC4;
-			break;
-		case 5:
-			dbpointer->ROUTE |= USART_ROUTE_TXPEN | USART_ROUTE_RXPEN | USART_ROUTE_LOCATION_LOC5;
-			break;
-		case 6:
-			dbpointer->ROUTE |= USART_ROUTE_TXPEN | USART_ROUTE_RXPEN | USART_ROUTE_LOCATION_LOC6;
-			break;
-		default:
-			dbpointer->ROUTE |= USART_ROUTE_TXPEN | USART_ROUTE_RXPEN | USART_ROUTE_LOCATION_DEFAULT;
+		leuart_init(db, location);
+	}
+	else
+#endif
+	{
+		/* Initialize USART asynchronous mode */
+		USART_InitAsync(db->pointer, &config);
+
+		/* Route pins */
+		if (location < USART_LOCATIONS)
+		{
+			db->pointer->ROUTE |= USART_ROUTE_TXPEN | USART_ROUTE_RXPEN | usartPins[0][location].route;
+		}
+		else
+		{
+			db->pointer->ROUTE |= USART_ROUTE_TXPEN | USART_ROUTE_RXPEN | USART_ROUTE_LOCATION_DEFAULT;
+		}
 	}
 
 	/* Enable interrupts if necessary and print welcome string (and make an alert sound in the console) */
-	if (interrupts)
+	if (init->interrupts)
 	{
-		/* Initialize USART interrupts */
+		/* Initialize USART (or LEUART) interrupts */
 
 		/* RX Data Valid Interrupt Enable
 		 *   Set when data is available in the receive buffer. Cleared when the receive buffer is empty. */
-		USART_IntEnable(dbpointer, USART_IEN_RXDATAV);
+		uart_intEnable(db, USART_IEN_RXDATAV);
 
 		/* TX Complete Interrupt Enable
 		 *   Set when a transmission has completed and no more data is available in the transmit buffer.
-		 *   Cleared when a new transmission starts. */
-		USART_IntEnable(dbpointer, USART_IEN_TXC);
+		 *   Cleared when a new transmission starts.
+		 *   -> The TX handler uses this to transmit the next character from the TX queue.
+		 *
+		 * TX Buffer Level Interrupt Enable
+		 *   Set when the TX buffer is empty (TXBIL = 0). Cleared when data is written to the buffer.
+		 *   -> This one only gets enabled by "tx_start" when there is data in the TX queue. */
+		if (db->txMode == TX_COMPLETE)
+		{
+			uart_intEnable(db, USART_IEN_TXC);
+		}
+
+		/* Let the interrupt handlers of USARTx (or LEUART0) serve this instance */
+#if DBPRINT_LEUART == 1
+		if (db->leuart != NULL)
+		{
+			dbcontext[2] = db;
 
-		if (dbpointer == USART0)
+			/* Enable LEUART interrupt (RX and TX share one interrupt) */
+			NVIC_EnableIRQ(LEUART0_IRQn);
+			db->txIRQn = LEUART0_IRQn;
+		}
+		else
+#endif
+		if (db->pointer == USART0)
 		{
+			dbcontext[0] = db;
+
 			/* Enable USART interrupts */
 			NVIC_EnableIRQ(USART0_RX_IRQn);
 			NVIC_EnableIRQ(USART0_TX_IRQn);
+			db->txIRQn = USART0_TX_IRQn;
 		}
-		else if (dbpointer == USART1)
+		else if (db->pointer == USART1)
 		{
+			dbcontext[1] = db;
+
 			/* Enable USART interrupts */
 			NVIC_EnableIRQ(USART1_RX_IRQn);
 			NVIC_EnableIRQ(USART1_TX_IRQn);
+			db->txIRQn = USART1_TX_IRQn;
+		}
+
+#if DBPRINT_DMA == 1
+		/* DMA TX mode: the DMA handler (callback) takes over from the TX handler */
+		if (db->txMode == TX_DMA)
+		{
+			dma_init(db);
+			db->txIRQn = DMA_IRQn;
+		}
+#endif
+
+#if DBPRINT_IDLE_GATING == 1
+		/* Prepare the wake-up on the RX pin, the clock gets gated once the TX queue is idle */
+		if (db->idleGating)
+		{
+			gate_init(db, location);
 		}
+#endif
+
+		/* From now on the print methods put their data in the TX queue */
+		db->txQueued = true;
 
-		/* Print welcome string */
-		dbprint(COLOR_RESET);
-		dbprintln("\a\r\f### UART initialized (interrupt mode) ###");
-		dbinfo("This is an info message.");
-		dbwarn("This is a warning message.");
-		dbcrit("This is a critical error message.");
-		dbprintln("###  Start executing programmed code  ###\n");
+		/* Fast start: no welcome string */
+		if (!init->banner) return;
 
-		/* Set TX Complete Interrupt Flag (transmission has completed and no more data
-		* is available in the transmit buffer) */
-		USART_IntSet(dbpointer, USART_IFS_TXC);
+		/* Print welcome string (put in the TX queue, transmitted in the background) */
+		dbprint_ctx(db, COLOR_RESET);
+		dbprintln_ctx(db, "\a\r\f### UART initialized (interrupt mode) ###");
+		dbinfo_ctx(db, "This is an info message.");
+		dbwarn_ctx(db, "This is a warning message.");
+		dbcrit_ctx(db, "This is a critical error message.");
+		dbprintln_ctx(db, "###  Start executing programmed code  ###\n");
 	}
 	/* Print welcome string (and make an alert sound in the console) if not in interrupt mode */
-	else
+	else if (init->banner)
 	{
-		dbprint(COLOR_RESET);
-		dbprintln("\a\r\f### UART initialized (no interrupts) ###");
-		dbinfo("This is an info message.");
-		dbwarn("This is a warning message.");
-		dbcrit("This is a critical error message.");
-		dbprintln("### Start executing programmed code  ###\n");
+		dbprint_ctx(db, COLOR_RESET);
+		dbprintln_ctx(db, "\a\r\f### UART initialized (no interrupts) ###");
+		dbinfo_ctx(db, "This is an info message.");
+		dbwarn_ctx(db, "This is a warning message.");
+		dbcrit_ctx(db, "This is a critical error message.");
+		dbprintln_ctx(db, "### Start executing programmed code  ###\n");
 	}
 }
 
@@ -341,10 +740,13 @@ void dbprint_INIT (USART_TypeDef* pointer, uint8_t location, bool vcom, bool int
  *
  * @details
  *   Print the *bell* (alert) character to USARTx.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
  *****************************************************************************/
-void dbAlert (void)
+void dbAlert_ctx (dbprint_t *db)
 {
-	USART_Tx(dbpointer, '\a');
+	dbprint_write(db, "\a", 1, DBPRINT_LEVEL_INFO);
 }
 
 
@@ -355,10 +757,13 @@ void dbAlert (void)
  * @details
  *   Print the *form feed* character to USARTx. Accessing old data is still
  *   possible by scrolling up in the serial port program.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
  *****************************************************************************/
-void dbClear (void)
+void dbClear_ctx (dbprint_t *db)
 {
-	USART_Tx(dbpointer, '\f');
+	dbprint_write(db, "\f", 1, DBPRINT_LEVEL_INFO);
 }
 
 
@@ -366,21 +771,48 @@ void dbClear (void)
  * @brief
  *   Print a string (char array) to USARTx.
  * 
+ * @details
+ *   In interrupt mode the string is copied to the TX queue and the method
+ *   returns immediately, the TX handler transmits the characters afterwards.
+ *
  * @note
  *   If the input is not a string (ex.: `"Hello world!"`) but a char array,
  *   the input message (array) needs to end with NULL (`"\0"`)!
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] message
  *   The string to print to USARTx.
  *****************************************************************************/
-void dbprint (char *message)
+void dbprint_ctx (dbprint_t *db, char *message)
 {
-	/* "message[i] != 0" makes "uint32_t length = strlen(message)"
-	 * not necessary (given string MUST be terminated by NULL for this to work) */
-	for (uint32_t i = 0; message[i] != 0; i++)
-	{
-		USART_Tx(dbpointer, message[i]);
-	}
+	/* Given string MUST be terminated by NULL for this to work */
+	dbprint_write(db, message, string_length(message), DBPRINT_LEVEL_INFO);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a given amount of characters to USARTx.
+ *
+ * @details
+ *   The characters don't need to end with NULL and can contain NULL
+ *   characters, they are copied to the TX queue without looking at them
+ *   (for example buffers of which the length is already known).
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] message
+ *   The characters to print to USARTx.
+ *
+ * @param[in] length
+ *   The amount of characters to print.
+ *****************************************************************************/
+void dbprintn_ctx (dbprint_t *db, const char *message, uint32_t length)
+{
+	dbprint_write(db, message, length, DBPRINT_LEVEL_INFO);
 }
 
 
@@ -392,18 +824,23 @@ void dbprint (char *message)
  *   If the input is not a string (ex.: `"Hello world!"`) but a char array,
  *   the input message (array) needs to end with NULL (`"\0"`)!
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] message
  *   The string to print to USARTx.
  *****************************************************************************/
-void dbprintln (char *message)
+void dbprintln_ctx (dbprint_t *db, char *message)
 {
-	dbprint(message);
+	record_t record;
+	record_start(&record, db, DBPRINT_LEVEL_INFO);
+	record.split = true;
 
-	/* Carriage return */
-	USART_Tx(dbpointer, '\r');
+	/* Message and carriage return + line feed (new line) in one record */
+	record_append(&record, message);
+	record_appendn(&record, "\r\n", 2);
 
-	/* Line feed (new line) */
-	USART_Tx(dbpointer, '\n');
+	record_submit(&record);
 }
 
 
@@ -415,54 +852,18 @@ void dbprintln (char *message)
  *   If the input is not a string (ex.: `"Hello world!"`) but a char array,
  *   the input message (array) needs to end with NULL (`"\0"`)!
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] message
  *   The string to print to USARTx.
  *
  * @param[in] color
  *   The color to print the text in.
  *****************************************************************************/
-void dbprint_color (char *message, dbprint_color_t color)
+void dbprint_color_ctx (dbprint_t *db, char *message, dbprint_color_t color)
 {
-	switch (color)
-	{
-		case DEFAULT_COLOR:
-			dbprint(COLOR_RESET);
-			dbprint(message);
-			break;
-		case RED:
-			dbprint(COLOR_RED);
-			dbprint(message);
-			dbprint(COLOR_RESET);
-			break;
-		case GREEN:
-			dbprint(COLOR_GREEN);
-			dbprint(message);
-			dbprint(COLOR_RESET);
-			break;
-		case BLUE:
-			dbprint(COLOR_BLUE);
-			dbprint(message);
-			dbprint(COLOR_RESET);
-			break;
-		case CYAN:
-			dbprint(COLOR_CYAN);
-			dbprint(message);
-			dbprint(COLOR_RESET);
-			break;
-		case MAGENTA:
-			dbprint(COLOR_MAGENTA);
-			dbprint(message);
-			dbprint(COLOR_RESET);
-			break;
-		case YELLOW:
-			dbprint(COLOR_YELLOW);
-			dbprint(message);
-			dbprint(COLOR_RESET);
-			break;
-		default:
-			dbprint(COLOR_RESET);
-			dbprint(message);
-	}
+	dbprint_colorRecord(db, message, color, false);
 }
 
 
@@ -474,21 +875,38 @@ void dbprint_color (char *message, dbprint_color_t color)
  *   If the input is not a string (ex.: `"Hello world!"`) but a char array,
  *   the input message (array) needs to end with NULL (`"\0"`)!
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] message
  *   The string to print to USARTx.
  *
  * @param[in] color
  *   The color to print the text in.
  *****************************************************************************/
-void dbprintln_color (char *message, dbprint_color_t color)
+void dbprintln_color_ctx (dbprint_t *db, char *message, dbprint_color_t color)
 {
-	dbprint_color(message, color);
+	dbprint_colorRecord(db, message, color, true);
+}
 
-	/* Carriage return */
-	USART_Tx(dbpointer, '\r');
 
-	/* Line feed (new line) */
-	USART_Tx(dbpointer, '\n');
+/**************************************************************************//**
+ * @brief
+ *   Print a *trace* string (char array) to USARTx and go to the next line.
+ *
+ * @note
+ *   If the input is not a string (ex.: `"Hello world!"`) but a char array,
+ *   the input message (array) needs to end with NULL (`"\0"`)!
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] message
+ *   The string to print to USARTx.
+ *****************************************************************************/
+void dbtrace_ctx (dbprint_t *db, char *message)
+{
+	dbprint_record(db, DBPRINT_LEVEL_TRACE, message, 0, '-', "");
 }
 
 
@@ -500,13 +918,15 @@ void dbprintln_color (char *message, dbprint_color_t color)
  *   If the input is not a string (ex.: `"Hello world!"`) but a char array,
  *   the input message (array) needs to end with NULL (`"\0"`)!
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] message
  *   The string to print to USARTx.
  *****************************************************************************/
-void dbinfo (char *message)
+void dbinfo_ctx (dbprint_t *db, char *message)
 {
-	dbprint("INFO: ");
-	dbprintln(message);
+	dbprint_record(db, DBPRINT_LEVEL_INFO, message, 0, '-', "");
 }
 
 
@@ -518,13 +938,15 @@ void dbinfo (char *message)
  *   If the input is not a string (ex.: `"Hello world!"`) but a char array,
  *   the input message (array) needs to end with NULL (`"\0"`)!
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] message
  *   The string to print to USARTx.
  *****************************************************************************/
-void dbwarn (char *message)
+void dbwarn_ctx (dbprint_t *db, char *message)
 {
-	dbprint_color("WARN: ", YELLOW);
-	dbprintln_color(message, YELLOW);
+	dbprint_record(db, DBPRINT_LEVEL_WARN, message, 0, '-', "");
 }
 
 
@@ -536,13 +958,45 @@ void dbwarn (char *message)
  *   If the input is not a string (ex.: `"Hello world!"`) but a char array,
  *   the input message (array) needs to end with NULL (`"\0"`)!
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] message
  *   The string to print to USARTx.
  *****************************************************************************/
-void dbcrit (char *message)
+void dbcrit_ctx (dbprint_t *db, char *message)
+{
+	dbprint_record(db, DBPRINT_LEVEL_CRIT, message, 0, '-', "");
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a *trace* value surrounded by two strings (char array) to USARTx.
+ *
+ * @details
+ *   "TRACE: " gets added in front, the decimal notation is used and
+ *   the function advances to the next line.
+ *
+ * @note
+ *   If the input is not a string (ex.: `"Hello world!"`) but a char array,
+ *   the input message (array) needs to end with NULL (`"\0"`)!
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] message1
+ *   The first part of the string to print to USARTx.
+ *
+ * @param[in] value
+ *   The value to print between the two string parts.
+ *
+ * @param[in] message2
+ *   The second part of the string to print to USARTx.
+ *****************************************************************************/
+void dbtraceInt_ctx (dbprint_t *db, char *message1, int32_t value, char *message2)
 {
-	dbprint_color("CRIT: ", RED);
-	dbprintln_color(message, RED);
+	dbprint_record(db, DBPRINT_LEVEL_TRACE, message1, value, 'd', message2);
 }
 
 
@@ -558,6 +1012,9 @@ void dbcrit (char *message)
  *   If the input is not a string (ex.: `"Hello world!"`) but a char array,
  *   the input message (array) needs to end with NULL (`"\0"`)!
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] message1
  *   The first part of the string to print to USARTx.
  *
@@ -567,12 +1024,9 @@ void dbcrit (char *message)
  * @param[in] message2
  *   The second part of the string to print to USARTx.
  *****************************************************************************/
-void dbinfoInt (char *message1, int32_t value, char *message2)
+void dbinfoInt_ctx (dbprint_t *db, char *message1, int32_t value, char *message2)
 {
-	dbprint("INFO: ");
-	dbprint(message1);
-	dbprintInt(value);
-	dbprintln(message2);
+	dbprint_record(db, DBPRINT_LEVEL_INFO, message1, value, 'd', message2);
 }
 
 
@@ -589,6 +1043,9 @@ void dbinfoInt (char *message1, int32_t value, char *message2)
  *   If the input is not a string (ex.: `"Hello world!"`) but a char array,
  *   the input message (array) needs to end with NULL (`"\0"`)!
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] message1
  *   The first part of the string to print to USARTx.
  *
@@ -598,12 +1055,9 @@ void dbinfoInt (char *message1, int32_t value, char *message2)
  * @param[in] message2
  *   The second part of the string to print to USARTx.
  *****************************************************************************/
-void dbwarnInt (char *message1, int32_t value, char *message2)
+void dbwarnInt_ctx (dbprint_t *db, char *message1, int32_t value, char *message2)
 {
-	dbprint_color("WARN: ", YELLOW);
-	dbprint_color(message1, YELLOW);
-	dbprintInt(value);
-	dbprintln_color(message2, YELLOW);
+	dbprint_record(db, DBPRINT_LEVEL_WARN, message1, value, 'd', message2);
 }
 
 
@@ -620,6 +1074,9 @@ void dbwarnInt (char *message1, int32_t value, char *message2)
  *   If the input is not a string (ex.: `"Hello world!"`) but a char array,
  *   the input message (array) needs to end with NULL (`"\0"`)!
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] message1
  *   The first part of the string to print to USARTx.
  *
@@ -629,12 +1086,39 @@ void dbwarnInt (char *message1, int32_t value, char *message2)
  * @param[in] message2
  *   The second part of the string to print to USARTx.
  *****************************************************************************/
-void dbcritInt (char *message1, int32_t value, char *message2)
+void dbcritInt_ctx (dbprint_t *db, char *message1, int32_t value, char *message2)
+{
+	dbprint_record(db, DBPRINT_LEVEL_CRIT, message1, value, 'd', message2);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a *trace* value surrounded by two strings (char array) to USARTx.
+ *
+ * @details
+ *   "TRACE: " gets added in front, the hexadecimal notation is used and
+ *   the function advances to the next line.
+ *
+ * @note
+ *   If the input is not a string (ex.: `"Hello world!"`) but a char array,
+ *   the input message (array) needs to end with NULL (`"\0"`)!
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] message1
+ *   The first part of the string to print to USARTx.
+ *
+ * @param[in] value
+ *   The value to print between the two string parts.
+ *
+ * @param[in] message2
+ *   The second part of the string to print to USARTx.
+ *****************************************************************************/
+void dbtraceInt_hex_ctx (dbprint_t *db, char *message1, int32_t value, char *message2)
 {
-	dbprint_color("CRIT: ", RED);
-	dbprint_color(message1, RED);
-	dbprintInt(value);
-	dbprintln_color(message2, RED);
+	dbprint_record(db, DBPRINT_LEVEL_TRACE, message1, value, 'x', message2);
 }
 
 
@@ -650,6 +1134,9 @@ void dbcritInt (char *message1, int32_t value, char *message2)
  *   If the input is not a string (ex.: `"Hello world!"`) but a char array,
  *   the input message (array) needs to end with NULL (`"\0"`)!
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] message1
  *   The first part of the string to print to USARTx.
  *
@@ -659,12 +1146,9 @@ void dbcritInt (char *message1, int32_t value, char *message2)
  * @param[in] message2
  *   The second part of the string to print to USARTx.
  *****************************************************************************/
-void dbinfoInt_hex (char *message1, int32_t value, char *message2)
+void dbinfoInt_hex_ctx (dbprint_t *db, char *message1, int32_t value, char *message2)
 {
-	dbprint("INFO: ");
-	dbprint(message1);
-	dbprintInt_hex(value);
-	dbprintln(message2);
+	dbprint_record(db, DBPRINT_LEVEL_INFO, message1, value, 'x', message2);
 }
 
 
@@ -681,6 +1165,9 @@ void dbinfoInt_hex (char *message1, int32_t value, char *message2)
  *   If the input is not a string (ex.: `"Hello world!"`) but a char array,
  *   the input message (array) needs to end with NULL (`"\0"`)!
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] message1
  *   The first part of the string to print to USARTx.
  *
@@ -690,12 +1177,9 @@ void dbinfoInt_hex (char *message1, int32_t value, char *message2)
  * @param[in] message2
  *   The second part of the string to print to USARTx.
  *****************************************************************************/
-void dbwarnInt_hex (char *message1, int32_t value, char *message2)
+void dbwarnInt_hex_ctx (dbprint_t *db, char *message1, int32_t value, char *message2)
 {
-	dbprint_color("WARN: ", YELLOW);
-	dbprint_color(message1, YELLOW);
-	dbprintInt_hex(value);
-	dbprintln_color(message2, YELLOW);
+	dbprint_record(db, DBPRINT_LEVEL_WARN, message1, value, 'x', message2);
 }
 
 
@@ -712,6 +1196,9 @@ void dbwarnInt_hex (char *message1, int32_t value, char *message2)
  *   If the input is not a string (ex.: `"Hello world!"`) but a char array,
  *   the input message (array) needs to end with NULL (`"\0"`)!
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] message1
  *   The first part of the string to print to USARTx.
  *
@@ -721,12 +1208,9 @@ void dbwarnInt_hex (char *message1, int32_t value, char *message2)
  * @param[in] message2
  *   The second part of the string to print to USARTx.
  *****************************************************************************/
-void dbcritInt_hex (char *message1, int32_t value, char *message2)
+void dbcritInt_hex_ctx (dbprint_t *db, char *message1, int32_t value, char *message2)
 {
-	dbprint_color("CRIT: ", RED);
-	dbprint_color(message1, RED);
-	dbprintInt_hex(value);
-	dbprintln_color(message2, RED);
+	dbprint_record(db, DBPRINT_LEVEL_CRIT, message1, value, 'x', message2);
 }
 
 
@@ -734,35 +1218,16 @@ void dbcritInt_hex (char *message1, int32_t value, char *message2)
  * @brief
  *   Print a number in decimal notation to USARTx.
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] value
  *   The number to print to USARTx.@n
  *   This can be of type `uint32_t` or `int32_t`.
  *****************************************************************************/
-void dbprintInt (int32_t value)
+void dbprintInt_ctx (dbprint_t *db, int32_t value)
 {
-	/* Buffer to put the char array in (Needs to be 10) */
-	char decchar[10];
-
-	/* Convert a negative number to a positive one and print the "-" */
-	if (value < 0)
-	{
-		/* Negative of value = flip all bits, +1
-		 *   bitwise logic: "~" = "NOT" */
-		uint32_t negativeValue = (~value) + 1;
-
-		dbprint("-");
-
-		/* Convert the value */
-		uint32_to_charDec(decchar, negativeValue);
-	}
-	else
-	{
-		/* Convert the value */
-		uint32_to_charDec(decchar, value);
-	}
-
-	/* Print the buffer */
-	dbprint(decchar);
+	dbprint_valueRecord(db, value, 'd', false);
 }
 
 
@@ -770,19 +1235,16 @@ void dbprintInt (int32_t value)
  * @brief
  *   Print a number in decimal notation to USARTx and go to the next line.
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] value
  *   The number to print to USARTx.@n
  *   This can be of type `uint32_t` or `int32_t`.
  *****************************************************************************/
-void dbprintlnInt (int32_t value)
+void dbprintlnInt_ctx (dbprint_t *db, int32_t value)
 {
-	dbprintInt(value);
-
-	/* Carriage return */
-	USART_Tx(dbpointer, '\r');
-
-	/* Line feed (new line) */
-	USART_Tx(dbpointer, '\n');
+	dbprint_valueRecord(db, value, 'd', true);
 }
 
 
@@ -790,16 +1252,16 @@ void dbprintlnInt (int32_t value)
  * @brief
  *   Print a number in hexadecimal notation to USARTx.
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] value
  *   The number to print to USARTx.@n
  *   This can be of type `uint32_t` or `int32_t`.
  *****************************************************************************/
-void dbprintInt_hex (int32_t value)
+void dbprintInt_hex_ctx (dbprint_t *db, int32_t value)
 {
-	char hexchar[9]; /* Needs to be 9 */
-	uint32_to_charHex(hexchar, value, true); /* true: add spacing between eight HEX chars */
-	dbprint("0x");
-	dbprint(hexchar);
+	dbprint_valueRecord(db, value, 'x', false);
 }
 
 
@@ -807,32 +1269,178 @@ void dbprintInt_hex (int32_t value)
  * @brief
  *   Print a number in hexadecimal notation to USARTx and go to the next line.
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @param[in] value
  *   The number to print to USARTx.@n
  *   This can be of type `uint32_t` or `int32_t`.
  *****************************************************************************/
-void dbprintlnInt_hex (int32_t value)
+void dbprintlnInt_hex_ctx (dbprint_t *db, int32_t value)
 {
-	dbprintInt_hex(value);
-
-	/* Carriage return */
-	USART_Tx(dbpointer, '\r');
-
-	/* Line feed (new line) */
-	USART_Tx(dbpointer, '\n');
+	dbprint_valueRecord(db, value, 'x', true);
 }
 
 
 /**************************************************************************//**
  * @brief
- *   Read a character from USARTx.
+ *   Send binary data to USARTx in a frame (in between the text output).
+ *
+ * @details
+ *   The frame is `DBPRINT_FRAME_START`, the COBS encoded data and `0x00`.
+ *   Before encoding a sequence number (one byte, incremented for every frame)
+ *   is put in front of the data and a CRC-16 (CCITT, polynomial `0x1021`,
+ *   start value `0xFFFF`, most significant byte first) of the sequence number
+ *   and data after it.@n
+ *   COBS (*Consistent Overhead Byte Stuffing*) removes all zero bytes (at
+ *   most one byte overhead per 254 bytes), so `0x00` only occurs at the end
+ *   of a frame. The host can always resynchronize on it, detect corrupted
+ *   frames using the CRC and lost frames using the sequence number (see
+ *   `tools/dbframes.cpp`).@n
+ *   The frame is submitted as one record, so it can't get mixed up with other
+ *   output (also not with output of interrupt handlers).
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] data
+ *   The binary data (zero bytes are allowed).
+ *
+ * @param[in] length
+ *   The amount of bytes to send (at most `DBPRINT_FRAME_SIZE`).
  *
  * @return
- *   The character read from USARTx.
+ *   @li `true` - The frame is sent (or queued).
+ *   @li `false` - The data is too long or the frame is dropped (TX queue full).
  *****************************************************************************/
-char dbReadChar (void)
+bool dbprint_frame_ctx (dbprint_t *db, const uint8_t *data, uint32_t length)
 {
-	return (USART_Rx(dbpointer));
+	if (length > DBPRINT_FRAME_SIZE) return (false);
+
+	/* Sequence number, data and CRC (before encoding) */
+	uint8_t raw[DBPRINT_FRAME_SIZE + 3];
+	uint16_t crc = 0xFFFF;
+
+	/* Interrupt handlers can also send frames: take the sequence number (and count the frame) in a critical section */
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+	raw[0] = db->frameSeq++;
+	db->stats.txFrames++;
+	CORE_EXIT_CRITICAL();
+
+	crc = crc16_update(crc, raw[0]);
+
+	for (uint32_t i = 0; i < length; i++)
+	{
+		raw[i + 1] = data[i];
+		crc = crc16_update(crc, data[i]);
+	}
+
+	raw[length + 1] = crc >> 8;
+	raw[length + 2] = crc & 0xFF;
+
+	/* Start character, encoded data (one extra byte per 254 bytes) and end character */
+	uint8_t frame[DBPRINT_FRAME_SIZE + 3 + ((DBPRINT_FRAME_SIZE + 3) / 254) + 3];
+	uint32_t size = 0;
+
+	frame[size++] = DBPRINT_FRAME_START;
+	size += cobs_encode(&frame[size], raw, length + 3);
+	frame[size++] = 0x00;
+
+	return (dbprint_write(db, (char *)frame, size, DBPRINT_LEVEL_INFO));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a hexdump of a block of memory to USARTx.
+ *
+ * @details
+ *   Every line shows the offset, `HEXDUMP_ROW` (16) bytes in hexadecimal
+ *   notation and the same bytes as ASCII characters (`.` if not printable):@n
+ *   `00000010  48 65 6C 6C 6F 20 77 6F  72 6C 64 00 01 02 03 04  |Hello world.....|`@n
+ *   A line is assembled on the stack (the nibbles are looked up in a table)
+ *   and submitted as one record, instead of calling a print method for
+ *   every value.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] data
+ *   The memory to dump.
+ *
+ * @param[in] length
+ *   The amount of bytes to dump.
+ *****************************************************************************/
+void dbHexdump_ctx (dbprint_t *db, const void *data, uint32_t length)
+{
+	const uint8_t *bytes = (const uint8_t *)data;
+
+	for (uint32_t offset = 0; offset < length; offset += HEXDUMP_ROW)
+	{
+		/* Offset (8), two spaces, 16 * 3 (hex + space), two extra spaces, "|ascii|" and "\r\n" */
+		char line[8 + 2 + (HEXDUMP_ROW * 3) + 2 + (HEXDUMP_ROW + 2) + 2];
+		char *hex = &line[10];
+		char *ascii = &line[10 + (HEXDUMP_ROW * 3) + 2];
+
+		/* Offset */
+		for (uint8_t i = 0; i < 8; i++) line[i] = TO_HEX((offset >> (28 - (4 * i))) & 0xF);
+		line[8] = ' ';
+		line[9] = ' ';
+
+		*ascii++ = '|';
+
+		for (uint32_t i = 0; i < HEXDUMP_ROW; i++)
+		{
+			/* Extra space after eight bytes */
+			if (i == (HEXDUMP_ROW / 2)) *hex++ = ' ';
+
+			if ((offset + i) < length)
+			{
+				uint8_t byte = bytes[offset + i];
+
+				hex[0] = TO_HEX(byte >> 4);
+				hex[1] = TO_HEX(byte & 0xF);
+				*ascii++ = ((byte >= ' ') && (byte <= '~')) ? byte : '.';
+			}
+			else
+			{
+				/* Pad the last line so the ASCII column stays aligned */
+				hex[0] = ' ';
+				hex[1] = ' ';
+			}
+
+			hex[2] = ' ';
+			hex += 3;
+		}
+
+		*hex = ' '; /* Space before the ASCII column */
+		*ascii++ = '|';
+		*ascii++ = '\r';
+		*ascii++ = '\n';
+
+		dbprint_write(db, line, ascii - line, DBPRINT_LEVEL_INFO);
+	}
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Read a character from USARTx.
+ *
+ * @note
+ *   This method waits until a character is received, see `dbReadAsync_ctx`
+ *   to be notified instead.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @return
+ *   The character read from USARTx.
+ *****************************************************************************/
+char dbReadChar_ctx (dbprint_t *db)
+{
+	return (uart_read(db));
 }
 
 
@@ -845,14 +1453,17 @@ char dbReadChar (void)
  *     - `uint16_t USART_RxDouble(USART_TypeDef *usart);`
  *     - `uint32_t USART_RxDoubleExt(USART_TypeDef *usart);`
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @return
  *   The converted `uint8_t` value.
  *****************************************************************************/
-uint8_t dbReadInt (void)
+uint8_t dbReadInt_ctx (dbprint_t *db)
 {
 	/* Method expects a char array ending with a null termination character */
 	char value[2];
-	value[0]= dbReadChar();
+	value[0]= dbReadChar_ctx(db);
 	value[1] = '\0';
 
 	return (charDec_to_uint32(value));
@@ -866,17 +1477,21 @@ uint8_t dbReadInt (void)
  * @note
  *   The reading stops when a `"CR"` (Carriage Return, ENTER) character
  *   is received or the maximum length (`DBPRINT_BUFFER_SIZE`) is reached.
+ *   There is no timeout, see `dbReadAsync_ctx` to be notified instead.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
  *
  * @param[in] buf
  *   The buffer to put the resulting string in.@n
  *   **This needs to have a length of `DBPRINT_BUFFER_SIZE` for the function
  *   to work properly: `char buf[DBPRINT_BUFFER_SIZE];`!**
  *****************************************************************************/
-void dbReadLine (char *buf)
+void dbReadLine_ctx (dbprint_t *db, char *buf)
 {
 	for (uint32_t i = 0; i < DBPRINT_BUFFER_SIZE - 1 ; i++ )
 	{
-		char localBuffer = USART_Rx(dbpointer);
+		char localBuffer = uart_read(db);
 
 		/* Check if a CR character is received */
 		if (localBuffer == '\r')
@@ -895,23 +1510,352 @@ void dbReadLine (char *buf)
 
 /**************************************************************************//**
  * @brief
- *   Check if data was received using interrupts in the RX buffer.
+ *   Check if data was received using interrupts in the RX queue.
  *
  * @note
- *   The index of the RX buffer gets reset in the RX handler when a CR character
- *   is received or the buffer is filled.
+ *   A line is complete when a CR character is received or it fills up the
+ *   line buffer.
  *
  * @attention
  *   Interrupt functionality has to be enabled on initialization for this
  *   function to work correctly.
  *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
  * @return
  *   @li `true` - Data is received in the RX buffer.
  *   @li `false` - No data is received.
  *****************************************************************************/
-bool dbGet_RXstatus (void)
+bool dbGet_RXstatus_ctx (dbprint_t *db)
+{
+	return (db->rxHead != db->rxTail);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Get the amount of records that were dropped because the TX queue was full.
+ *
+ * @details
+ *   A `[N records dropped]` marker is also added to the output once there
+ *   is room again.
+ *
+ * @attention
+ *   Interrupt functionality has to be enabled on initialization for this
+ *   function to work correctly.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @return
+ *   The amount of dropped records since initialization (or `dbprintStats_reset`).
+ *****************************************************************************/
+uint32_t dbGet_TXdropped_ctx (dbprint_t *db)
+{
+	return (db->stats.dropped);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Wait until all data has left the chip (TX queue and shift register empty).
+ *
+ * @details
+ *   Afterwards it's safe to enter EM2/EM4, disable the clocks or reset the MCU
+ *   without truncating the output. See `dbFlush_timeout` for more info.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *****************************************************************************/
+void dbFlush_ctx (dbprint_t *db)
+{
+	/* No limit */
+	dbFlush_timeout_ctx(db, 0xFFFFFFFF);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Wait until all data has left the chip (TX queue and shift register empty)
+ *   or the timeout has passed.
+ *
+ * @details
+ *   The MCU sleeps in EM1 between the TX interrupts (or DMA interrupts in
+ *   `TX_DMA` mode) instead of polling the TX queue if there is no timeout.
+ *   The last character(s) in the shift register are polled, because no
+ *   interrupt is enabled for them in `TX_BUFFER_LEVEL` and `TX_DMA` mode (at
+ *   most three characters). Other interrupts can also wake up the MCU, it
+ *   goes back to sleep if the TX queue isn't empty yet.@n
+ *   Only the data committed before this call is waited for: if other
+ *   producers (interrupt handlers) keep adding data, it returns once that
+ *   data is transmitted and followed by enough other characters to have left
+ *   the TX buffer and shift register.
+ *
+ * @attention
+ *   The timeout is measured with the counter of `init.timestamp`, in ticks of
+ *   that counter (at most its period, `init.timestampMask`). The MCU doesn't
+ *   sleep while a timeout is running (no interrupt would wake it up if the TX
+ *   line is stuck), the counter and the TX queue are polled instead. Without
+ *   a counter only `0` (check) and `0xFFFFFFFF` (no limit, `dbFlush`) can be
+ *   used, other timeouts return `false` right away (nothing is waited for or
+ *   checked, like `dbReadAsync` refuses a timeout without a counter).
+ *
+ * @note
+ *   Waiting isn't possible if the TX interrupt is blocked (in an interrupt
+ *   handler with the same or a higher priority or with interrupts disabled),
+ *   `false` is returned immediately in that case. In an interrupt handler
+ *   that interrupted a print method only the data committed before that
+ *   print method is waited for.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] timeout
+ *   The maximum time to wait in ticks of the counter of `init.timestamp`
+ *   (`0` - Only check if the data has already left the chip, `0xFFFFFFFF` -
+ *   No limit).
+ *
+ * @return
+ *   @li `true` - All data has left the chip.
+ *   @li `false` - The timeout has passed, waiting isn't possible or a timeout
+ *                 (not `0` or `0xFFFFFFFF`) is given without `init.timestamp`.
+ *****************************************************************************/
+bool dbFlush_timeout_ctx (dbprint_t *db, uint32_t timeout)
+{
+	/* Nothing to wait for if the instance isn't initialized */
+	if ((db->pointer == NULL) && !USES_LEUART(db)) return (true);
+
+	if (db->txQueued && CORE_IrqIsBlocked(db->txIRQn)) return ((db->txTail == db->txCommit) && !db->txBusy && uart_txIdle(db));
+
+	/* Without a counter the time can't be measured (only checking or waiting without limit) */
+	bool forever = (timeout == 0xFFFFFFFF);
+	if ((db->timestamp == NULL) && !forever && (timeout != 0)) return (false);
+	uint32_t start = (db->timestamp != NULL) ? *db->timestamp : 0;
+
+	bool flushed = true;
+	bool handed = false; /* "true" if the data committed before this call is handed to the hardware */
+	uint32_t sent = 0;   /* Transmitted characters at that moment */
+	uint32_t lag = 0;    /* Characters that have to follow it */
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	uint32_t target = db->txCommit;
+
+	while (true)
+	{
+		bool queued = db->txQueued && (db->txBusy || (db->txTail != db->txCommit));
+
+		/* TX queue and shift register empty */
+		if (!queued && uart_txIdle(db)) break;
+
+		/* Data committed after this call keeps the TX queue busy: the data before it has left
+		 * the chip when the characters that can still be in the hardware (TX buffer and shift
+		 * register, the rest of the frame in compression mode) are followed by other ones */
+		if (db->txQueued && ((int32_t)(db->txTail - target) >= 0))
+		{
+			if (!handed)
+			{
+				handed = true;
+				sent = db->stats.sent;
+				lag = 3;
+#if DBPRINT_COMPRESS == 1
+				if (db->compress) lag += db->packLength - db->packIndex;
+#endif
+			}
+
+			if ((db->stats.sent - sent) >= lag) break;
+		}
+
+		if (!forever && ((timeout == 0) || (((*db->timestamp - start) & db->timestampMask) >= timeout)))
+		{
+			flushed = false;
+			break;
+		}
+
+		/* WFI also wakes up with interrupts disabled, the interrupt handler runs after
+		 *   leaving the critical section (no interrupt can be missed)
+		 *   -> Only without timeout and while the TX handler is busy (the shift register is polled) */
+		if (forever && queued) EMU_EnterEM1();
+
+		CORE_EXIT_CRITICAL();
+		CORE_ENTER_CRITICAL();
+	}
+
+	CORE_EXIT_CRITICAL();
+
+	return (flushed);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Gate the clock of USARTx if it has been idle for `init.idleThreshold`
+ *   counter ticks.
+ *
+ * @details
+ *   With a threshold the clock isn't gated when the TX queue becomes idle
+ *   (or a line is received), the idle time is measured with the counter of
+ *   `init.timestamp` instead. Nothing can interrupt when the threshold has
+ *   passed, so this method needs to be called regularly (for example in the
+ *   main loop before going to sleep). Without threshold or
+ *   `DBPRINT_IDLE_GATING` this does nothing.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *****************************************************************************/
+void dbIdle_poll_ctx (dbprint_t *db)
+{
+#if DBPRINT_IDLE_GATING == 1
+	if (!db->idleWaiting) return;
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	/* Data was queued or received in the meantime: its end starts the idle time again */
+	if (!gate_idle(db) || !uart_txIdle(db)) db->idleWaiting = false;
+	else if (db->idleWaiting && (((*db->timestamp - db->idleStart) & db->timestampMask) >= db->idleThreshold)) gate_close(db);
+
+	CORE_EXIT_CRITICAL();
+#else
+	(void)db;
+#endif
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Get the statistics of the logging path.
+ *
+ * @details
+ *   The counters are copied in a critical section, so they belong together.
+ *   See `dbprint_stats_t` for their meaning.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[out] stats
+ *   The struct to copy the statistics to.
+ *****************************************************************************/
+void dbprint_stats_ctx (dbprint_t *db, dbprint_stats_t *stats)
+{
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	*stats = db->stats;
+
+	CORE_EXIT_CRITICAL();
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print the statistics of the logging path to USARTx.
+ *
+ * @details
+ *   The statistics are copied before printing, the characters of this
+ *   method itself aren't counted in the printed values.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *****************************************************************************/
+void dbprintStats_ctx (dbprint_t *db)
+{
+	dbprint_stats_t stats;
+	dbprint_stats_ctx(db, &stats);
+
+	dbprintln_ctx(db, "### dbprint statistics ###");
+
+	dbprint_ctx(db, "Characters queued/sent: ");
+	dbprintInt_ctx(db, stats.queued);
+	dbprint_ctx(db, "/");
+	dbprintlnInt_ctx(db, stats.sent);
+
+	dbprint_ctx(db, "Records crit/warn/info/trace: ");
+	dbprintInt_ctx(db, stats.records[DBPRINT_LEVEL_CRIT - 1]);
+	dbprint_ctx(db, "/");
+	dbprintInt_ctx(db, stats.records[DBPRINT_LEVEL_WARN - 1]);
+	dbprint_ctx(db, "/");
+	dbprintInt_ctx(db, stats.records[DBPRINT_LEVEL_INFO - 1]);
+	dbprint_ctx(db, "/");
+	dbprintlnInt_ctx(db, stats.records[DBPRINT_LEVEL_TRACE - 1]);
+
+	dbprint_ctx(db, "TX queue high-water mark: ");
+	dbprintInt_ctx(db, stats.highWater);
+	dbprint_ctx(db, "/");
+	dbprintlnInt_ctx(db, DBPRINT_TX_BUFFER_SIZE);
+
+	dbprint_ctx(db, "Blocked (times/characters): ");
+	dbprintInt_ctx(db, stats.blocked);
+	dbprint_ctx(db, "/");
+	dbprintlnInt_ctx(db, stats.blockedChars);
+
+	dbprint_ctx(db, "Interrupts TX/RX: ");
+	dbprintInt_ctx(db, stats.txInterrupts);
+	dbprint_ctx(db, "/");
+	dbprintlnInt_ctx(db, stats.rxInterrupts);
+
+	dbprint_ctx(db, "RX overruns: ");
+	dbprintlnInt_ctx(db, stats.rxOverruns);
+
+	dbprint_ctx(db, "Dropped records: ");
+	dbprintlnInt_ctx(db, stats.dropped);
+
+	dbprint_ctx(db, "Truncated records: ");
+	dbprintlnInt_ctx(db, stats.truncated);
+
+	/* Only if binary frames are used */
+	if (stats.txFrames > 0)
+	{
+		dbprint_ctx(db, "Binary frames: ");
+		dbprintlnInt_ctx(db, stats.txFrames);
+	}
+
+#if DBPRINT_IDLE_GATING == 1
+	dbprint_ctx(db, "Clock gated/ungated (RX wake-ups): ");
+	dbprintInt_ctx(db, stats.gated);
+	dbprint_ctx(db, "/");
+	dbprintInt_ctx(db, stats.ungated);
+	dbprint_ctx(db, " (");
+	dbprintInt_ctx(db, stats.rxWakeups);
+	dbprintln_ctx(db, ")");
+#endif
+
+#if DBPRINT_RX_PARSE == 1
+	dbprint_ctx(db, "Received values (invalid): ");
+	dbprintInt_ctx(db, stats.rxValues);
+	dbprint_ctx(db, " (");
+	dbprintInt_ctx(db, stats.rxInvalid);
+	dbprintln_ctx(db, ")");
+#endif
+
+#if DBPRINT_COMPRESS == 1
+	dbprint_ctx(db, "Compressed characters/frames: ");
+	dbprintInt_ctx(db, stats.packed);
+	dbprint_ctx(db, "/");
+	dbprintlnInt_ctx(db, stats.frames);
+#endif
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Reset the statistics of the logging path.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *****************************************************************************/
+void dbprintStats_reset_ctx (dbprint_t *db)
 {
-	return (dataReceived);
+	dbprint_stats_t empty = { 0 };
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	db->stats = empty;
+
+	CORE_EXIT_CRITICAL();
 }
 
 
@@ -1002,43 +1946,3319 @@ bool dbGet_RXstatus (void)
 
 /**************************************************************************//**
  * @brief
- *   Get the value of the RX buffer and clear the `dataReceived` flag.
+ *   Copy the oldest received line from the RX queue and remove it from the queue.
+ *
+ * @note
+ *   `dbGet_RXline` can be used to access the line without copying it.
+ *
+ * @attention
+ *   Interrupt functionality has to be enabled on initialization for this
+ *   function to work correctly.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] buf
+ *   The buffer to put the resulting string in.@n
+ *   **This needs to have a length of `DBPRINT_BUFFER_SIZE` for the function
+ *   to work properly: `char buf[DBPRINT_BUFFER_SIZE];`!**
+ *****************************************************************************/
+void dbGet_RXbuffer_ctx (dbprint_t *db, char *buf)
+{
+	uint32_t length;
+	char *line = dbGet_RXline_ctx(db, &length);
+
+	if (line != NULL)
+	{
+		/* Copy the line (and its NULL termination character) to the given buffer */
+		for (uint32_t i = 0; i <= length; i++)
+		{
+			buf[i] = line[i];
+		}
+
+		dbRelease_RXline_ctx(db);
+	}
+	else
+	{
+		dbcrit_ctx(db, "No received data available!");
+	}
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Get the oldest received line from the RX queue without copying it.
+ *
+ * @details
+ *   The line stays in the RX queue (and the RX handler doesn't touch it) until
+ *   `dbRelease_RXline` is called, the returned pointer is valid until then.
+ *   Lines received in the meantime are queued after it.@n
+ *   Example usage: @n
+ *   `uint32_t length;` @n
+ *   `char *line = dbGet_RXline(&length);` @n
+ *   `if (line != NULL) { ...; dbRelease_RXline(); }`
+ *
+ * @note
+ *   If the RX queue is full, the characters of new lines are dropped
+ *   (counted in the `rxOverruns` statistic).
+ *
+ * @attention
+ *   Interrupt functionality has to be enabled on initialization for this
+ *   function to work correctly.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[out] length
+ *   The amount of characters in the line, without the NULL termination
+ *   character (can be `NULL` if it's not needed).
+ *
+ * @return
+ *   The line (ending with NULL), `NULL` if no line is received.
+ *****************************************************************************/
+char *dbGet_RXline_ctx (dbprint_t *db, uint32_t *length)
+{
+	if (db->rxHead == db->rxTail) return (NULL);
+
+	if (length != NULL) *length = db->rx_length[db->rxTail & RX_MASK];
+
+	/* Not volatile: the RX handler doesn't write to a complete line */
+	return ((char *)db->rx_buffer[db->rxTail & RX_MASK]);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Remove the oldest received line (returned by `dbGet_RXline`) from the RX queue.
+ *
+ * @attention
+ *   Interrupt functionality has to be enabled on initialization for this
+ *   function to work correctly.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *****************************************************************************/
+void dbRelease_RXline_ctx (dbprint_t *db)
+{
+	if (db->rxHead != db->rxTail) db->rxTail++;
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Get the oldest received number from the value queue.
+ *
+ * @details
+ *   If `init.rxParse` is used, the RX handler parses received numbers one
+ *   character at a time (the main loop never has to wait for or scan a
+ *   line) and puts them in the value queue. Numbers are separated by a
+ *   space, tab, `,`, `;`, CR, LF or FF and can be:
+ *     - Decimal, optionally with a sign: `-2147483648` to `2147483647`.
+ *     - Hexadecimal with a `0x` (or `0X`) prefix: up to `0xFFFFFFFF`
+ *       (read the value as `uint32_t`), a sign is also allowed.
+ *
+ *   Malformed numbers (`12a`, `0x`, ...) and numbers out of range are
+ *   skipped (counted in the `rxInvalid` statistic). If the value queue is
+ *   full new numbers are dropped (counted in the `rxOverruns` statistic).@n
+ *   Example usage: @n
+ *   `int32_t value;` @n
+ *   `while (dbGet_RXvalue(&value)) { ... }`
+ *
+ * @attention
+ *   `DBPRINT_RX_PARSE` needs to be `1` and `init.rxParse` needs to be used
+ *   (interrupt mode) for this function to work, received lines aren't queued
+ *   in that case.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[out] value
+ *   The received number.
+ *
+ * @return
+ *   @li `true` - A number is returned (and removed from the value queue).
+ *   @li `false` - No number is received.
+ *****************************************************************************/
+bool dbGet_RXvalue_ctx (dbprint_t *db, int32_t *value)
+{
+#if DBPRINT_RX_PARSE == 1
+	if (db->valueHead == db->valueTail) return (false);
+
+	*value = db->valueQueue[db->valueTail & VALUE_MASK];
+	db->valueTail++;
+
+	return (true);
+#else
+	(void)db;
+	(void)value;
+
+	return (false);
+#endif
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Execute the oldest received line as a shell command.
+ *
+ * @details
+ *   The line is split in arguments in place (spaces and tabs are replaced
+ *   by NULL), nothing is copied. A line with more than `DBPRINT_SHELL_ARGS`
+ *   arguments (including the command) isn't executed, a warning is printed
+ *   instead.
+ *   The first argument is looked up in the command table: its hash selects
+ *   one slot and only that command is compared with it, so the cost doesn't
+ *   depend on the amount of commands. The table is generated by
+ *   `tools/dbshellgen.cpp` (the seed of the hash is chosen so every command
+ *   has its own slot).@n
+ *   If the command isn't in the table, `help` lists the commands and any
+ *   other command prints a warning. The line is removed from the RX queue
+ *   afterwards, the arguments are only valid while the handler executes.@n
+ *   Example usage (in the main loop): @n
+ *   `extern const dbprint_shell_t dbshell;` @n
+ *   `while (dbShell(&dbshell));`
+ *
+ * @attention
+ *   Interrupt functionality has to be enabled on initialization for this
+ *   function to work correctly (and `init.rxParse` can't be used).
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`), also given to the handler.
+ *
+ * @param[in] shell
+ *   The command table.
+ *
+ * @return
+ *   @li `true` - A line is handled.
+ *   @li `false` - No line is received.
+ *****************************************************************************/
+bool dbShell_ctx (dbprint_t *db, const dbprint_shell_t *shell)
+{
+	char *line = dbGet_RXline_ctx(db, NULL);
+	if (line == NULL) return (false);
+
+	/* Split the line in arguments in place */
+	char *argv[DBPRINT_SHELL_ARGS];
+	uint32_t argc = 0;
+	bool tooMany = false;
+
+	while (*line != '\0')
+	{
+		/* Skip (and terminate the previous argument at) spaces and tabs */
+		if ((*line == ' ') || (*line == '\t'))
+		{
+			*line++ = '\0';
+			continue;
+		}
+
+		/* The command isn't executed with only a part of its arguments */
+		if (argc == DBPRINT_SHELL_ARGS)
+		{
+			tooMany = true;
+			break;
+		}
+		argv[argc++] = line;
+
+		while ((*line != '\0') && (*line != ' ') && (*line != '\t')) line++;
+	}
+
+	if (tooMany)
+	{
+		dbprint_record(db, DBPRINT_LEVEL_WARN, "Too many arguments: ", 0, '-', argv[0]);
+	}
+	else if (argc > 0)
+	{
+		/* Only the command in the slot of the hash can match */
+		const dbprint_command_t *command = &shell->slots[shell_hash(argv[0], shell->seed) & (shell->size - 1)];
+
+		if ((command->name != NULL) && string_equal(command->name, argv[0]))
+		{
+			command->handler(db, argc, argv);
+		}
+		else if (string_equal(argv[0], "help"))
+		{
+			shell_help(db, shell);
+		}
+		else
+		{
+			dbprint_record(db, DBPRINT_LEVEL_WARN, "Unknown command: ", 0, '-', argv[0]);
+		}
+	}
+
+	dbRelease_RXline_ctx(db);
+
+	return (true);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Register a callback that is called when a read is complete, instead of
+ *   polling for received lines.
+ *
+ * @details
+ *   A read is complete when a line is received (`RX_LINE`, `count` is `0`),
+ *   when `count` bytes are received (`RX_COUNT`, CR characters are part of
+ *   the data then) or when nothing was received during `timeout` counter
+ *   ticks (`RX_TIMEOUT`, with the data received so far, which can be empty).
+ *   The next read starts right away (its timeout starts with its first
+ *   character), the callback stays registered until this method is called
+ *   with `NULL`.@n
+ *   The callback is called by the RX handler (`deferred` is `false`) or by
+ *   `dbReadAsync_poll_ctx` in the main loop (`deferred` is `true`, the
+ *   received data waits in the RX queue until then). A timeout is always
+ *   detected by `dbReadAsync_poll_ctx`, so its callback is called from the
+ *   main loop. The data is only valid while the callback executes.@n
+ *   Example usage: @n
+ *   `dbReadAsync(0, 32768, callback, true);` (lines, 1 s timeout with the RTC) @n
+ *   `while (1) { dbReadAsync_poll(); EMU_EnterEM1(); }`
+ *
+ * @note
+ *   The USART of the EFM32HG has no RX timeout, so the timeout is measured
+ *   with the counter of `init.timestamp` (read by the RX handler for every
+ *   character) and checked by `dbReadAsync_poll_ctx`. **That method also has
+ *   to be called if `deferred` is `false` and a timeout is used**, otherwise
+ *   the timeout is never detected.
+ *
+ * @attention
+ *   Interrupt functionality has to be enabled on initialization for this
+ *   function to work correctly (and `init.rxParse` can't be used). Don't
+ *   use `dbGet_RXline_ctx` or `dbShell_ctx` while a callback is registered.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`), also given to the callback.
+ *
+ * @param[in] count
+ *   The amount of bytes of a read (at most `DBPRINT_BUFFER_SIZE - 2`),
+ *   `0` - Read lines.
+ *
+ * @param[in] timeout
+ *   The counter ticks without received data after which the read is
+ *   complete, `0` - No timeout.
+ *
+ * @param[in] callback
+ *   The method called with the event and data, `NULL` - Stop (lines are
+ *   polled again).
+ *
+ * @param[in] deferred
+ *   @li `true` - The callback is called by `dbReadAsync_poll_ctx`.
+ *   @li `false` - The callback is called by the RX handler.
+ *
+ * @return
+ *   @li `true` - The callback is registered (or removed).
+ *   @li `false` - Not in interrupt mode, `count` is too large or a timeout
+ *                 is given without `init.timestamp`.
+ *****************************************************************************/
+bool dbReadAsync_ctx (dbprint_t *db, uint32_t count, uint32_t timeout, dbprint_callback_t callback, bool deferred)
+{
+	if (!db->txQueued || (count > (DBPRINT_BUFFER_SIZE - 2)) || ((timeout != 0) && (db->timestamp == NULL))) return (false);
+
+#if DBPRINT_RX_PARSE == 1
+	/* The parser doesn't queue lines */
+	if (db->rxParse) return (false);
+#endif
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	db->rxCallback = callback;
+	db->rxDeferred = deferred;
+	db->rxCount = (callback != NULL) ? count : 0;
+	db->rxTimeout = (callback != NULL) ? timeout : 0;
+	db->rxTimedOut = false;
+
+	/* The timeout of the first read starts now */
+	db->rxWaiting = (db->rxTimeout != 0);
+	if (db->rxWaiting) db->rxLast = *db->timestamp;
+
+	CORE_EXIT_CRITICAL();
+
+	return (true);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Check the timeout of the asynchronous read and call the callback for
+ *   the completed reads if it's deferred.
+ *
+ * @details
+ *   Call this method in the main loop (after waking up) if `dbReadAsync_ctx`
+ *   is used with `deferred` or a timeout (also if `deferred` is `false`, the
+ *   RX handler can't detect that nothing is received). The completed read is
+ *   queued in a critical section, the callback is called afterwards with
+ *   interrupts enabled. The RX handler doesn't call the callback in the
+ *   meantime (no line is delivered twice or out of order), the lines it
+ *   receives are delivered by this method.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *****************************************************************************/
+void dbReadAsync_poll_ctx (dbprint_t *db)
+{
+	if (db->rxCallback == NULL) return;
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	/* Nothing received during the timeout: complete the read with the data received so far */
+	if (db->rxWaiting && (((*db->timestamp - db->rxLast) & db->timestampMask) >= db->rxTimeout))
+	{
+		if (db->rxIndex > 0)
+		{
+			rx_queue(db, db->rxIndex, RX_TIMEOUT);
+		}
+		else
+		{
+			db->rxWaiting = false;
+			db->rxDropping = false;
+			db->rxTimedOut = true;
+		}
+	}
+
+	/* The RX handler leaves the lines it receives to this method until the flag is cleared */
+	db->rxDelivering = true;
+
+	do
+	{
+		CORE_EXIT_CRITICAL();
+		rx_deliver(db);
+		CORE_ENTER_CRITICAL();
+	} while (!db->rxDeferred && (db->rxCallback != NULL) && (db->rxHead != db->rxTail));
+
+	db->rxDelivering = false;
+
+	CORE_EXIT_CRITICAL();
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a tokenized record without a value to USARTx.
+ *
+ * @details
+ *   Used by the `dbinfo`, `dbwarn` and `dbcrit` macros if `DBPRINT_TOKENIZED`
+ *   is `1`. Only `DBPRINT_TOKEN_START` and the token (varint) are transmitted
+ *   (with timestamps `DBPRINT_TOKEN_START_TIME`, the delta and the token), the
+ *   host-side decoder (`tools/dbdecode.cpp`) looks up the strings in the
+ *   `dbprint_tokens` section of the firmware.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] token
+ *   The token (offset in the `dbprint_tokens` section) of the string table entry.
+ *****************************************************************************/
+void dbprint_token_ctx (dbprint_t *db, uint32_t token)
+{
+	/* Start character + timestamp + token (max 5 bytes each) */
+	uint8_t record[11];
+	uint8_t length = token_start(db, record);
+
+	length += uint32_to_varint(&record[length], token);
+
+	/* Transmit the record in one go */
+	uint8_t level = token_level(token);
+	db->stats.records[level - 1]++;
+	dbprint_write(db, (char *)record, length, level);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a tokenized record with a value in decimal notation to USARTx.
+ *
+ * @details
+ *   Used by the `dbinfoInt`, `dbwarnInt` and `dbcritInt` macros if
+ *   `DBPRINT_TOKENIZED` is `1`. The value is *zigzag* encoded (small negative
+ *   values stay small) and transmitted as a varint after the token.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] token
+ *   The token (offset in the `dbprint_tokens` section) of the string table entry.
+ *
+ * @param[in] value
+ *   The value to print between the two string parts.
+ *****************************************************************************/
+void dbprint_tokenInt_ctx (dbprint_t *db, uint32_t token, int32_t value)
+{
+	/* Start character + timestamp + token + value (max 5 bytes each) */
+	uint8_t record[16];
+	uint8_t length = token_start(db, record);
+
+	/* Zigzag encoding: 0, -1, 1, -2, 2, ... -> 0, 1, 2, 3, 4, ... */
+	uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+
+	length += uint32_to_varint(&record[length], token);
+	length += uint32_to_varint(&record[length], zigzag);
+
+	/* Transmit the record in one go */
+	uint8_t level = token_level(token);
+	db->stats.records[level - 1]++;
+	dbprint_write(db, (char *)record, length, level);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a tokenized record with a value in hexadecimal notation to USARTx.
+ *
+ * @details
+ *   Used by the `dbinfoInt_hex`, `dbwarnInt_hex` and `dbcritInt_hex` macros if
+ *   `DBPRINT_TOKENIZED` is `1`. The value is transmitted as an unsigned varint
+ *   after the token.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] token
+ *   The token (offset in the `dbprint_tokens` section) of the string table entry.
+ *
+ * @param[in] value
+ *   The value to print between the two string parts.
+ *****************************************************************************/
+void dbprint_tokenInt_hex_ctx (dbprint_t *db, uint32_t token, int32_t value)
+{
+	/* Start character + timestamp + token + value (max 5 bytes each) */
+	uint8_t record[16];
+	uint8_t length = token_start(db, record);
+
+	length += uint32_to_varint(&record[length], token);
+	length += uint32_to_varint(&record[length], (uint32_t)value);
+
+	/* Transmit the record in one go */
+	uint8_t level = token_level(token);
+	db->stats.records[level - 1]++;
+	dbprint_write(db, (char *)record, length, level);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Initialize USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbprint_INIT_ctx`.
+ *****************************************************************************/
+void dbprint_INIT (USART_TypeDef* pointer, uint8_t location, bool vcom, bool interrupts)
+{
+	dbprint_INIT_ctx(&dbdefault, pointer, location, vcom, interrupts);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Initialize USARTx using a struct with all of the settings.
+ *
+ * @details
+ *   Uses the default instance, see `dbprint_INIT_config_ctx`.
+ *****************************************************************************/
+void dbprint_INIT_config (const dbprint_init_t *init)
+{
+	dbprint_INIT_config_ctx(&dbdefault, init);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Sound an alert in the terminal.
+ *
+ * @details
+ *   Uses the default instance, see `dbAlert_ctx`.
+ *****************************************************************************/
+void dbAlert (void)
+{
+	dbAlert_ctx(&dbdefault);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Clear the terminal.
+ *
+ * @details
+ *   Uses the default instance, see `dbClear_ctx`.
+ *****************************************************************************/
+void dbClear (void)
+{
+	dbClear_ctx(&dbdefault);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a string (char array) to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbprint_ctx`.
+ *****************************************************************************/
+void dbprint (char *message)
+{
+	dbprint_ctx(&dbdefault, message);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a string (char array) to USARTx and go to the next line.
+ *
+ * @details
+ *   Uses the default instance, see `dbprintln_ctx`.
+ *****************************************************************************/
+void dbprintln (char *message)
+{
+	dbprintln_ctx(&dbdefault, message);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a given amount of characters to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbprintn_ctx`.
+ *****************************************************************************/
+void dbprintn (const char *message, uint32_t length)
+{
+	dbprintn_ctx(&dbdefault, message, length);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a string (char array) to USARTx in a given color.
+ *
+ * @details
+ *   Uses the default instance, see `dbprint_color_ctx`.
+ *****************************************************************************/
+void dbprint_color (char *message, dbprint_color_t color)
+{
+	dbprint_color_ctx(&dbdefault, message, color);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a string (char array) to USARTx in a given color and go to the next line.
+ *
+ * @details
+ *   Uses the default instance, see `dbprintln_color_ctx`.
+ *****************************************************************************/
+void dbprintln_color (char *message, dbprint_color_t color)
+{
+	dbprintln_color_ctx(&dbdefault, message, color);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a *trace* string (char array) to USARTx and go to the next line.
+ *
+ * @details
+ *   Uses the default instance, see `dbtrace_ctx`.
+ *****************************************************************************/
+void dbtrace (char *message)
+{
+	dbtrace_ctx(&dbdefault, message);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print an *info* string (char array) to USARTx and go to the next line.
+ *
+ * @details
+ *   Uses the default instance, see `dbinfo_ctx`.
+ *****************************************************************************/
+void dbinfo (char *message)
+{
+	dbinfo_ctx(&dbdefault, message);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a *warning* string (char array) in yellow to USARTx and go to the next line.
+ *
+ * @details
+ *   Uses the default instance, see `dbwarn_ctx`.
+ *****************************************************************************/
+void dbwarn (char *message)
+{
+	dbwarn_ctx(&dbdefault, message);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a *critical error* string (char array) in red to USARTx and go to the next line.
+ *
+ * @details
+ *   Uses the default instance, see `dbcrit_ctx`.
+ *****************************************************************************/
+void dbcrit (char *message)
+{
+	dbcrit_ctx(&dbdefault, message);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a *trace* value surrounded by two strings (char array) to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbtraceInt_ctx`.
+ *****************************************************************************/
+void dbtraceInt (char *message1, int32_t value, char *message2)
+{
+	dbtraceInt_ctx(&dbdefault, message1, value, message2);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print an *info* value surrounded by two strings (char array) to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbinfoInt_ctx`.
+ *****************************************************************************/
+void dbinfoInt (char *message1, int32_t value, char *message2)
+{
+	dbinfoInt_ctx(&dbdefault, message1, value, message2);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a *warning* value surrounded by two strings (char array) to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbwarnInt_ctx`.
+ *****************************************************************************/
+void dbwarnInt (char *message1, int32_t value, char *message2)
+{
+	dbwarnInt_ctx(&dbdefault, message1, value, message2);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a *critical* value surrounded by two strings (char array) to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbcritInt_ctx`.
+ *****************************************************************************/
+void dbcritInt (char *message1, int32_t value, char *message2)
+{
+	dbcritInt_ctx(&dbdefault, message1, value, message2);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a *trace* value surrounded by two strings (char array) to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbtraceInt_hex_ctx`.
+ *****************************************************************************/
+void dbtraceInt_hex (char *message1, int32_t value, char *message2)
+{
+	dbtraceInt_hex_ctx(&dbdefault, message1, value, message2);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print an *info* value surrounded by two strings (char array) to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbinfoInt_hex_ctx`.
+ *****************************************************************************/
+void dbinfoInt_hex (char *message1, int32_t value, char *message2)
+{
+	dbinfoInt_hex_ctx(&dbdefault, message1, value, message2);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a *warning* value surrounded by two strings (char array) to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbwarnInt_hex_ctx`.
+ *****************************************************************************/
+void dbwarnInt_hex (char *message1, int32_t value, char *message2)
+{
+	dbwarnInt_hex_ctx(&dbdefault, message1, value, message2);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a *critical* value surrounded by two strings (char array) to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbcritInt_hex_ctx`.
+ *****************************************************************************/
+void dbcritInt_hex (char *message1, int32_t value, char *message2)
+{
+	dbcritInt_hex_ctx(&dbdefault, message1, value, message2);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a number in decimal notation to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbprintInt_ctx`.
+ *****************************************************************************/
+void dbprintInt (int32_t value)
+{
+	dbprintInt_ctx(&dbdefault, value);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a number in decimal notation to USARTx and go to the next line.
+ *
+ * @details
+ *   Uses the default instance, see `dbprintlnInt_ctx`.
+ *****************************************************************************/
+void dbprintlnInt (int32_t value)
+{
+	dbprintlnInt_ctx(&dbdefault, value);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a number in hexadecimal notation to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbprintInt_hex_ctx`.
+ *****************************************************************************/
+void dbprintInt_hex (int32_t value)
+{
+	dbprintInt_hex_ctx(&dbdefault, value);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a number in hexadecimal notation to USARTx and go to the next line.
+ *
+ * @details
+ *   Uses the default instance, see `dbprintlnInt_hex_ctx`.
+ *****************************************************************************/
+void dbprintlnInt_hex (int32_t value)
+{
+	dbprintlnInt_hex_ctx(&dbdefault, value);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Send binary data to USARTx in a frame (in between the text output).
+ *
+ * @details
+ *   Uses the default instance, see `dbprint_frame_ctx`.
+ *****************************************************************************/
+bool dbprint_frame (const uint8_t *data, uint32_t length)
+{
+	return (dbprint_frame_ctx(&dbdefault, data, length));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a hexdump of a block of memory to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbHexdump_ctx`.
+ *****************************************************************************/
+void dbHexdump (const void *data, uint32_t length)
+{
+	dbHexdump_ctx(&dbdefault, data, length);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Read a character from USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbReadChar_ctx`.
+ *****************************************************************************/
+char dbReadChar (void)
+{
+	return (dbReadChar_ctx(&dbdefault));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Read a decimal character from USARTx and convert it to a `uint8_t` value.
+ *
+ * @details
+ *   Uses the default instance, see `dbReadInt_ctx`.
+ *****************************************************************************/
+uint8_t dbReadInt (void)
+{
+	return (dbReadInt_ctx(&dbdefault));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Read a string (char array) from USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbReadLine_ctx`.
+ *****************************************************************************/
+void dbReadLine (char *buf)
+{
+	dbReadLine_ctx(&dbdefault, buf);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Check if data was received using interrupts in the RX queue.
+ *
+ * @details
+ *   Uses the default instance, see `dbGet_RXstatus_ctx`.
+ *****************************************************************************/
+bool dbGet_RXstatus (void)
+{
+	return (dbGet_RXstatus_ctx(&dbdefault));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Get the amount of records that were dropped because the TX queue was full.
+ *
+ * @details
+ *   Uses the default instance, see `dbGet_TXdropped_ctx`.
+ *****************************************************************************/
+uint32_t dbGet_TXdropped (void)
+{
+	return (dbGet_TXdropped_ctx(&dbdefault));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Wait until all data has left the chip.
+ *
+ * @details
+ *   Uses the default instance, see `dbFlush_ctx`.
+ *****************************************************************************/
+void dbFlush (void)
+{
+	dbFlush_ctx(&dbdefault);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Wait until all data has left the chip or the timeout has passed.
+ *
+ * @details
+ *   Uses the default instance, see `dbFlush_timeout_ctx`.
+ *****************************************************************************/
+bool dbFlush_timeout (uint32_t timeout)
+{
+	return (dbFlush_timeout_ctx(&dbdefault, timeout));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Gate the clock of USARTx if it has been idle long enough.
+ *
+ * @details
+ *   Uses the default instance, see `dbIdle_poll_ctx`.
+ *****************************************************************************/
+void dbIdle_poll (void)
+{
+	dbIdle_poll_ctx(&dbdefault);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Get the statistics of the logging path.
+ *
+ * @details
+ *   Uses the default instance, see `dbprint_stats_ctx`.
+ *****************************************************************************/
+void dbprint_stats (dbprint_stats_t *stats)
+{
+	dbprint_stats_ctx(&dbdefault, stats);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print the statistics of the logging path to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbprintStats_ctx`.
+ *****************************************************************************/
+void dbprintStats (void)
+{
+	dbprintStats_ctx(&dbdefault);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Reset the statistics of the logging path.
+ *
+ * @details
+ *   Uses the default instance, see `dbprintStats_reset_ctx`.
+ *****************************************************************************/
+void dbprintStats_reset (void)
+{
+	dbprintStats_reset_ctx(&dbdefault);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Copy the oldest received line from the RX queue and remove it from the queue.
+ *
+ * @details
+ *   Uses the default instance, see `dbGet_RXbuffer_ctx`.
+ *****************************************************************************/
+void dbGet_RXbuffer (char *buf)
+{
+	dbGet_RXbuffer_ctx(&dbdefault, buf);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Get the oldest received line from the RX queue without copying it.
+ *
+ * @details
+ *   Uses the default instance, see `dbGet_RXline_ctx`.
+ *****************************************************************************/
+char *dbGet_RXline (uint32_t *length)
+{
+	return (dbGet_RXline_ctx(&dbdefault, length));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Remove the oldest received line (returned by `dbGet_RXline`) from the RX queue.
+ *
+ * @details
+ *   Uses the default instance, see `dbRelease_RXline_ctx`.
+ *****************************************************************************/
+void dbRelease_RXline (void)
+{
+	dbRelease_RXline_ctx(&dbdefault);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Get the oldest received number from the value queue.
+ *
+ * @details
+ *   Uses the default instance, see `dbGet_RXvalue_ctx`.
+ *****************************************************************************/
+bool dbGet_RXvalue (int32_t *value)
+{
+	return (dbGet_RXvalue_ctx(&dbdefault, value));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Execute the oldest received line as a shell command.
+ *
+ * @details
+ *   Uses the default instance, see `dbShell_ctx`.
+ *****************************************************************************/
+bool dbShell (const dbprint_shell_t *shell)
+{
+	return (dbShell_ctx(&dbdefault, shell));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Register a callback that is called when a read is complete.
+ *
+ * @details
+ *   Uses the default instance, see `dbReadAsync_ctx`.
+ *****************************************************************************/
+bool dbReadAsync (uint32_t count, uint32_t timeout, dbprint_callback_t callback, bool deferred)
+{
+	return (dbReadAsync_ctx(&dbdefault, count, timeout, callback, deferred));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Check the timeout of the asynchronous read and call the deferred callback.
+ *
+ * @details
+ *   Uses the default instance, see `dbReadAsync_poll_ctx`.
+ *****************************************************************************/
+void dbReadAsync_poll (void)
+{
+	dbReadAsync_poll_ctx(&dbdefault);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a tokenized record without a value to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbprint_token_ctx`.
+ *****************************************************************************/
+void dbprint_token (uint32_t token)
+{
+	dbprint_token_ctx(&dbdefault, token);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a tokenized record with a value in decimal notation to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbprint_tokenInt_ctx`.
+ *****************************************************************************/
+void dbprint_tokenInt (uint32_t token, int32_t value)
+{
+	dbprint_tokenInt_ctx(&dbdefault, token, value);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a tokenized record with a value in hexadecimal notation to USARTx.
+ *
+ * @details
+ *   Uses the default instance, see `dbprint_tokenInt_hex_ctx`.
+ *****************************************************************************/
+void dbprint_tokenInt_hex (uint32_t token, int32_t value)
+{
+	dbprint_tokenInt_hex_ctx(&dbdefault, token, value);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Assemble an info, warning, ... record and submit it as one unit.
+ *
+ * @details
+ *   The prefix, color codes, messages, value and CR+LF are collected as parts
+ *   of one record (without copying them) which is written to the TX path at
+ *   once, so the record can't be split up by other output once it's queued.
+ *   Compared to printing every part
+ *   separately, color codes are only sent when the color actually changes.
+ *   The color code and prefix are one literal in `levelHeads` (copied
+ *   without looking for the end of it):@n
+ *   `<color>WARN: message1<reset>value<color>message2<reset>CRLF`@n
+ *   (`<color>message2` is left out if `message2` is empty).@n
+ *   If timestamps are enabled the record starts with `+delta ` (see `timestamp_delta`).
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] level
+ *   The level of the record (`DBPRINT_LEVEL_XXX`), selects the prefix and
+ *   color and is used by the overflow policy.
+ *
+ * @param[in] message1
+ *   The first part of the string.
+ *
+ * @param[in] value
+ *   The value to print between the two string parts.
+ *
+ * @param[in] notation
+ *   @li `'-'` - No value.
+ *   @li `'d'` - Value in decimal notation.
+ *   @li `'x'` - Value in hexadecimal notation.
+ *
+ * @param[in] message2
+ *   The second part of the string.
+ *****************************************************************************/
+static void dbprint_record (dbprint_t *db, uint8_t level, char *message1, int32_t value, char notation, char *message2)
+{
+	record_t record;
+	record_start(&record, db, level);
+
+	db->stats.records[level - 1]++;
+
+	/* Color code of the messages (NULL: default color) */
+	const literal_t *color = (levelColors[level - 1] != DEFAULT_COLOR) ? &colorCodes[levelColors[level - 1]] : NULL;
+
+	/* Timestamp (captured now, not when the record is transmitted) */
+	uint32_t delta;
+	if (timestamp_delta(db, &delta))
+	{
+		record_appendn(&record, "+", 1);
+		record_appendInt(&record, delta, 'u');
+		record_appendn(&record, " ", 1);
+	}
+
+	record_appendn(&record, levelHeads[level - 1].text, levelHeads[level - 1].length);
+	record_append(&record, message1);
+
+	if (notation != '-')
+	{
+		/* The value is printed in the default color */
+		if (color != NULL) record_appendn(&record, COLOR_RESET, sizeof(COLOR_RESET) - 1);
+		record_appendInt(&record, value, notation);
+
+		/* Only switch back to the color if there is something to print in it */
+		if ((color != NULL) && (message2[0] != '\0'))
+		{
+			record_appendn(&record, color->text, color->length);
+			record_append(&record, message2);
+			record_appendn(&record, COLOR_RESET, sizeof(COLOR_RESET) - 1);
+		}
+		else
+		{
+			record_append(&record, message2);
+		}
+	}
+	else
+	{
+		record_append(&record, message2);
+		if (color != NULL) record_appendn(&record, COLOR_RESET, sizeof(COLOR_RESET) - 1);
+	}
+
+	/* Carriage return and line feed (new line) */
+	record_appendn(&record, "\r\n", 2);
+
+	/* Submit the record */
+	record_submit(&record);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a string in a color as one record (`dbprint(ln)_color`).
+ *
+ * @details
+ *   The color code, message, reset code (not necessary for the default
+ *   color) and CR+LF are written to the TX path at once.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] message
+ *   The string to print to USARTx.
+ *
+ * @param[in] color
+ *   The color to print the text in.
+ *
+ * @param[in] newline
+ *   @li `true` - Go to the next line (CR+LF).
+ *   @li `false` - Stay on the same line.
+ *****************************************************************************/
+static void dbprint_colorRecord (dbprint_t *db, char *message, dbprint_color_t color, bool newline)
+{
+	record_t record;
+	record_start(&record, db, DBPRINT_LEVEL_INFO);
+	record.split = true;
+
+	/* Unknown colors are printed in the default color */
+	if (color > DEFAULT_COLOR) color = DEFAULT_COLOR;
+
+	record_appendn(&record, colorCodes[color].text, colorCodes[color].length);
+	record_append(&record, message);
+	if (color != DEFAULT_COLOR) record_appendn(&record, COLOR_RESET, sizeof(COLOR_RESET) - 1);
+	if (newline) record_appendn(&record, "\r\n", 2);
+
+	record_submit(&record);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print a number as one record (`dbprint(ln)Int(_hex)`).
+ *
+ * @details
+ *   The sign (or `0x`), digits and CR+LF are written to the TX path at once,
+ *   so an interrupt handler can't print something in between.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] value
+ *   The number to print.
+ *
+ * @param[in] notation
+ *   @li `'d'` - Decimal notation.
+ *   @li `'x'` - Hexadecimal notation (with `0x` prefix).
+ *
+ * @param[in] newline
+ *   @li `true` - Go to the next line (CR+LF).
+ *   @li `false` - Stay on the same line.
+ *****************************************************************************/
+static void dbprint_valueRecord (dbprint_t *db, int32_t value, char notation, bool newline)
+{
+	record_t record;
+	record_start(&record, db, DBPRINT_LEVEL_INFO);
+
+	record_appendInt(&record, value, notation);
+	if (newline) record_appendn(&record, "\r\n", 2);
+
+	record_submit(&record);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Start assembling a record.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] record
+ *   The record to start.
+ *
+ * @param[in] db
+ *   The instance the record is written to (see `dbprint_t`).
+ *
+ * @param[in] level
+ *   The level of the record (`DBPRINT_LEVEL_XXX`).
+ *****************************************************************************/
+static void record_start (record_t *record, dbprint_t *db, uint8_t level)
+{
+	record->count = 0;
+	record->numberCount = 0;
+	record->level = level;
+	record->split = false;
+	record->db = db;
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Append a string to a record.
+ *
+ * @details
+ *   The length is determined first (see `string_length`), the string is
+ *   appended with `record_appendn`.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] record
+ *   The record to append to.
+ *
+ * @param[in] string
+ *   The string to append (ending with NULL).
+ *****************************************************************************/
+static void record_append (record_t *record, const char *string)
+{
+	record_appendn(record, string, string_length(string));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Append a given amount of characters to a record.
+ *
+ * @details
+ *   Only the pointer and length are stored, the characters are copied when
+ *   the record is submitted (`record_submit`), so they need to stay valid
+ *   until then. Empty parts are left out.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] record
+ *   The record to append to.
+ *
+ * @param[in] data
+ *   The characters to append.
+ *
+ * @param[in] length
+ *   The amount of characters to append.
+ *****************************************************************************/
+static void record_appendn (record_t *record, const char *data, uint32_t length)
+{
+	if ((length == 0) || (record->count == RECORD_PARTS)) return;
+
+	record->parts[record->count].data = data;
+	record->parts[record->count].length = length;
+	record->count++;
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Append a value to a record, formatted like `dbprintInt` or `dbprintInt_hex`.
+ *
+ * @details
+ *   The value is converted in a buffer of the record (see `RECORD_NUMBERS`).
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] record
+ *   The record to append to.
+ *
+ * @param[in] value
+ *   The value to append.
+ *
+ * @param[in] notation
+ *   @li `'d'` - Decimal notation.
+ *   @li `'u'` - Decimal notation, the value is unsigned.
+ *   @li `'x'` - Hexadecimal notation (with `0x` prefix).
+ *****************************************************************************/
+static void record_appendInt (record_t *record, int32_t value, char notation)
+{
+	if (record->numberCount == RECORD_NUMBERS) return;
+
+	char *position = record->numbers[record->numberCount++];
+
+	if (notation == 'x')
+	{
+		position[0] = '0';
+		position[1] = 'x';
+		uint32_to_charHex(&position[2], value, true); /* true: add spacing between eight HEX chars */
+	}
+	else if ((value < 0) && (notation == 'd'))
+	{
+		/* Negative of value (on the unsigned value so INT32_MIN doesn't overflow) */
+		position[0] = '-';
+		uint32_to_charDec(&position[1], (~(uint32_t)value) + 1);
+	}
+	else
+	{
+		uint32_to_charDec(position, value);
+	}
+
+	/* Don't include the NULL termination character */
+	uint32_t length = 0;
+	while (position[length] != '\0') length++;
+
+	record_appendn(record, position, length);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Submit an assembled record to the TX path as one unit (see `dbprint_writev`).
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] record
+ *   The record to submit.
+ *****************************************************************************/
+static void record_submit (record_t *record)
+{
+	dbprint_writev(record->db, record->parts, record->count, record->level, record->split);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Get the level of a tokenized record.
+ *
+ * @details
+ *   The first character of the string table entry (`T`, `I`, `W` or `C`) is
+ *   used, records are treated as *info* records if there is no string table
+ *   (no tokenized records in the firmware).
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] token
+ *   The token (offset in the `dbprint_tokens` section) of the string table entry.
+ *
+ * @return
+ *   The level of the record (`DBPRINT_LEVEL_XXX`).
+ *****************************************************************************/
+static uint8_t token_level (uint32_t token)
+{
+	/* Weak: the linker only creates the symbol if there is a "dbprint_tokens" section */
+	extern const char __start_dbprint_tokens[] __attribute__((weak));
+
+	if (__start_dbprint_tokens == NULL) return (DBPRINT_LEVEL_INFO);
+
+	switch (__start_dbprint_tokens[token])
+	{
+		case 'T': return (DBPRINT_LEVEL_TRACE);
+		case 'W': return (DBPRINT_LEVEL_WARN);
+		case 'C': return (DBPRINT_LEVEL_CRIT);
+		default: return (DBPRINT_LEVEL_INFO);
+	}
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Put the start of a tokenized record in a buffer.
+ *
+ * @details
+ *   Without timestamps this is only `DBPRINT_TOKEN_START`, otherwise
+ *   `DBPRINT_TOKEN_START_TIME` followed by the delta (varint, see
+ *   `timestamp_delta`).
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[out] buf
+ *   The buffer to put the bytes in.@n
+ *   **This needs to have room for 6 bytes!**
+ *
+ * @return
+ *   The amount of bytes put in the buffer.
+ *****************************************************************************/
+static uint8_t token_start (dbprint_t *db, uint8_t *buf)
+{
+	uint32_t delta;
+
+	if (!timestamp_delta(db, &delta))
+	{
+		buf[0] = DBPRINT_TOKEN_START;
+		return (1);
+	}
+
+	buf[0] = DBPRINT_TOKEN_START_TIME;
+	return (1 + uint32_to_varint(&buf[1], delta));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Capture the timestamp of a record (if timestamps are enabled).
+ *
+ * @details
+ *   Only the counter register is read, the delta to the previous record
+ *   (in counter ticks) is sent instead of the absolute value to keep the
+ *   records short. The counter is read and the previous value updated in a
+ *   critical section, so the deltas of all records add up.
+ *
+ * @note
+ *   A record of an interrupt handler that interrupts a print method after
+ *   this point is transmitted first, while its delta is relative to the
+ *   interrupted record.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[out] delta
+ *   The counter ticks since the previous record (wrap-around is handled
+ *   using the mask of the counter).
+ *
+ * @return
+ *   @li `true` - Timestamps are enabled, `delta` is valid.
+ *   @li `false` - Timestamps are disabled.
+ *****************************************************************************/
+static bool timestamp_delta (dbprint_t *db, uint32_t *delta)
+{
+	if (db->timestamp == NULL) return (false);
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	uint32_t now = *db->timestamp;
+	*delta = (now - db->timestampLast) & db->timestampMask;
+	db->timestampLast = now;
+
+	CORE_EXIT_CRITICAL();
+
+	return (true);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Write data to USARTx, directly or using the TX queue.
+ *
+ * @details
+ *   The data is written as a record with one part, see `dbprint_writev`.
+ *   It's unleveled: data longer than `DBPRINT_RECORD_SIZE` is split up
+ *   instead of truncated.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] data
+ *   The characters to write to USARTx.
+ *
+ * @param[in] length
+ *   The amount of characters to write.
+ *
+ * @param[in] level
+ *   The level of the data (`DBPRINT_LEVEL_XXX`), `dbprint(ln)` methods use
+ *   `DBPRINT_LEVEL_INFO`.
+ *
+ * @return
+ *   @li `true` - The data is written (or queued).
+ *   @li `false` - (A part of) the data is dropped.
+ *****************************************************************************/
+static bool dbprint_write (dbprint_t *db, const char *data, uint32_t length, uint8_t level)
+{
+	part_t part;
+
+	part.data = data;
+	part.length = length;
+
+	return (dbprint_writev(db, &part, 1, level, true));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Write a record consisting of several parts to USARTx, directly or using
+ *   the TX queue.
+ *
+ * @details
+ *   If interrupt functionality is disabled, every character is written using
+ *   `USART_Tx` or `LEUART_Tx` (which wait until there is room in their TX buffer).@n
+ *   In interrupt mode room for the whole record (the total length of the
+ *   parts) is reserved in the TX queue at once, the parts are copied
+ *   (without blocking interrupts) and the record is committed. The TX handler
+ *   only transmits committed data, so output of an interrupt handler that
+ *   interrupts this method ends up before or after the record, never in
+ *   the middle.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @note
+ *   In interrupt mode a record longer than `DBPRINT_RECORD_SIZE` is truncated
+ *   to that length and ends with `[truncated]` (and CR+LF, counted in
+ *   `truncated`). Unleveled data (`split`, `dbprint`, `dbprintn`, ...) is
+ *   written as several records of at most `DBPRINT_RECORD_SIZE` characters
+ *   instead (an interrupt handler can print in between them).
+ *
+ * @attention
+ *   If the TX queue is full the record can be dropped, depending on the
+ *   overflow policy (see `tx_reserve`).
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] parts
+ *   The parts of the record.
+ *
+ * @param[in] count
+ *   The amount of parts.
+ *
+ * @param[in] level
+ *   The level of the record (`DBPRINT_LEVEL_XXX`).
+ *
+ * @param[in] split
+ *   @li `true` - Unleveled data, split up if it's too long.
+ *   @li `false` - Truncate the record if it's too long.
+ *
+ * @return
+ *   @li `true` - The record is written (or queued).
+ *   @li `false` - The record (or a part of split up data) is dropped.
+ *****************************************************************************/
+static bool dbprint_writev (dbprint_t *db, const part_t *parts, uint32_t count, uint8_t level, bool split)
+{
+	uint32_t length = 0;
+	for (uint32_t i = 0; i < count; i++) length += parts[i].length;
+
+	/* Blocking mode: write every character directly to the USART */
+	if (!db->txQueued)
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			for (uint32_t j = 0; j < parts[i].length; j++)
+			{
+				uart_write(db, parts[i].data[j]);
+			}
+		}
+
+		db->stats.queued += length;
+		db->stats.sent += length;
+
+		return (true);
+	}
+
+	/* Interrupt mode: part and offset of the next character to copy */
+	uint32_t part = 0;
+	uint32_t offset = 0;
+
+	do
+	{
+		/* Records that are too long are split up (unleveled data) or truncated (the marker replaces the end) */
+		uint32_t size = (length > DBPRINT_RECORD_SIZE) ? DBPRINT_RECORD_SIZE : length;
+		bool truncated = (length > DBPRINT_RECORD_SIZE) && !split;
+		uint32_t copy = truncated ? (size - truncatedMarker.length) : size;
+
+		/* Reserve room for the whole record, copy the parts and commit it */
+		uint32_t index;
+		if (!tx_reserve(db, size, level, &index)) return (false); /* Dropped */
+
+		while (copy > 0)
+		{
+			uint32_t chunk = parts[part].length - offset;
+			if (chunk > copy) chunk = copy;
+
+			index = tx_copy(db, index, &parts[part].data[offset], chunk);
+			copy -= chunk;
+			offset += chunk;
+
+			if (offset == parts[part].length)
+			{
+				part++;
+				offset = 0;
+			}
+		}
+
+		if (truncated)
+		{
+			tx_copy(db, index, truncatedMarker.text, truncatedMarker.length);
+
+			/* Interrupt handlers can also truncate records: count it in a critical section */
+			CORE_DECLARE_IRQ_STATE;
+			CORE_ENTER_CRITICAL();
+			db->stats.truncated++;
+			CORE_EXIT_CRITICAL();
+		}
+
+		tx_commit(db);
+
+		length = truncated ? 0 : (length - size);
+	} while (length > 0);
+
+	return (true);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Copy characters to reserved room in the TX queue.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] index
+ *   The (free-running) index of the first character (see `tx_reserve`).
+ *
+ * @param[in] data
+ *   The characters to copy.
+ *
+ * @param[in] length
+ *   The amount of characters to copy.
+ *
+ * @return
+ *   The index after the copied characters.
+ *****************************************************************************/
+static uint32_t tx_copy (dbprint_t *db, uint32_t index, const char *data, uint32_t length)
+{
+	/* Copy in (at most) two parts, before and after the end of the ring buffer */
+	uint32_t start = index & TX_MASK;
+	uint32_t first = DBPRINT_TX_BUFFER_SIZE - start;
+	if (first > length) first = length;
+
+	for (uint32_t i = 0; i < first; i++) db->tx_buffer[start + i] = data[i];
+	for (uint32_t i = first; i < length; i++) db->tx_buffer[i - first] = data[i];
+
+	return (index + length);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Reserve room for a record in the TX queue.
+ *
+ * @details
+ *   The reservation itself only takes a few instructions with interrupts
+ *   disabled (PRIMASK, the Cortex-M0+ has no exclusive load/store
+ *   instructions). If records were dropped since the last reservation, a
+ *   `[N records dropped]` marker is put in front of the record (if there
+ *   is room for it).@n
+ *   If the TX queue is full the overflow policy decides what happens:
+ *     - `OVERFLOW_BLOCK`: Wait (sleeping in EM1) for the TX handler to free up space.
+ *     - `OVERFLOW_DROP_NEWEST`: Drop the new record.
+ *     - `OVERFLOW_DROP_OLDEST` and `OVERFLOW_DROP_LOW_PRIORITY`: Drop queued
+ *       records to make room (see `tx_drop`), the new record is dropped if
+ *       that isn't possible.
+ *
+ *   Waiting isn't possible if the TX (or DMA) interrupt can't interrupt the
+ *   caller (interrupts are disabled or the caller is an interrupt handler
+ *   with the same or a higher priority) or if the caller interrupted another
+ *   print method that didn't commit its record yet (nothing after that record
+ *   can be transmitted before the caller returns). The record is dropped
+ *   in that case.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] length
+ *   The amount of characters to reserve (max `DBPRINT_RECORD_SIZE`, so the
+ *   `[N records dropped]` marker always fits in front of it).
+ *
+ * @param[in] level
+ *   The level of the record (`DBPRINT_LEVEL_XXX`).
+ *
+ * @param[out] index
+ *   The (free-running) index of the first reserved character.
+ *
+ * @return
+ *   @li `true` - The room is reserved, `tx_commit` needs to be called afterwards.
+ *   @li `false` - The record is dropped.
+ *****************************************************************************/
+static bool tx_reserve (dbprint_t *db, uint32_t length, uint8_t level, uint32_t *index)
+{
+	/* Checked before entering the critical section (it blocks all interrupts itself) */
+	bool wait = (db->txOverflow == OVERFLOW_BLOCK) && !CORE_IrqIsBlocked(db->txIRQn);
+	bool waited = false;
+	uint32_t sent = 0; /* Characters transmitted before waiting */
+
+	CORE_DECLARE_IRQ_STATE;
+
+	while (true)
+	{
+		/* Format the marker if records were dropped, before entering the critical section
+		 *   (max "[65535 records dropped]\r\n", the rest is counted by the next marker) */
+		char marker[32];
+		uint32_t markerLength = 0;
+		uint32_t markerCount = db->txDropped;
+		if (markerCount > UINT16_MAX) markerCount = UINT16_MAX;
+
+		if (markerCount > 0)
+		{
+			marker[0] = '[';
+			uint32_to_charDec(&marker[1], markerCount);
+			markerLength = 1;
+			while (marker[markerLength] != '\0') markerLength++;
+
+			const char *text = " records dropped]\r\n";
+			while (*text) marker[markerLength++] = *text++;
+		}
+
+		CORE_ENTER_CRITICAL();
+
+		/* Another print method (interrupt handler) wrote a marker in the meantime: format it again */
+		if (markerCount > db->txDropped)
+		{
+			CORE_EXIT_CRITICAL();
+			continue;
+		}
+
+		/* Remove the records that are completely transmitted from the list */
+		while ((db->recordTail != db->recordHead) && ((int32_t)(db->txTail - db->txRecords[db->recordTail & RECORD_MASK].end) >= 0))
+		{
+			db->recordTail++;
+		}
+
+		uint32_t room = DBPRINT_TX_BUFFER_SIZE - (db->txHead - db->txTail);
+		uint32_t recordRoom = DBPRINT_TX_RECORDS - (db->recordHead - db->recordTail);
+		drop_t drop;
+
+		/* Leave the marker for later if there is only room for the record and waiting isn't possible */
+		if ((markerLength > 0) && ((room < (length + markerLength)) || (recordRoom < 2)))
+		{
+			if (tx_drop(db, length + markerLength, 2, level, &drop))
+			{
+				/* Make room outside of the critical section and try again */
+				CORE_EXIT_CRITICAL();
+				tx_move(db, &drop);
+				continue;
+			}
+
+			if (!(wait && (db->txPending == 0))) markerLength = 0;
+		}
+
+		uint32_t needed = length + markerLength;
+		uint32_t records = (markerLength > 0) ? 2 : 1;
+
+		if ((room >= needed) && (recordRoom >= records))
+		{
+			uint32_t markerIndex = db->txHead;
+
+			if (markerLength > 0)
+			{
+				/* The marker is a separate record (if it gets dropped its count is added to the next one) */
+				db->txHead += markerLength;
+				db->txRecords[db->recordHead & RECORD_MASK].end = db->txHead;
+				db->txRecords[db->recordHead & RECORD_MASK].level = LEVEL_MARKER;
+				db->txRecords[db->recordHead & RECORD_MASK].dropped = markerCount;
+				db->recordHead++;
+				db->txDropped -= markerCount;
+			}
+
+			*index = db->txHead;
+			db->txHead += length;
+			db->txRecords[db->recordHead & RECORD_MASK].end = db->txHead;
+			db->txRecords[db->recordHead & RECORD_MASK].level = level;
+			db->txRecords[db->recordHead & RECORD_MASK].dropped = 0;
+			db->recordHead++;
+			db->txPending++;
+
+			/* Update the statistics */
+			db->stats.queued += needed;
+			if ((db->txHead - db->txTail) > db->stats.highWater) db->stats.highWater = db->txHead - db->txTail;
+			if (waited) db->stats.blockedChars += db->stats.sent - sent;
+
+			CORE_EXIT_CRITICAL();
+
+			/* Copy the marker like a record (it's only transmitted after the record is committed) */
+			if (markerLength > 0) tx_copy(db, markerIndex, marker, markerLength);
+
+			return (true);
+		}
+
+		if (tx_drop(db, needed, records, level, &drop))
+		{
+			/* Make room outside of the critical section and try again */
+			CORE_EXIT_CRITICAL();
+			tx_move(db, &drop);
+			continue;
+		}
+
+		/* The TX queue is full, drop the record if waiting isn't possible */
+		if (!wait || (db->txPending > 0))
+		{
+			db->txDropped++;
+			db->stats.dropped++;
+
+			CORE_EXIT_CRITICAL();
+			return (false);
+		}
+
+		if (!waited)
+		{
+			waited = true;
+			sent = db->stats.sent;
+			db->stats.blocked++;
+		}
+
+		uint32_t tail = db->txTail;
+
+		CORE_EXIT_CRITICAL();
+
+		/* Sleep in EM1 until the TX handler has freed up space. Only if nothing is transmitted since the check,
+		 *   WFI also wakes up with interrupts disabled (the TX handler runs after leaving the critical section) */
+		tx_start(db);
+
+		CORE_ENTER_CRITICAL();
+		if (db->txTail == tail) EMU_EnterEM1();
+		CORE_EXIT_CRITICAL();
+	}
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Drop the oldest records in the TX queue to make room for a new one.
+ *
+ * @details
+ *   Only used by the `OVERFLOW_DROP_OLDEST` and `OVERFLOW_DROP_LOW_PRIORITY`
+ *   policies, called in a critical section by `tx_reserve`.@n
+ *   The oldest record is kept because the TX handler is already transmitting
+ *   it, the records after it are dropped (oldest first) until there is
+ *   enough room. Only the records to drop are selected here (at most
+ *   `DBPRINT_TX_RECORDS`), the TX handler is paused and `tx_move` moves the
+ *   characters of the oldest record that still need to be transmitted up to
+ *   the first character that's kept, outside of the critical section. A
+ *   dropped `[N records dropped]` marker isn't lost: its count is added to
+ *   the next marker. Nothing is dropped if there wouldn't be enough room
+ *   afterwards, if another print method is moving characters (`txMoving`) or
+ *   if a record that would need to be dropped:
+ *     - isn't committed yet (an interrupted print method is still filling it in).
+ *     - has the same or a higher priority as the new record (`OVERFLOW_DROP_LOW_PRIORITY`).
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @note
+ *   In `TX_DMA` mode nothing can be dropped: the DMA controller reads the
+ *   queued characters itself and they can't be moved.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] length
+ *   The amount of characters that need to fit in the TX queue.
+ *
+ * @param[in] records
+ *   The amount of records that need to fit in the record list.
+ *
+ * @param[in] level
+ *   The level of the new record (`DBPRINT_LEVEL_XXX`).
+ *
+ * @param[out] drop
+ *   The records to drop, `tx_move` needs to be called with it (after the critical section).
+ *
+ * @return
+ *   @li `true` - Records are selected, there is enough room after `tx_move`.
+ *   @li `false` - Nothing is dropped.
+ *****************************************************************************/
+static bool tx_drop (dbprint_t *db, uint32_t length, uint32_t records, uint8_t level, drop_t *drop)
+{
+	if ((db->txOverflow != OVERFLOW_DROP_OLDEST) && (db->txOverflow != OVERFLOW_DROP_LOW_PRIORITY)) return (false);
+	if (db->txMoving) return (false);
+
+#if DBPRINT_DMA == 1
+	if (db->txMode == TX_DMA) return (false);
+#endif
+
+	/* The oldest record needs to be committed, its characters get moved */
+	if ((db->recordTail == db->recordHead) || ((int32_t)(db->txCommit - db->txRecords[db->recordTail & RECORD_MASK].end) < 0)) return (false);
+
+	uint32_t keep = db->txRecords[db->recordTail & RECORD_MASK].end - db->txTail; /* Characters of the oldest record that aren't transmitted yet */
+	uint32_t end = db->txRecords[db->recordTail & RECORD_MASK].end;                 /* End of the dropped records */
+	uint32_t next = db->recordTail + 1;                                             /* First record that isn't dropped */
+	uint32_t dropped = 0;                                                           /* Dropped records (not counting markers) */
+	uint32_t counted = 0;                                                           /* Records counted by the dropped markers */
+
+	/* Check which records need to be dropped */
+	while (((DBPRINT_TX_BUFFER_SIZE - (db->txHead - db->txTail) + (end - (db->txTail + keep))) < length) ||
+	       ((DBPRINT_TX_RECORDS - (db->recordHead - db->recordTail) + (next - db->recordTail - 1)) < records))
+	{
+		if (next == db->recordHead) return (false);
+
+		dbprint_txrecord_t *record = &db->txRecords[next & RECORD_MASK];
+
+		if ((int32_t)(db->txCommit - record->end) < 0) return (false);
+
+		if (record->level == LEVEL_MARKER)
+		{
+			counted += record->dropped;
+		}
+		else
+		{
+			if ((db->txOverflow == OVERFLOW_DROP_LOW_PRIORITY) && (record->level <= level)) return (false);
+			dropped++;
+		}
+
+		end = record->end;
+		next++;
+	}
+
+	/* Pause the TX handler (the characters of the oldest record get moved) */
+	db->txMoving = true;
+
+	drop->keep = keep;
+	drop->end = end;
+	drop->next = next;
+	drop->dropped = dropped;
+	drop->counted = counted;
+
+	return (true);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Drop the records selected by `tx_drop`.
+ *
+ * @details
+ *   The characters of the oldest record that still need to be transmitted
+ *   are moved up to the first character that's kept (at most
+ *   `DBPRINT_RECORD_SIZE`) with interrupts enabled: the TX handler is paused
+ *   and other print methods don't drop anything while `txMoving` is set.
+ *   Afterwards the record list and TX queue are updated in a critical section
+ *   that doesn't depend on the length of the record and the TX handler is
+ *   started again.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] drop
+ *   The records to drop (see `tx_drop`).
+ *****************************************************************************/
+static void tx_move (dbprint_t *db, const drop_t *drop)
+{
+	/* Move the rest of the oldest record up (from the back, the areas can overlap) */
+	for (uint32_t i = drop->keep; i > 0; i--)
+	{
+		db->tx_buffer[(drop->end - drop->keep + i - 1) & TX_MASK] = db->tx_buffer[(db->txTail + i - 1) & TX_MASK];
+	}
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	db->txDropped += drop->dropped + drop->counted;
+	db->stats.dropped += drop->dropped;
+
+	/* The (moved) oldest record takes the place of the last dropped record */
+	db->txRecords[(drop->next - 1) & RECORD_MASK].end = drop->end;
+	db->txRecords[(drop->next - 1) & RECORD_MASK].level = db->txRecords[db->recordTail & RECORD_MASK].level;
+	db->txRecords[(drop->next - 1) & RECORD_MASK].dropped = db->txRecords[db->recordTail & RECORD_MASK].dropped;
+	db->recordTail = drop->next - 1;
+	db->txTail = drop->end - drop->keep;
+	db->txMoving = false;
+
+	CORE_EXIT_CRITICAL();
+
+	/* Start the TX handler again if it stopped in the meantime */
+	tx_start(db);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Commit a record reserved with `tx_reserve` so it can be transmitted.
+ *
+ * @details
+ *   Records are committed in the order they are reserved: if the caller
+ *   interrupted another print method, its record only becomes available
+ *   for the TX handler when the interrupted record is committed as well.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *****************************************************************************/
+static void tx_commit (dbprint_t *db)
+{
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	/* Publish all reserved records when the last one is committed */
+	db->txPending--;
+	if (db->txPending == 0) db->txCommit = db->txHead;
+
+	CORE_EXIT_CRITICAL();
+
+	tx_start(db);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Start the TX handler if it isn't already transmitting data from the TX queue.
+ *
+ * @details
+ *   In `TX_COMPLETE` mode the TX handler is started by setting the *TX Complete
+ *   Interrupt Flag*, in `TX_BUFFER_LEVEL` mode by enabling the *TX Buffer Level
+ *   Interrupt* (the flag is already set when the TX buffer is empty). The TX
+ *   handler keeps itself running until the TX queue is empty.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *****************************************************************************/
+static void tx_start (dbprint_t *db)
+{
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	if (!db->txBusy && (db->txTail != db->txCommit))
+	{
+		db->txBusy = true;
+		db->txUsed = true;
+
+#if DBPRINT_IDLE_GATING == 1
+		/* Enable the clock of USARTx again if it was gated */
+		gate_open(db);
+#endif
+
+#if DBPRINT_DMA == 1
+		if (db->txMode == TX_DMA)
+		{
+			/* Hand the first chunk of the TX queue to the DMA controller */
+			dma_next(db);
+		}
+		else
+#endif
+		if (db->txMode == TX_BUFFER_LEVEL)
+		{
+			/* Enable TX Buffer Level Interrupt */
+			uart_intEnable(db, USART_IEN_TXBL);
+		}
+		else
+		{
+			/* Set TX Complete Interrupt Flag (transmission has completed and no more data
+			 * is available in the transmit buffer) */
+			uart_intSet(db, USART_IFS_TXC);
+		}
+	}
+
+	CORE_EXIT_CRITICAL();
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Stop the TX handler, called by the TX handler when the TX queue is empty.
+ *
+ * @details
+ *   A print method in an interrupt handler with a higher priority could have
+ *   committed data after the TX handler saw an empty queue, but before it
+ *   could stop. The check is repeated in a critical section and the TX handler
+ *   keeps going in that case (otherwise the data would never be transmitted).@n
+ *   While `tx_move` moves the oldest record (`txMoving`) the TX handler also
+ *   stops, `tx_move` starts it again afterwards.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *****************************************************************************/
+static void tx_stop (dbprint_t *db)
+{
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	if ((db->txTail == db->txCommit) || db->txMoving)
+	{
+		/* Disable TX Buffer Level Interrupt (no effect in the other modes) */
+		uart_intDisable(db, USART_IEN_TXBL);
+		db->txBusy = false;
+
+#if DBPRINT_IDLE_GATING == 1
+		/* Gate the clock of USARTx if it's idle now */
+		gate_check(db);
+#endif
+	}
+#if DBPRINT_DMA == 1
+	else if (db->txMode == TX_DMA)
+	{
+		dma_next(db);
+	}
+#endif
+	else if (db->txMode == TX_COMPLETE)
+	{
+		/* Run the TX handler again */
+		uart_intSet(db, USART_IFS_TXC);
+	}
+
+	CORE_EXIT_CRITICAL();
+}
+
+
+#if DBPRINT_LEUART == 1
+/**************************************************************************//**
+ * @brief
+ *   Initialize LEUART0 (9600 baud), used instead of USARTx.
+ *
+ * @details
+ *   The LEUART is clocked by the LFXO (32.768 kHz) which keeps running in EM2,
+ *   so the TX queue keeps draining (and characters keep getting received)
+ *   while the core is in deep sleep.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] location
+ *   Location for pin routing.
+ *****************************************************************************/
+static void leuart_init (dbprint_t *db, uint8_t location)
+{
+	/*
+	 * LEUART_INIT_DEFAULT:
+	 *   config.enable = leuartEnable      // Specifies whether TX and/or RX is enabled when initialization is completed
+	 *                                     // (Enable RX/TX when initialization is complete).
+	 *   config.refFreq = 0                // LEUART reference clock assumed when configuring baud rate setup
+	 *                                     // (0 = Use current configured reference clock for configuring baud rate).
+	 *   config.baudrate = 9600            // Desired baudrate (9600 bits/s).
+	 *   config.databits = leuartDatabits8 // Number of data bits in frame (8 data bits).
+	 *   config.parity = leuartNoParity    // Parity mode to use (no parity).
+	 *   config.stopbits = leuartStopbits1 // Number of stop bits to use (1 stop bit).
+	 */
+
+	LEUART_Init_TypeDef config = LEUART_INIT_DEFAULT;
+
+	/* Select the LFXO for the low energy peripherals (this also enables the LFXO) and enable the clocks */
+	CMU_ClockSelectSet(cmuClock_LFB, cmuSelect_LFXO);
+	CMU_ClockEnable(cmuClock_CORELE, true);
+	CMU_ClockEnable(cmuClock_LEUART0, true);
+
+	/* Set pin modes for LEUART TX and RX pins (looked up in the table, nothing is done for unknown locations) */
+	const usart_pins_t *pins = (location < LEUART_LOCATIONS) ? &leuartPins[location] : NULL;
+
+	if (pins != NULL)
+	{
+		GPIO_PinModeSet((GPIO_Port_TypeDef)pins->rxPort, pins->rxPin, gpioModeInput, 0);
+		GPIO_PinModeSet((GPIO_Port_TypeDef)pins->txPort, pins->txPin, gpioModePushPull, 1);
+	}
+
+	/* Initialize LEUART */
+	LEUART_Init(db->leuart, &config);
+
+	/* Route pins (location #0 for unknown locations) */
+	db->leuart->ROUTE = LEUART_ROUTE_TXPEN | LEUART_ROUTE_RXPEN | ((pins != NULL) ? pins->route : LEUART_ROUTE_LOCATION_LOC0);
+}
+#endif /* DBPRINT_LEUART */
+
+
+/**************************************************************************//**
+ * @brief
+ *   Write a character to USARTx or the LEUART (waits until there is room in
+ *   its TX buffer).
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] data
+ *   The character to write.
+ *****************************************************************************/
+static void uart_write (dbprint_t *db, char data)
+{
+	db->txUsed = true;
+
+#if DBPRINT_LEUART == 1
+	if (db->leuart != NULL) LEUART_Tx(db->leuart, data);
+	else
+#endif
+	USART_Tx(db->pointer, data);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Read a character from USARTx or the LEUART (waits until one is received).
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @return
+ *   The received character.
+ *****************************************************************************/
+static char uart_read (dbprint_t *db)
+{
+#if DBPRINT_LEUART == 1
+	if (db->leuart != NULL) return (LEUART_Rx(db->leuart));
+#endif
+	return (USART_Rx(db->pointer));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Enable interrupts of USARTx or the LEUART.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] flags
+ *   The interrupts to enable (`USART_IEN_XXX`, `TXC`, `TXBL` and `RXDATAV`
+ *   are at the same position in the LEUART registers).
+ *****************************************************************************/
+static void uart_intEnable (dbprint_t *db, uint32_t flags)
+{
+#if DBPRINT_LEUART == 1
+	if (db->leuart != NULL) LEUART_IntEnable(db->leuart, flags);
+	else
+#endif
+	USART_IntEnable(db->pointer, flags);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Disable interrupts of USARTx or the LEUART.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] flags
+ *   The interrupts to disable (see `uart_intEnable`).
+ *****************************************************************************/
+static void uart_intDisable (dbprint_t *db, uint32_t flags)
+{
+#if DBPRINT_LEUART == 1
+	if (db->leuart != NULL) LEUART_IntDisable(db->leuart, flags);
+	else
+#endif
+	USART_IntDisable(db->pointer, flags);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Set interrupt flags of USARTx or the LEUART.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] flags
+ *   The interrupt flags to set (see `uart_intEnable`).
+ *****************************************************************************/
+static void uart_intSet (dbprint_t *db, uint32_t flags)
+{
+#if DBPRINT_LEUART == 1
+	if (db->leuart != NULL) LEUART_IntSet(db->leuart, flags);
+	else
+#endif
+	USART_IntSet(db->pointer, flags);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Clear interrupt flags of USARTx or the LEUART.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] flags
+ *   The interrupt flags to clear.
+ *****************************************************************************/
+static void uart_intClear (dbprint_t *db, uint32_t flags)
+{
+#if DBPRINT_LEUART == 1
+	if (db->leuart != NULL) LEUART_IntClear(db->leuart, flags);
+	else
+#endif
+	USART_IntClear(db->pointer, flags);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Get the pending interrupt flags of USARTx or the LEUART.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] enabled
+ *   @li `true` - Only return the flags of enabled interrupts.
+ *   @li `false` - Return all pending flags.
+ *
+ * @return
+ *   The pending interrupt flags.
+ *****************************************************************************/
+static uint32_t uart_intGet (dbprint_t *db, bool enabled)
+{
+#if DBPRINT_LEUART == 1
+	if (db->leuart != NULL) return (enabled ? LEUART_IntGetEnabled(db->leuart) : LEUART_IntGet(db->leuart));
+#endif
+	return (enabled ? USART_IntGetEnabled(db->pointer) : USART_IntGet(db->pointer));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Check if USARTx or the LEUART has transmitted everything (TX buffer and
+ *   shift register empty).
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @return
+ *   @li `true` - The *TX Complete* status bit is set.
+ *   @li `false` - A character is still being transmitted.
+ *****************************************************************************/
+static bool uart_txIdle (dbprint_t *db)
+{
+#if DBPRINT_IDLE_GATING == 1
+	/* The clock is only gated if everything is transmitted */
+	if (db->gated) return (true);
+#endif
+
+	/* TX Complete is cleared on reset, it's only set after the first transmitted character */
+	if (!db->txUsed) return (true);
+
+#if DBPRINT_LEUART == 1
+	if (db->leuart != NULL) return (db->leuart->STATUS & LEUART_STATUS_TXC);
+#endif
+	return (db->pointer->STATUS & USART_STATUS_TXC);
+}
+
+
+#if DBPRINT_IDLE_GATING == 1
+/**************************************************************************//**
+ * @brief
+ *   Prepare the clock gating of USARTx, called on initialization if
+ *   `init.idleGating` is used.
+ *
+ * @details
+ *   A falling edge on the RX pin (the start bit of a received character)
+ *   wakes up USARTx while its clock is gated. The GPIO interrupt is
+ *   configured here but only gets enabled when the clock is gated.@n
+ *   Gating is disabled if the location has no RX pin.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] location
+ *   Location for pin routing (see `dbprint_INIT_config_ctx`).
+ *****************************************************************************/
+static void gate_init (dbprint_t *db, uint8_t location)
+{
+	/* RX pin of USARTx (see "usartPins"), gating isn't possible without one (nothing could wake up USARTx) */
+	const usart_pins_t *pins = (location < USART_LOCATIONS) ? &usartPins[(db->pointer == USART1) ? 1 : 0][location] : NULL;
+
+	if ((pins == NULL) || (pins->rxPort == PIN_NONE))
+	{
+		db->idleGating = false;
+		return;
+	}
+
+	db->rxPort = (GPIO_Port_TypeDef)pins->rxPort;
+	db->rxPin = pins->rxPin;
+
+	/* Enable the GPIO interrupts (GPIOINT dispatches them to the registered callbacks) */
+	GPIOINT_Init();
+	GPIOINT_CallbackRegister(db->rxPin, gate_rxWake);
+
+	/* Falling edge, disabled until the clock is gated */
+	GPIO_IntConfig(db->rxPort, db->rxPin, false, true, false);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Check if USARTx is idle: nothing needs to be transmitted and no line is
+ *   being received.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary. It needs to be called with
+ *   interrupts disabled.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @return
+ *   @li `true` - USARTx is idle (the last character can still be in the
+ *                shift register).
+ *   @li `false` - USARTx is (or the clock is already) in use.
+ *****************************************************************************/
+static bool gate_idle (dbprint_t *db)
+{
+	return (db->idleGating && !db->gated && !db->txBusy && (db->txTail == db->txHead) &&
+	        (db->rxIndex == 0) && !(db->pointer->STATUS & USART_STATUS_RXDATAV));
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Start the idle time of USARTx (or gate its clock right away) if the TX
+ *   queue is idle and nothing is being received.
+ *
+ * @details
+ *   Called when the TX handler stops and when a line is received. If the
+ *   last character is still in the shift register, the *TX Complete
+ *   Interrupt* is enabled so the TX handler (`tx_stop`) calls this method
+ *   again afterwards. Without threshold (`init.idleThreshold`) the clock is
+ *   gated immediately, otherwise the idle time starts (again) now and
+ *   `dbIdle_poll_ctx` gates the clock once it exceeds the threshold, so a
+ *   burst of records with short pauses in between doesn't gate and ungate
+ *   the clock for every record.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *****************************************************************************/
+static void gate_check (dbprint_t *db)
+{
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	if (gate_idle(db))
+	{
+		if (!uart_txIdle(db))
+		{
+			/* Come back when the last character is transmitted (always enabled in TX_COMPLETE mode) */
+			uart_intEnable(db, USART_IEN_TXC);
+		}
+		else if (db->idleThreshold == 0)
+		{
+			gate_close(db);
+		}
+		else
+		{
+			db->idleStart = *db->timestamp;
+			db->idleWaiting = true;
+		}
+	}
+
+	CORE_EXIT_CRITICAL();
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Gate the clock of USARTx.
+ *
+ * @details
+ *   The pins are unrouted first (TX is a GPIO again, it was set high on
+ *   initialization so the line stays idle), then a falling edge on the RX
+ *   pin is enabled to wake up USARTx again.@n
+ *   The registers of USARTx keep their contents while the clock is gated.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary. It needs to be called with
+ *   interrupts disabled, when `gate_idle` and `uart_txIdle` are `true`.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *****************************************************************************/
+static void gate_close (dbprint_t *db)
+{
+	if (db->txMode != TX_COMPLETE) uart_intDisable(db, USART_IEN_TXC);
+
+	/* Unroute the pins and gate the clock */
+	db->route = db->pointer->ROUTE;
+	db->pointer->ROUTE = 0;
+	CMU_ClockEnable((db->pointer == USART0) ? cmuClock_USART0 : cmuClock_USART1, false);
+
+	/* Wake up on the start bit of a received character */
+	GPIO_IntClear(1 << db->rxPin);
+	GPIO_IntEnable(1 << db->rxPin);
+
+	db->gated = true;
+	db->idleWaiting = false;
+	db->stats.gated++;
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Enable the clock of USARTx again (if it's gated) and route the pins.
+ *
+ * @details
+ *   Called by `tx_start` (with interrupts disabled) and by the GPIO interrupt
+ *   on the RX pin. The *TX Complete Interrupt* that `gate_check` could have
+ *   enabled is disabled again, otherwise the TX handler would also write
+ *   characters in `TX_BUFFER_LEVEL` and `TX_DMA` mode.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *****************************************************************************/
+static void gate_open (dbprint_t *db)
+{
+	if (!db->idleGating) return;
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+
+	/* USARTx is in use again, the idle time starts over afterwards */
+	db->idleWaiting = false;
+
+	if (db->gated)
+	{
+		GPIO_IntDisable(1 << db->rxPin);
+
+		CMU_ClockEnable((db->pointer == USART0) ? cmuClock_USART0 : cmuClock_USART1, true);
+		db->pointer->ROUTE = db->route;
+
+		db->gated = false;
+		db->stats.ungated++;
+	}
+
+	if (db->txMode != TX_COMPLETE) uart_intDisable(db, USART_IEN_TXC);
+
+	CORE_EXIT_CRITICAL();
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   GPIO callback, called (by GPIOINT) on a falling edge of the RX pin while
+ *   the clock of USARTx is gated.
+ *
+ * @details
+ *   The character of which the start bit woke up USARTx is lost (or
+ *   received incorrectly), the next ones are received normally. The clock
+ *   gets gated again when a complete line is received (or the TX queue is
+ *   idle again).
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] pin
+ *   The pin (interrupt number) of the edge.
+ *****************************************************************************/
+static void gate_rxWake (uint8_t pin)
+{
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		dbprint_t *db = dbcontext[i];
+
+		if ((db != NULL) && db->idleGating && db->gated && (db->rxPin == pin))
+		{
+			gate_open(db);
+			db->stats.rxWakeups++;
+		}
+	}
+}
+#endif /* DBPRINT_IDLE_GATING */
+
+
+#if DBPRINT_COMPRESS == 1
+/**************************************************************************//**
+ * @brief
+ *   Compress the next block of the TX queue into a frame.
+ *
+ * @details
+ *   A small LZ77 variant (in the style of *heatshrink*, but byte oriented so
+ *   no bit shifting is necessary), the frame starts with `DBPRINT_PACK_START`
+ *   and the length of the data:
+ *     - `0x00 - 0x7F`: Literal character.
+ *     - `0x80 - 0xFD`, offset: Copy `byte - 0x80 + 3` characters (3 - 128)
+ *       starting `offset + 1` characters back (`offset` is `0x00 - 0xFC`).
+ *     - `0xFE`, character: Literal character `0x80 - 0xFF` (minus `0x80`).
+ *
+ *   `DBPRINT_PACK_START` never occurs inside a frame, so the host can
+ *   resynchronize on it. Matches are only searched in the same block (and
+ *   only at the last position with the same three characters, using the
+ *   match table) so every frame can be decoded on its own and the time
+ *   spent per character is small and bounded (at most 128 compares per match).@n
+ *   The block is removed from the TX queue once it's compressed.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *****************************************************************************/
+static void pack_block (dbprint_t *db)
+{
+	uint32_t start = db->txTail;
+	uint32_t available = db->txCommit - start;
+	if (available > DBPRINT_PACK_BLOCK) available = DBPRINT_PACK_BLOCK;
+
+	/* Empty the match table (positions are stored + 1, 0 = empty) */
+	for (uint32_t i = 0; i < DBPRINT_PACK_HASH_SIZE; i++) db->packHash[i] = 0;
+
+	uint8_t *frame = db->packFrame;
+	uint32_t length = 2; /* Start character and length */
+	uint32_t i = 0;
+
+	/* Every step puts at most two bytes in the frame */
+	while ((i < available) && ((length + 2) <= DBPRINT_PACK_FRAME_SIZE))
+	{
+		uint8_t c = db->tx_buffer[(start + i) & TX_MASK];
+
+		if ((i + 3) <= available)
+		{
+			uint8_t c1 = db->tx_buffer[(start + i + 1) & TX_MASK];
+			uint8_t c2 = db->tx_buffer[(start + i + 2) & TX_MASK];
+			uint32_t hash = ((c << 4) ^ (c1 << 2) ^ c2) & (DBPRINT_PACK_HASH_SIZE - 1);
+			uint32_t candidate = db->packHash[hash];
+
+			db->packHash[hash] = i + 1;
+
+			if (candidate > 0)
+			{
+				/* Check how many characters match (at least three are necessary) */
+				uint32_t from = candidate - 1;
+				uint32_t match = 0;
+
+				while (((i + match) < available) && (match < 128) &&
+				       (db->tx_buffer[(start + from + match) & TX_MASK] == db->tx_buffer[(start + i + match) & TX_MASK]))
+				{
+					match++;
+				}
+
+				if (match >= 3)
+				{
+					frame[length++] = 0x80 + (match - 3);
+					frame[length++] = i - from - 1;
+					i += match;
+					continue;
+				}
+			}
+		}
+
+		/* Literal character */
+		if (c < 0x80)
+		{
+			frame[length++] = c;
+		}
+		else
+		{
+			frame[length++] = 0xFE;
+			frame[length++] = c - 0x80;
+		}
+
+		i++;
+	}
+
+	frame[0] = DBPRINT_PACK_START;
+	frame[1] = length - 2;
+
+	db->packIndex = 0;
+	db->packLength = length;
+
+	/* Free up the compressed block */
+	db->txTail += i;
+	db->stats.packed += i;
+	db->stats.frames++;
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   TX handler in compression mode, transmits the frames made by `pack_block`.
+ *
+ * @details
+ *   Works like the TX handler (`TX_COMPLETE` and `TX_BUFFER_LEVEL` mode,
+ *   including the double write) but takes the characters from the frame
+ *   instead of the TX queue. A new block is compressed when the frame is
+ *   completely transmitted.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] flags
+ *   The pending and enabled interrupt flags.
+ *****************************************************************************/
+static void pack_handler (dbprint_t *db, uint32_t flags)
+{
+	if (!(flags & (USART_IF_TXBL | USART_IF_TXC))) return;
+
+	/* The TX buffer is empty: room for two characters (USARTx only), otherwise one */
+	uint8_t room = ((flags & USART_IF_TXBL) && !USES_LEUART(db)) ? 2 : 1;
+	uint8_t data[2];
+	uint8_t count = 0;
+
+	while (count < room)
+	{
+		if (db->packIndex == db->packLength)
+		{
+			if ((db->txTail == db->txCommit) || db->txMoving) break;
+			pack_block(db);
+		}
+
+		data[count++] = db->packFrame[db->packIndex++];
+	}
+
+	if (count == 2)
+	{
+		USART_TxDouble(db->pointer, data[0] | ((uint16_t)data[1] << 8));
+	}
+	else if (count == 1)
+	{
+		uart_write(db, data[0]);
+	}
+	else
+	{
+		tx_stop(db); /* No more data to send */
+	}
+
+	db->stats.sent += count;
+}
+#endif /* DBPRINT_COMPRESS */
+
+
+#if DBPRINT_DMA == 1
+/**************************************************************************//**
+ * @brief
+ *   Initialize the DMA channel used in `TX_DMA` mode.
+ *
+ * @details
+ *   The channel gets triggered by the *TX Buffer Level* DMA request of USARTx,
+ *   every request moves one byte from the TX queue to `TXDATA`. The DMA
+ *   controller itself is only initialized if it isn't enabled yet.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *****************************************************************************/
+static void dma_init (dbprint_t *db)
+{
+	DMA_CfgChannel_TypeDef channelConfig;
+	DMA_CfgDescr_TypeDef descriptorConfig;
+
+	/* Initialize the DMA controller if necessary (this also resets all of the channels) */
+	if (!(DMA->STATUS & DMA_STATUS_EN))
+	{
+		DMA_Init_TypeDef dmaInit;
+
+		CMU_ClockEnable(cmuClock_DMA, true);
+
+		dmaInit.hprot = 0;
+		dmaInit.controlBlock = dmaControlBlock;
+		DMA_Init(&dmaInit);
+	}
+
+	/* Callback called by the DMA handler when a chunk is transmitted */
+	db->dmaCallback.cbFunc = dma_done;
+	db->dmaCallback.userPtr = db;
+
+	/* USART1 uses DBPRINT_DMA_CHANNEL, USART0 the next one and LEUART0 the one after that
+	 * (they can all use the DMA TX mode at the same time) */
+	if (USES_LEUART(db)) db->dmaChannel = DBPRINT_DMA_CHANNEL + 2;
+	else if (db->pointer == USART0) db->dmaChannel = DBPRINT_DMA_CHANNEL + 1;
+	else db->dmaChannel = DBPRINT_DMA_CHANNEL;
+
+	/* Channel triggered by "TX Buffer Level" of USARTx, interrupt when a chunk is done */
+	channelConfig.highPri = false;
+	channelConfig.enableInt = true;
+#if DBPRINT_LEUART == 1
+	if (db->leuart != NULL) channelConfig.select = DMAREQ_LEUART0_TXBL;
+	else
+#endif
+	channelConfig.select = (db->pointer == USART0) ? DMAREQ_USART0_TXBL : DMAREQ_USART1_TXBL;
+	channelConfig.cb = &db->dmaCallback;
+	DMA_CfgChannel(db->dmaChannel, &channelConfig);
+
+	/* Primary descriptor: increment the source (TX queue), fixed destination (TXDATA), bytes */
+	descriptorConfig.dstInc = dmaDataIncNone;
+	descriptorConfig.srcInc = dmaDataInc1;
+	descriptorConfig.size = dmaDataSize1;
+	descriptorConfig.arbRate = dmaArbitrate1;
+	descriptorConfig.hprot = 0;
+	DMA_CfgDescr(db->dmaChannel, true, &descriptorConfig);
+
+#if DBPRINT_LEUART == 1
+	/* Let the LEUART wake up the DMA controller in EM2 (the core can keep sleeping while the TX queue drains) */
+	if (db->leuart != NULL) LEUART_TxDmaInEM2Enable(db->leuart, true);
+#endif
+
+	db->dmaChunk = 0;
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Hand the next contiguous chunk of the TX queue to the DMA controller.
+ *
+ * @details
+ *   A chunk ends at the end of the ring buffer, the data that wrapped around
+ *   to the start of the ring is transmitted as the next chunk. Only committed
+ *   data is transmitted. If the TX queue is empty the DMA TX mode stops.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *****************************************************************************/
+static void dma_next (dbprint_t *db)
+{
+	uint32_t index = db->txTail & TX_MASK;
+	uint32_t length = db->txCommit - db->txTail;
+
+	/* Don't go past the end of the ring buffer or the maximum DMA cycle length */
+	if (length > (DBPRINT_TX_BUFFER_SIZE - index)) length = DBPRINT_TX_BUFFER_SIZE - index;
+	if (length > DMA_MAX_CHUNK) length = DMA_MAX_CHUNK;
+
+	db->dmaChunk = length;
+
+	if (length == 0)
+	{
+		tx_stop(db); /* No more data to send */
+	}
+	else
+	{
+		/* Destination: TXDATA of USARTx or the LEUART */
+#if DBPRINT_LEUART == 1
+		volatile uint32_t *txdata = (db->leuart != NULL) ? &(db->leuart->TXDATA) : &(db->pointer->TXDATA);
+#else
+		volatile uint32_t *txdata = &(db->pointer->TXDATA);
+#endif
+
+		DMA_ActivateBasic(db->dmaChannel, true, false,
+		                  (void *)txdata, (void *)&db->tx_buffer[index], length - 1);
+	}
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   DMA callback, called (by `DMA_IRQHandler` in `em_dma.c`) when a chunk
+ *   of the TX queue is transmitted.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] channel
+ *   The DMA channel that completed.
+ *
+ * @param[in] primary
+ *   `true` if the primary descriptor completed.
+ *
+ * @param[in] user
+ *   User pointer (the instance, see `dma_init`).
+ *****************************************************************************/
+static void dma_done (unsigned int channel, bool primary, void *user)
+{
+	(void) channel;
+	(void) primary;
+
+	dbprint_t *db = (dbprint_t *)user;
+
+	db->stats.txInterrupts++;
+	db->stats.sent += db->dmaChunk;
+
+	/* Free up the transmitted chunk and start the next one */
+	db->txTail += db->dmaChunk;
+	dma_next(db);
+}
+#endif /* DBPRINT_DMA */
+
+
+/**************************************************************************//**
+ * @brief
+ *   Convert a `uint32_t` value to a varint (LEB128).
+ *
+ * @details
+ *   Seven bits are stored per byte (least significant group first), the
+ *   most significant bit of a byte is set if more bytes follow.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[out] buf
+ *   The buffer to put the resulting bytes in.@n
+ *   **This needs to have room for 5 bytes!**
+ *
+ * @param[in] value
+ *   The `uint32_t` value to convert.
+ *
+ * @return
+ *   The amount of bytes written in the buffer (1 - 5).
+ *****************************************************************************/
+static uint8_t uint32_to_varint (uint8_t *buf, uint32_t value)
+{
+	uint8_t length = 0;
+
+	/* Write seven bits at a time, set the MSB if more bytes follow */
+	while (value > 0x7F)
+	{
+		buf[length++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+
+	buf[length++] = (uint8_t)value;
+
+	return (length);
+}
+
+/**************************************************************************//**
+ * @brief
+ *   Get the length of a string (like `strlen`).
+ *
+ * @details
+ *   Once the pointer is word-aligned four characters are checked at a time:
+ *   `(word - 0x01010101) & ~word & 0x80808080` is only non-zero if one of the
+ *   bytes of the word is zero. The words are read through `word_t` (which
+ *   may alias characters). The last word is read completely: this over-read
+ *   of up to three characters is intentional and never crosses the end of a
+ *   memory region because it's aligned (it's excluded from AddressSanitizer).
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] string
+ *   The string (ending with NULL).
+ *
+ * @return
+ *   The amount of characters before NULL.
+ *****************************************************************************/
+NO_SANITIZE_ADDRESS static uint32_t string_length (const char *string)
+{
+	const char *end = string;
+
+	/* One character at a time until the pointer is aligned */
+	while (((uintptr_t)end & 0x3) != 0)
+	{
+		if (*end == '\0') return (end - string);
+		end++;
+	}
+
+	/* One word at a time until a word contains a zero byte */
+	const word_t *word = (const word_t *)end;
+	while (((*word - 0x01010101) & ~*word & 0x80808080) == 0) word++;
+
+	/* Find the zero byte in the word */
+	end = (const char *)word;
+	while (*end != '\0') end++;
+
+	return (end - string);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Check if two strings are equal (like `strcmp(string1, string2) == 0`).
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] string1
+ *   The first string (ending with NULL).
+ *
+ * @param[in] string2
+ *   The second string (ending with NULL).
+ *
+ * @return
+ *   @li `true` - The strings are equal.
+ *   @li `false` - The strings are different.
+ *****************************************************************************/
+static bool string_equal (const char *string1, const char *string2)
+{
+	while ((*string1 != '\0') && (*string1 == *string2))
+	{
+		string1++;
+		string2++;
+	}
+
+	return (*string1 == *string2);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Calculate the hash of a command (FNV-1a).
+ *
+ * @details
+ *   The Cortex-M0+ multiplies in one cycle, so this is one XOR and one
+ *   multiplication per character.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @attention
+ *   This **has to match** `shellHash` in `tools/dbshellgen.cpp`.
+ *
+ * @param[in] name
+ *   The command (ending with NULL).
+ *
+ * @param[in] seed
+ *   The start value of the hash (see `dbprint_shell_t`).
+ *
+ * @return
+ *   The hash (the slot is the hash masked with the size of the table).
+ *****************************************************************************/
+static uint32_t shell_hash (const char *name, uint32_t seed)
+{
+	uint32_t hash = seed;
+
+	while (*name != '\0')
+	{
+		hash ^= (uint8_t)*name++;
+		hash *= DBPRINT_SHELL_PRIME;
+	}
+
+	return (hash);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Print the commands of a command table with their description.
  *
  * @note
- *   The index of the RX buffer gets reset in the RX handler when a CR character
- *   is received or the buffer is filled.
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
  *
- * @attention
- *   Interrupt functionality has to be enabled on initialization for this
- *   function to work correctly.
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
  *
- * @param[in] buf
- *   The buffer to put the resulting string in.@n
- *   **This needs to have a length of `DBPRINT_BUFFER_SIZE` for the function
- *   to work properly: `char buf[DBPRINT_BUFFER_SIZE];`!**
+ * @param[in] shell
+ *   The command table.
  *****************************************************************************/
-void dbGet_RXbuffer (char *buf)
+static void shell_help (dbprint_t *db, const dbprint_shell_t *shell)
 {
-	if (dataReceived)
+	for (uint32_t i = 0; i < shell->size; i++)
 	{
-		uint32_t i;
+		if (shell->slots[i].name == NULL) continue;
 
-		/* Copy data from the RX buffer to the given buffer */
-		for (i = 0; rx_buffer[i] != 0 && i < DBPRINT_BUFFER_SIZE-1; i++)
-		{
-			buf[i] = rx_buffer[i];
-		}
+		dbprint_ctx(db, (char *)shell->slots[i].name);
+		dbprint_ctx(db, " - ");
+		dbprintln_ctx(db, (char *)shell->slots[i].help);
+	}
+}
 
-		/* Add NULL termination character */
-		buf[i++] = '\0';
 
-		/* Reset "notification" variable */
-		dataReceived = false;
-	}
-	else
+/**************************************************************************//**
+ * @brief
+ *   Update a CRC-16 (CCITT, polynomial `0x1021`) with one byte.
+ *
+ * @details
+ *   Calculated without a lookup table (a few shifts and XORs per byte
+ *   instead of one iteration per bit).
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] crc
+ *   The CRC so far (`0xFFFF` to start).
+ *
+ * @param[in] data
+ *   The byte to add.
+ *
+ * @return
+ *   The updated CRC.
+ *****************************************************************************/
+static uint16_t crc16_update (uint16_t crc, uint8_t data)
+{
+	uint8_t x = (crc >> 8) ^ data;
+	x ^= x >> 4;
+
+	return ((crc << 8) ^ ((uint16_t)x << 12) ^ ((uint16_t)x << 5) ^ x);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Encode data using COBS (*Consistent Overhead Byte Stuffing*).
+ *
+ * @details
+ *   Every zero byte is replaced by the distance to the next zero byte, the
+ *   first byte is the distance to the first zero byte. A distance of `0xFF`
+ *   means 254 non-zero bytes follow without a zero byte after them. The
+ *   encoded data doesn't contain any zero bytes.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[out] buf
+ *   The buffer to put the encoded data in.@n
+ *   **This needs to have room for `length + length / 254 + 1` bytes!**
+ *
+ * @param[in] data
+ *   The data to encode.
+ *
+ * @param[in] length
+ *   The amount of bytes to encode.
+ *
+ * @return
+ *   The amount of encoded bytes.
+ *****************************************************************************/
+static uint32_t cobs_encode (uint8_t *buf, const uint8_t *data, uint32_t length)
+{
+	uint32_t code = 0;  /* Position of the current distance byte */
+	uint32_t size = 1;  /* Room for the first distance byte */
+
+	for (uint32_t i = 0; i < length; i++)
 	{
-		dbcrit("No received data available!");
+		if (data[i] != 0x00) buf[size++] = data[i];
+
+		/* Close the block at a zero byte or after 254 non-zero bytes */
+		if ((data[i] == 0x00) || ((size - code) == 0xFF))
+		{
+			buf[code] = size - code;
+			code = size++;
+		}
 	}
+
+	buf[code] = size - code;
+
+	return (size);
 }
 
 
@@ -1111,57 +5331,70 @@ static void uint32_to_charHex (char *buf, uint32_t value, bool spacing)
  * @brief
  *   Convert a `uint32_t` value to a decimal char array (string).
  *
+ * @details
+ *   The Cortex-M0+ has no hardware divider, so instead of calculating `% 10`
+ *   and `/ 10` for every digit (two library calls) the length is determined
+ *   first by comparing with powers of ten. The digits are then written
+ *   directly in place, from the back, two at a time: `value / 100` is
+ *   calculated with a multiplication by the reciprocal and the remainder
+ *   is used as index in a lookup table with all two-digit pairs.
+ *
  * @note
  *   This is a static method because it's only internally used in this file
  *   and called by other methods if necessary.
  *
  * @param[out] buf
  *   The buffer to put the resulting string in.@n
- *   **This needs to have a length of 10: `char buf[10];`!**
+ *   **This needs to have a length of 11: `char buf[11];`!**
  *
  * @param[in] value
  *   The `uint32_t` value to convert to a string.
  *****************************************************************************/
 static void uint32_to_charDec (char *buf, uint32_t value)
 {
-	if (value == 0)
+	/* MAX uint32_t value = FFFFFFFFh = 4294967295d (10 decimal chars) */
+	static const uint32_t powersOfTen[10] =
 	{
-		buf[0] = '0';
-		buf[1] = '\0'; /* NULL termination character */
-	}
-	else
+		1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+	};
+
+	/* All two-digit pairs, "00" - "99" */
+	static const char digitPairs[200] =
+		"00010203040506070809" "10111213141516171819"
+		"20212223242526272829" "30313233343536373839"
+		"40414243444546474849" "50515253545556575859"
+		"60616263646566676869" "70717273747576777879"
+		"80818283848586878889" "90919293949596979899";
+
+	/* Calculate the length (at least one character for "0") */
+	uint8_t length = 1;
+	while ((length < 10) && (value >= powersOfTen[length])) length++;
+
+	/* Add NULL termination character and fill the buffer from the back */
+	buf[length] = '\0';
+	char *position = &buf[length];
+
+	while (value >= 100)
 	{
-		/* MAX uint32_t value = FFFFFFFFh = 4294967295d (10 decimal chars) */
-		char backwardsBuf[10];
+		/* value / 100 = (value * (2^37 / 100)) / 2^37, exact for every uint32_t value */
+		uint32_t quotient = (uint32_t)(((uint64_t)value * 0x51EB851F) >> 37);
+		uint32_t pair = (value - (quotient * 100)) * 2;
 
-		uint32_t calcval = value;
-		uint8_t length = 0;
-		uint8_t lengthCounter = 0;
+		*--position = digitPairs[pair + 1];
+		*--position = digitPairs[pair];
 
+		value = quotient;
+	}
 
-		/* Loop until the value is zero (separate characters 0-9) and calculate length */
-		while (calcval)
-		{
-			uint32_t rem = calcval % 10;
-			backwardsBuf[length] = TO_DEC(rem); /* Convert to ASCII character */
-			length++;
-
-			calcval = calcval - rem;
-			calcval = calcval / 10;
-		}
-
-		/* Backwards counter */
-		lengthCounter = length;
-
-		/* Reverse the characters in the buffer for the final string */
-		for (uint8_t i = 0; i < length; i++)
-		{
-			buf[i] = backwardsBuf[lengthCounter-1];
-			lengthCounter--;
-		}
-
-		/* Add NULL termination character */
-		buf[length] = '\0';
+	/* One or two digits left */
+	if (value >= 10)
+	{
+		*--position = digitPairs[(value * 2) + 1];
+		*--position = digitPairs[value * 2];
+	}
+	else
+	{
+		*--position = '0' + value;
 	}
 }
 
@@ -1270,82 +5503,440 @@ static uint32_t charDec_to_uint32 (char *buf)
 
 /**************************************************************************//**
  * @brief
- *   USART0 RX interrupt service routine.
+ *   RX handler, called by the RX interrupt service routine of USARTx.
  *
  * @details
  *   The index gets reset to zero when a special character (CR) is received or
- *   the buffer is filled.
+ *   the buffer is filled (or the amount of bytes of an asynchronous read is
+ *   received). If the callback of `dbReadAsync_ctx` isn't deferred it's
+ *   called for the completed lines.
  *
  * @note
- *   The *weak* definition for this method is located in `system_efm32hg.h`.
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
  *****************************************************************************/
-void USART0_RX_IRQHandler(void)
+static void rx_handler (dbprint_t *db)
 {
-	/* "static" so it keeps its value between invocations */
-	static uint32_t i = 0;
+	/* Get and clear the pending USART interrupt flags
+	 *   -> Don't clear the TX flags, they are handled by the TX handler */
+	uint32_t flags = uart_intGet(db, false) & ~(USART_IF_TXC | USART_IF_TXBL);
+	uart_intClear(db, flags);
+
+	db->stats.rxInterrupts++;
+
+	/* Received characters were lost because the RX buffer of the USART (or LEUART) was full */
+#if DBPRINT_LEUART == 1
+	if (flags & ((db->leuart != NULL) ? LEUART_IF_RXOF : USART_IF_RXOF)) db->stats.rxOverruns++;
+#else
+	if (flags & USART_IF_RXOF) db->stats.rxOverruns++;
+#endif
+
+	char received = uart_read(db);
+	bool end = (db->rxCount == 0) && ((received == '\r') || (received == '\f'));
+
+#if DBPRINT_RX_PARSE == 1
+	/* Parse numbers instead of queueing lines */
+	if (db->rxParse)
+	{
+		rx_parse(db, received);
+
+#if DBPRINT_IDLE_GATING == 1
+		/* Gate the clock of USARTx again if the TX queue is also idle */
+		if (end) gate_check(db);
+#endif
+
+		return;
+	}
+#endif
+
+	/* Restart the timeout of the asynchronous read */
+	if (db->rxTimeout != 0)
+	{
+		db->rxLast = *db->timestamp;
+		db->rxWaiting = true;
+	}
+
+	/* Drop the characters of a new line if the RX queue is full (until the end of that line) */
+	if ((db->rxIndex == 0) && ((db->rxHead - db->rxTail) >= DBPRINT_RX_LINES))
+	{
+		if (!db->rxDropping) db->stats.rxOverruns++;
+		db->rxDropping = true;
+	}
 
-	/* Get and clear the pending USART interrupt flags */
-	uint32_t flags = USART_IntGet(dbpointer);
-	USART_IntClear(dbpointer, flags);
+	if (db->rxDropping)
+	{
+		/* Reads of a byte count have no end character, only this one is dropped */
+		if (end || (db->rxCount != 0)) db->rxDropping = false;
+		return;
+	}
 
-	/* Store incoming data into dbprint_rx_buffer */
-	rx_buffer[i++] = USART_Rx(dbpointer);
+	/* Store incoming data into the line that is being filled in */
+	volatile char *line = db->rx_buffer[db->rxHead & RX_MASK];
+	line[db->rxIndex++] = received;
 
-	/* Set dbprint_rxdata when a special character is received (~ full line received) */
-	if ( (rx_buffer[i - 1] == '\r') || (rx_buffer[i - 1] == '\f') )
+	/* Queue the line when a special character is received (~ full line received) */
+	if (end)
 	{
-		dataReceived = true;
-		rx_buffer[i - 1] = '\0'; /* Overwrite CR or LF character */
-		i = 0;
+		rx_queue(db, db->rxIndex - 1, RX_LINE); /* Overwrite CR or LF character */
+
+#if DBPRINT_IDLE_GATING == 1
+		/* Gate the clock of USARTx again if the TX queue is also idle */
+		gate_check(db);
+#endif
 	}
 
-	/* Set dbprint_rxdata when the buffer is full */
-	if (i >= (DBPRINT_BUFFER_SIZE - 2))
+	/* Queue the line when the buffer is full (or the bytes of an asynchronous read are received) */
+	if (db->rxIndex >= ((db->rxCount != 0) ? db->rxCount : (DBPRINT_BUFFER_SIZE - 2)))
 	{
-		dataReceived = true;
-		rx_buffer[i] = '\0'; /* Do not overwrite last character */
-		i = 0;
+		rx_queue(db, db->rxIndex, (db->rxCount != 0) ? RX_COUNT : RX_LINE); /* Do not overwrite last character */
 	}
+
+	if ((db->rxCallback != NULL) && !db->rxDeferred && !db->rxDelivering) rx_deliver(db);
 }
 
 
 /**************************************************************************//**
  * @brief
- *   USART0 TX interrupt service routine.
+ *   Queue the line that is being filled in.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] length
+ *   The amount of characters in the line (the NULL termination character
+ *   is put after them).
+ *
+ * @param[in] event
+ *   The event that completed the line.
+ *****************************************************************************/
+static void rx_queue (dbprint_t *db, uint32_t length, dbprint_rxevent_t event)
+{
+	uint32_t index = db->rxHead & RX_MASK;
+
+	db->rx_buffer[index][length] = '\0';
+	db->rx_length[index] = length;
+	db->rx_event[index] = event;
+	db->rxHead++;
+	db->rxIndex = 0;
+
+	/* The timeout of the next read starts with its first character */
+	db->rxWaiting = false;
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Call the callback of the asynchronous read for the received lines (and
+ *   a timeout without data).
  *
  * @details
- *   The index gets reset to zero when all the characters in the buffer are send.
+ *   Every line is removed from the RX queue after the callback returns.
  *
  * @note
- *   The *weak* definition for this method is located in `system_efm32hg.h`.
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
  *****************************************************************************/
-void USART0_TX_IRQHandler(void)
+static void rx_deliver (dbprint_t *db)
+{
+	/* The callback can remove itself (the remaining lines are polled then) */
+	while ((db->rxHead != db->rxTail) && (db->rxCallback != NULL))
+	{
+		uint32_t index = db->rxTail & RX_MASK;
+
+		/* Not volatile: the RX handler doesn't write to a complete line */
+		db->rxCallback(db, (dbprint_rxevent_t)db->rx_event[index], (char *)db->rx_buffer[index], db->rx_length[index]);
+		db->rxTail++;
+	}
+
+	if (db->rxTimedOut && (db->rxCallback != NULL))
+	{
+		char empty = '\0';
+
+		db->rxTimedOut = false;
+		db->rxCallback(db, RX_TIMEOUT, &empty, 0);
+	}
+}
+
+
+#if DBPRINT_RX_PARSE == 1
+/**************************************************************************//**
+ * @brief
+ *   Parse a received character, called by the RX handler if `init.rxParse`
+ *   is used.
+ *
+ * @details
+ *   State machine that builds the number one character at a time (a few
+ *   instructions per character, no division, the Cortex-M0+ has no hardware
+ *   divider). A separator ends the number and puts it in the value queue
+ *   (see `dbGet_RXvalue_ctx` for the format).
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *
+ * @param[in] received
+ *   The received character.
+ *****************************************************************************/
+static void rx_parse (dbprint_t *db, char received)
+{
+	bool separator = (received == ' ') || (received == '\t') || (received == ',') || (received == ';') ||
+	                 (received == '\r') || (received == '\n') || (received == '\f');
+
+	/* Value of the character as (hexadecimal) digit, 0xFF if it isn't one */
+	uint8_t digit = 0xFF;
+	if ((received >= '0') && (received <= '9')) digit = received - '0';
+	else if ((received >= 'a') && (received <= 'f')) digit = received - 'a' + 10;
+	else if ((received >= 'A') && (received <= 'F')) digit = received - 'A' + 10;
+
+	if (separator)
+	{
+		/* End of a number (a sign or "0x" without digits is malformed) */
+		if ((db->parseState == PARSE_ZERO) || (db->parseState == PARSE_DECIMAL) || (db->parseState == PARSE_HEX))
+		{
+			if ((db->valueHead - db->valueTail) >= DBPRINT_RX_VALUES)
+			{
+				db->stats.rxOverruns++;
+			}
+			else
+			{
+				/* Negative of the magnitude (on the unsigned value so INT32_MIN doesn't overflow) */
+				uint32_t value = db->parseNegative ? (~db->parseValue) + 1 : db->parseValue;
+
+				db->valueQueue[db->valueHead & VALUE_MASK] = (int32_t)value;
+				db->valueHead++;
+				db->stats.rxValues++;
+			}
+		}
+		else if ((db->parseState == PARSE_SIGN) || (db->parseState == PARSE_HEX_PREFIX))
+		{
+			db->stats.rxInvalid++;
+		}
+
+		db->parseState = PARSE_IDLE;
+		return;
+	}
+
+	uint8_t state = db->parseState;
+
+	switch (state)
+	{
+		case PARSE_IDLE:
+			db->parseNegative = (received == '-');
+			db->parseValue = 0;
+
+			if ((received == '-') || (received == '+')) state = PARSE_SIGN;
+			else if (received == '0') state = PARSE_ZERO;
+			else if (digit <= 9)
+			{
+				db->parseValue = digit;
+				state = PARSE_DECIMAL;
+			}
+			else state = PARSE_INVALID;
+			break;
+
+		case PARSE_SIGN:
+			if (received == '0') state = PARSE_ZERO;
+			else if (digit <= 9)
+			{
+				db->parseValue = digit;
+				state = PARSE_DECIMAL;
+			}
+			else state = PARSE_INVALID;
+			break;
+
+		case PARSE_ZERO:
+			if ((received == 'x') || (received == 'X'))
+			{
+				state = PARSE_HEX_PREFIX;
+				break;
+			}
+			state = PARSE_DECIMAL;
+			/* Falls through - leading zero of a decimal number */
+
+		case PARSE_DECIMAL:
+			/* 2147483647 (or 2147483648 if negative) is the largest magnitude */
+			if ((digit > 9) || (db->parseValue > 214748364) ||
+			    ((db->parseValue == 214748364) && (digit > (7 + db->parseNegative))))
+			{
+				state = PARSE_INVALID;
+			}
+			else
+			{
+				/* "value * 10" as shifts and an addition */
+				db->parseValue = (db->parseValue << 3) + (db->parseValue << 1) + digit;
+			}
+			break;
+
+		case PARSE_HEX_PREFIX:
+		case PARSE_HEX:
+			if ((digit > 0xF) || (db->parseValue > 0x0FFFFFFF))
+			{
+				state = PARSE_INVALID;
+			}
+			else
+			{
+				db->parseValue = (db->parseValue << 4) | digit;
+				state = PARSE_HEX;
+			}
+			break;
+
+		default:
+			/* PARSE_INVALID: skip the rest of the number */
+			break;
+	}
+
+	/* Count a malformed number once (when the parser starts skipping it) */
+	if ((state == PARSE_INVALID) && (db->parseState != PARSE_INVALID)) db->stats.rxInvalid++;
+
+	db->parseState = state;
+}
+#endif
+
+
+/**************************************************************************//**
+ * @brief
+ *   TX handler, called by the TX interrupt service routine of USARTx or LEUART0.
+ *
+ * @details
+ *   @li `TX_COMPLETE` mode: every time a character is transmitted the next one
+ *   from the TX queue gets written to the USART.
+ *   @li `TX_BUFFER_LEVEL` mode: every time the TX buffer of the USART is empty
+ *   it gets filled again, using a double write if two or more characters are
+ *   queued (USARTx only, the LEUART has no double write register). The shift
+ *   register never runs empty so there is no idle time between characters.
+ *
+ *   Only committed data is transmitted. The handler stops (`tx_stop`) when
+ *   the queue is empty and gets started again by the print methods.
+ *
+ * @note
+ *   This is a static method because it's only internally used in this file
+ *   and called by other methods if necessary.
+ *
+ * @param[in] db
+ *   The instance (see `dbprint_t`).
+ *****************************************************************************/
+static void tx_handler (dbprint_t *db)
 {
-	/* "static" so it keeps its value between invocations */
-	static uint32_t i = 0;
+	/* Get the pending and enabled interrupt flags and clear "TX Complete Interrupt Flag"
+	 *   -> "TX Buffer Level Interrupt Flag" can't be cleared, it's set as long as the TX buffer is empty */
+	uint32_t flags = uart_intGet(db, true);
+	uart_intClear(db, USART_IF_TXC);
+
+	db->stats.txInterrupts++;
+
+#if DBPRINT_COMPRESS == 1
+	/* Transmit compressed frames instead of the TX queue itself */
+	if (db->compress)
+	{
+		pack_handler(db, flags);
+		return;
+	}
+#endif
+
+	/* Mask flags AND "TX Buffer Level Interrupt Flag" */
+	if (flags & USART_IF_TXBL)
+	{
+		/* Nothing is transmitted while "tx_move" moves the oldest record */
+		uint32_t queued = db->txMoving ? 0 : (db->txCommit - db->txTail);
 
-	/* Get and clear the pending USART interrupt flags */
-	uint32_t flags = USART_IntGet(dbpointer);
-	USART_IntClear(dbpointer, flags);
+		/* The LEUART doesn't have a double TX buffer */
+		if ((queued >= 2) && !USES_LEUART(db))
+		{
+			/* The TX buffer is empty (TXBIL = 0) so there is room for two characters,
+			 * the first one is put in the lower byte of TXDOUBLE (TXDATA0) */
+			uint16_t data = (uint8_t)db->tx_buffer[db->txTail & TX_MASK];
+			data |= (uint16_t)((uint8_t)db->tx_buffer[(db->txTail + 1) & TX_MASK]) << 8;
+
+			USART_TxDouble(db->pointer, data);
+			db->txTail += 2;
+			db->stats.sent += 2;
+		}
+		else if (queued >= 1)
+		{
+			uart_write(db, db->tx_buffer[db->txTail & TX_MASK]);
+			db->txTail++;
+			db->stats.sent++;
+		}
+		else
+		{
+			/* No more data to send, disable TX Buffer Level Interrupt */
+			tx_stop(db);
+		}
+	}
 
 	/* Mask flags AND "TX Complete Interrupt Flag" */
 	if (flags & USART_IF_TXC)
 	{
-		/* Index is smaller than the maximum buffer size and
-		 * the current item to print is not "NULL" (\0) */
-		if ( (i < DBPRINT_BUFFER_SIZE) && (tx_buffer[i] != '\0') )
+		/* Transmit the next character if the TX queue isn't empty (and not paused by "tx_move") */
+		if ((db->txTail != db->txCommit) && !db->txMoving)
 		{
-			/* Transmit byte at current index and increment index */
-			USART_Tx(dbpointer, tx_buffer[i++]);
+			uart_write(db, db->tx_buffer[db->txTail & TX_MASK]);
+			db->txTail++;
+			db->stats.sent++;
 		}
 		else
 		{
-			i = 0; /* No more data to send */
+			tx_stop(db); /* No more data to send */
 		}
 	}
 }
 
 
+/**************************************************************************//**
+ * @brief
+ *   USART0 RX interrupt service routine.
+ *
+ * @note
+ *   The *weak* definition for this method is located in `system_efm32hg.h`.
+ *****************************************************************************/
+void USART0_RX_IRQHandler(void)
+{
+	/* Ignore (and disable) the interrupt if no instance uses USART0 */
+	if (dbcontext[0] == NULL)
+	{
+		NVIC_DisableIRQ(USART0_RX_IRQn);
+		return;
+	}
+
+	/* Call the handler with the instance using USART0 */
+	rx_handler(dbcontext[0]);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   USART0 TX interrupt service routine.
+ *
+ * @note
+ *   The *weak* definition for this method is located in `system_efm32hg.h`.
+ *****************************************************************************/
+void USART0_TX_IRQHandler(void)
+{
+	/* Ignore (and disable) the interrupt if no instance uses USART0 */
+	if (dbcontext[0] == NULL)
+	{
+		NVIC_DisableIRQ(USART0_TX_IRQn);
+		return;
+	}
+
+	/* Call the handler with the instance using USART0 */
+	tx_handler(dbcontext[0]);
+}
+
+
 /**************************************************************************//**
  * @brief
  *   USART1 RX interrupt service routine.
@@ -1355,8 +5946,15 @@ void USART0_TX_IRQHandler(void)
  *****************************************************************************/
 void USART1_RX_IRQHandler(void)
 {
-	/* Call other handler */
-	USART0_RX_IRQHandler();
+	/* Ignore (and disable) the interrupt if no instance uses USART1 */
+	if (dbcontext[1] == NULL)
+	{
+		NVIC_DisableIRQ(USART1_RX_IRQn);
+		return;
+	}
+
+	/* Call the handler with the instance using USART1 */
+	rx_handler(dbcontext[1]);
 }
 
 
@@ -1369,8 +5967,45 @@ void USART1_RX_IRQHandler(void)
  *****************************************************************************/
 void USART1_TX_IRQHandler(void)
 {
-	/* Call other handler */
-	USART0_TX_IRQHandler();
+	/* Ignore (and disable) the interrupt if no instance uses USART1 */
+	if (dbcontext[1] == NULL)
+	{
+		NVIC_DisableIRQ(USART1_TX_IRQn);
+		return;
+	}
+
+	/* Call the handler with the instance using USART1 */
+	tx_handler(dbcontext[1]);
+}
+
+
+#if DBPRINT_LEUART == 1
+/**************************************************************************//**
+ * @brief
+ *   LEUART0 interrupt service routine.
+ *
+ * @details
+ *   The LEUART only has one interrupt for RX and TX, the RX handler is called
+ *   if a character is received and the TX handler if a TX interrupt is pending.
+ *
+ * @note
+ *   The *weak* definition for this method is located in `system_efm32hg.h`.
+ *****************************************************************************/
+void LEUART0_IRQHandler(void)
+{
+	/* Ignore (and disable) the interrupt if no instance uses LEUART0 */
+	if (dbcontext[2] == NULL)
+	{
+		NVIC_DisableIRQ(LEUART0_IRQn);
+		return;
+	}
+
+	uint32_t flags = LEUART_IntGetEnabled(LEUART0);
+
+	/* Call the handlers with the instance using LEUART0 */
+	if (flags & LEUART_IF_RXDATAV) rx_handler(dbcontext[2]);
+	if (flags & (LEUART_IF_TXC | LEUART_IF_TXBL)) tx_handler(dbcontext[2]);
 }
+#endif /* DBPRINT_LEUART */
 
 #endif /* DEBUG_DBPRINT */
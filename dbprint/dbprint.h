@@ -1,7 +1,7 @@
 /***************************************************************************//**
  * @file dbprint.h
  * @brief Homebrew println/printf replacement "DeBugPrint".
- * @version 7.0
+ * @version 7.25
  * @author Brecht Van Eeckhoudt
  *
  * ******************************************************************************
@@ -42,11 +42,154 @@
 #include <stdint.h>   /* (u)intXX_t */
 #include <stdbool.h>  /* "bool", "true", "false" */
 #include "em_usart.h" /* Universal synchr./asynchr. receiver/transmitter (USART/UART) Peripheral API */
+#include "debug_dbprint.h" /* DEBUG_DBPRINT and DBPRINT_LEVEL (if this header is included directly) */
 
 
-/** Public definition to configure the buffer size. */
+/** Public definition to configure the buffer size (also the size of one line in the RX queue). */
 #define DBPRINT_BUFFER_SIZE 80
 
+/** Public definition to configure the amount of received lines the RX queue can hold (interrupt mode).
+ *    @li This **needs to be a power of two** so the indices can be wrapped using a mask. */
+#define DBPRINT_RX_LINES 4
+
+#if (DBPRINT_RX_LINES & (DBPRINT_RX_LINES - 1)) != 0
+#error "DBPRINT_RX_LINES needs to be a power of two!"
+#endif
+
+/** Public definition to configure the size of the TX queue (ring buffer) used in interrupt mode.
+ *    @li This **needs to be a power of two** so the indices can be wrapped using a mask.
+ *    @li Print methods can also be called in interrupt handlers, their output doesn't get mixed up
+ *        with the output of the interrupted print method. If the queue is full and the TX handler
+ *        can't run (interrupts disabled or a handler with the same or a higher priority) the data is dropped. */
+#define DBPRINT_TX_BUFFER_SIZE 256
+
+#if (DBPRINT_TX_BUFFER_SIZE & (DBPRINT_TX_BUFFER_SIZE - 1)) != 0
+#error "DBPRINT_TX_BUFFER_SIZE needs to be a power of two!"
+#endif
+
+/** Public definition to configure the maximum length of a record (`dbinfo`, `dbprint`, `dbprint_frame`, ...) in interrupt mode.
+ *    @li A record is reserved in the TX queue as one unit and never split up, longer records are
+ *        truncated to this length and end with `[truncated]`.
+ *    @li Longer unleveled data (`dbprint`, `dbprintn`, `dbprintln`, `dbprint(ln)_color`) is written
+ *        as several records instead.
+ *    @li At most `DBPRINT_TX_BUFFER_SIZE - 32` so a `[N records dropped]` marker fits in front of it. */
+#define DBPRINT_RECORD_SIZE 224
+
+#if DBPRINT_RECORD_SIZE > (DBPRINT_TX_BUFFER_SIZE - 32)
+#error "DBPRINT_RECORD_SIZE can be at most DBPRINT_TX_BUFFER_SIZE - 32!"
+#endif
+
+/** Public definition to configure the amount of records the TX queue keeps track of (used to drop whole records).
+ *    @li This **needs to be a power of two**, the TX queue is also full if this amount of records is queued. */
+#define DBPRINT_TX_RECORDS 32
+
+#if (DBPRINT_TX_RECORDS & (DBPRINT_TX_RECORDS - 1)) != 0
+#error "DBPRINT_TX_RECORDS needs to be a power of two!"
+#endif
+
+/** Public definition to enable/disable the LEUART backend (`init.leuart`)
+ *    @li `1` - LEUART0 can be used instead of USARTx, `em_leuart.c` needs to be added to the project
+ *              and `LEUART0_IRQHandler` is defined by dbprint.
+ *    @li `0` - No LEUART functionality is compiled in (the application can use LEUART0 itself). */
+#define DBPRINT_LEUART 0
+
+#if DBPRINT_LEUART == 1
+#include "em_leuart.h" /* Low Energy Universal Asynchronous Receiver/Transmitter (LEUART) Peripheral API */
+#endif
+
+/** Public definition to enable/disable the DMA TX mode (`TX_DMA`)
+ *    @li `1` - `TX_DMA` can be selected, `em_dma.c` and `dmactrl.c` need to be added to the project.
+ *    @li `0` - No DMA functionality is compiled in. */
+#define DBPRINT_DMA 0
+
+/** Public definition to select the DMA channel used in `TX_DMA` mode.
+ *    @li USART1 uses this channel, USART0 the next one (`DBPRINT_DMA_CHANNEL + 1`)
+ *        and LEUART0 the one after that (`DBPRINT_DMA_CHANNEL + 2`). */
+#define DBPRINT_DMA_CHANNEL 0
+
+#if DBPRINT_DMA == 1
+#include "em_dma.h"   /* Direct Memory Access (DMA) API (callback in dbprint_t) */
+#endif
+
+/** Public definition to enable/disable gating the clock of USARTx while the TX queue is idle (`init.idleGating`)
+ *    @li `1` - `init.idleGating` can be used, `gpiointerrupt.c` (emdrv) needs to be added to the project
+ *              (received data wakes up USARTx using a GPIO interrupt on the RX pin).
+ *    @li `0` - No clock gating functionality is compiled in. */
+#define DBPRINT_IDLE_GATING 0
+
+#if DBPRINT_IDLE_GATING == 1
+#include "em_gpio.h"  /* General Purpose IO (GPIO) peripheral API (RX pin in dbprint_t) */
+#endif
+
+/** Public definition to enable/disable the compression stage between the TX queue and USARTx (`init.compress`)
+ *    @li `1` - `init.compress` can be used, every instance gets a frame buffer (`DBPRINT_PACK_FRAME_SIZE` bytes)
+ *              and a match table (`DBPRINT_PACK_HASH_SIZE` bytes). Use `tools/dbunpack.cpp` to read the output.
+ *    @li `0` - No compression functionality is compiled in. */
+#define DBPRINT_COMPRESS 0
+
+/** Public definition to configure the (maximum) amount of characters of the TX queue compressed into one frame.
+ *    @li Matches are only searched in the same frame (frames are independent so the host can
+ *        resynchronize), larger blocks compress better. This **can't be larger than 254**. */
+#define DBPRINT_PACK_BLOCK 248
+
+/** Public definition to configure the amount of entries in the match table (**needs to be a power of two**). */
+#define DBPRINT_PACK_HASH_SIZE 64
+
+/** Public definition of the size of a compressed frame (start character, length and at most 254 bytes). */
+#define DBPRINT_PACK_FRAME_SIZE 256
+
+/** Public definition of the character that starts a compressed frame (it never occurs inside a frame). */
+#define DBPRINT_PACK_START 0xFF
+
+#if (DBPRINT_PACK_BLOCK > 254) || ((DBPRINT_PACK_HASH_SIZE & (DBPRINT_PACK_HASH_SIZE - 1)) != 0)
+#error "DBPRINT_PACK_BLOCK can't be larger than 254 and DBPRINT_PACK_HASH_SIZE needs to be a power of two!"
+#endif
+
+/** Public definition to enable/disable the parser for received numbers (`init.rxParse`)
+ *    @li `1` - `init.rxParse` can be used, every instance gets a value queue (`DBPRINT_RX_VALUES` values).
+ *    @li `0` - No parser functionality is compiled in. */
+#define DBPRINT_RX_PARSE 0
+
+/** Public definition to configure the amount of parsed values the value queue can hold (`init.rxParse`).
+ *    @li This **needs to be a power of two** so the indices can be wrapped using a mask. */
+#define DBPRINT_RX_VALUES 16
+
+#if (DBPRINT_RX_VALUES & (DBPRINT_RX_VALUES - 1)) != 0
+#error "DBPRINT_RX_VALUES needs to be a power of two!"
+#endif
+
+/** Public definition to configure the maximum amount of arguments (including the command) of a shell command (`dbShell`). */
+#define DBPRINT_SHELL_ARGS 8
+
+/** Public definition of the hash used by `dbShell` (FNV-1a, the seed is the start value).
+ *    @li This **has to match** the hash in `tools/dbshellgen.cpp` which generates the command table. */
+#define DBPRINT_SHELL_PRIME 16777619
+
+/** Public definition to enable/disable tokenized logging
+ *    @li `1` - `dbinfo`, `dbwarn`, `dbcrit` and their `Int(_hex)` variants only transmit a token
+ *              and the value, the strings are put in the `dbprint_tokens` section (see `tools/dbdecode.cpp`).
+ *              **The messages of these calls need to be string literals.**
+ *    @li `0` - These methods transmit plain text. */
+#define DBPRINT_TOKENIZED 0
+
+/** Public definition of the character that starts a tokenized record. */
+#define DBPRINT_TOKEN_START 0x01
+
+/** Public definition of the character that starts a tokenized record with a timestamp (delta as varint before the token). */
+#define DBPRINT_TOKEN_START_TIME 0x02
+
+/** Public definition of the character that starts a binary frame (see `dbprint_frame`). */
+#define DBPRINT_FRAME_START 0x03
+
+/** Public definition to configure the maximum amount of bytes in a binary frame (`dbprint_frame`).
+ *    @li The frame is built on the stack (about twice this size) and put in the TX queue as one
+ *        record, so this **can't be larger than `DBPRINT_RECORD_SIZE - 8`**. */
+#define DBPRINT_FRAME_SIZE 128
+
+#if DBPRINT_FRAME_SIZE > (DBPRINT_RECORD_SIZE - 8)
+#error "DBPRINT_FRAME_SIZE can't be larger than DBPRINT_RECORD_SIZE - 8!"
+#endif
+
 
 /** Enum type for the color selection. */
 typedef enum dbprint_colors
@@ -61,14 +204,256 @@ typedef enum dbprint_colors
 } dbprint_color_t;
 
 
+/** Enum type for the TX mode selection (only used in interrupt mode). */
+typedef enum dbprint_txmodes
+{
+	TX_COMPLETE,     /**< The TX handler writes one character every time the shift register is empty (`TXC`). */
+	TX_BUFFER_LEVEL, /**< The TX handler keeps the TX buffer of the USART filled (`TXBL`), no idle time between characters. */
+#if DBPRINT_DMA == 1
+	TX_DMA           /**< The DMA controller transmits the TX queue in contiguous chunks, one interrupt per chunk. */
+#endif
+} dbprint_txmode_t;
+
+
+/** Enum type for the overflow policy, what happens if the TX queue is full (only used in interrupt mode). */
+typedef enum dbprint_overflows
+{
+	OVERFLOW_BLOCK,            /**< Wait until the TX handler made room (the record is dropped if waiting isn't possible). */
+	OVERFLOW_DROP_NEWEST,      /**< Drop the new record. */
+	OVERFLOW_DROP_OLDEST,      /**< Drop the oldest queued records that aren't being transmitted yet. */
+	OVERFLOW_DROP_LOW_PRIORITY /**< Drop the oldest queued records with a lower priority than the new one (trace < info < warn < crit). */
+} dbprint_overflow_t;
+
+
+/** Enum type for the event that completes an asynchronous read (see `dbReadAsync`). */
+typedef enum dbprint_rxevents
+{
+	RX_LINE,   /**< A line is received (CR or form feed, or the line buffer is full). */
+	RX_COUNT,  /**< The requested amount of bytes is received. */
+	RX_TIMEOUT /**< Nothing was received during the timeout, the data is what was received so far (can be empty). */
+} dbprint_rxevent_t;
+
+
+/** Struct type for the initialization settings. */
+typedef struct
+{
+	USART_TypeDef* pointer;   /**< Pointer to USARTx. */
+	uint8_t location;         /**< Location for pin routing. */
+	bool vcom;                /**< `true` - Enable the isolation switch so the **Virtual COM port (CDC)** can be used. */
+	bool interrupts;          /**< `true` - Enable interrupt functionality (TX queue and RX buffer). */
+	dbprint_txmode_t txMode;  /**< The interrupt used to transmit the data in the TX queue. */
+	dbprint_overflow_t overflow; /**< What happens if the TX queue is full. */
+#if DBPRINT_LEUART == 1
+	LEUART_TypeDef* leuart;   /**< `LEUART0` - Use the LEUART (9600 baud, keeps working in EM2) instead of USARTx, `NULL` - Use USARTx (see `DBPRINT_LEUART`). */
+#endif
+	bool idleGating;          /**< `true` - Gate the clock of USARTx while the TX queue is idle (interrupt mode, see `DBPRINT_IDLE_GATING`). */
+	uint32_t idleThreshold;   /**< Counter ticks (`init.timestamp`) the TX queue has to be idle before the clock gets gated (see `dbIdle_poll`), `0` - Immediately. */
+	volatile uint32_t* timestamp; /**< Free-running counter (for example `&RTC->CNT` or `&TIMER0->CNT`) to timestamp records and measure the timeouts of `dbFlush_timeout` and `dbReadAsync`, `NULL` - No timestamps. */
+	uint32_t timestampMask;   /**< Valid bits of the counter (for example `_RTC_CNT_MASK` or `_TIMER_CNT_MASK`), `0` - All 32 bits. */
+	bool compress;            /**< `true` - Compress the output in frames (interrupt mode except `TX_DMA`, see `DBPRINT_COMPRESS`). */
+	bool banner;              /**< `true` - Print the welcome banner (queued in interrupt mode), `false` - Fast start (no banner). */
+	bool rxParse;             /**< `true` - Parse received numbers into a value queue instead of queueing lines (interrupt mode, see `DBPRINT_RX_PARSE`). */
+} dbprint_init_t;
+
+
+/** Struct type for the statistics of the logging path (see `dbprint_stats`). */
+typedef struct
+{
+	uint32_t queued;       /**< Characters written to the TX path (queued in interrupt mode). */
+	uint32_t sent;         /**< Characters written to the USART. */
+	uint32_t records[4];   /**< `dbcrit`, `dbwarn`, `dbinfo` and `dbtrace` records (index: `DBPRINT_LEVEL_XXX - 1`). */
+	uint32_t highWater;    /**< Highest amount of characters in the TX queue. */
+	uint32_t blocked;      /**< Amount of times a print method had to wait for room in the TX queue. */
+	uint32_t blockedChars; /**< Characters transmitted while print methods waited (one character ~ 87 us at 115200 baud). */
+	uint32_t txInterrupts; /**< TX (or DMA) handler invocations. */
+	uint32_t rxInterrupts; /**< RX handler invocations. */
+	uint32_t rxOverruns;   /**< Lost received data (RX buffer of the USART full or lines dropped because the RX queue was full). */
+	uint32_t dropped;      /**< Records dropped because the TX queue was full. */
+	uint32_t truncated;    /**< Records truncated to `DBPRINT_RECORD_SIZE` characters (longer unleveled data is split up instead). */
+	uint32_t gated;        /**< Times the clock of USARTx was gated because the TX queue was idle (`init.idleGating`). */
+	uint32_t ungated;      /**< Times the clock of USARTx was enabled again (by a print method or received data). */
+	uint32_t rxWakeups;    /**< Times received data (an edge on the RX pin) enabled the clock again. */
+	uint32_t packed;       /**< Characters of the TX queue compressed into frames (`init.compress`, `sent` are the bytes of the frames). */
+	uint32_t frames;       /**< Compressed frames. */
+	uint32_t txFrames;     /**< Binary frames sent with `dbprint_frame` (also the dropped ones). */
+	uint32_t rxValues;     /**< Received numbers parsed into the value queue (`init.rxParse`, dropped ones are counted in `rxOverruns`). */
+	uint32_t rxInvalid;    /**< Received numbers that were malformed or out of range. */
+} dbprint_stats_t;
+
+
+/** Struct type to keep track of a record in the TX queue (used in `dbprint_t`). */
+typedef struct
+{
+	uint32_t end;  /**< (Free-running) index after the last character of the record. */
+	uint8_t level; /**< `DBPRINT_LEVEL_XXX`, lower is more important (`0` - `[N records dropped]` marker). */
+	uint16_t dropped; /**< Records counted by the marker (`0` for other records). */
+} dbprint_txrecord_t;
+
+
+/* Forward declaration of the instance (used by the callback of an asynchronous read) */
+struct dbprint_instance;
+
+/** Function type of the callback of an asynchronous read (`data` ends with NULL, see `dbReadAsync`). */
+typedef void (*dbprint_callback_t) (struct dbprint_instance *db, dbprint_rxevent_t event, char *data, uint32_t length);
+
+
+/** Struct type for an instance (USARTx or LEUART0 with its own TX and RX queue and statistics).
+ *    @li The fields are only used internally, the `_ctx` methods take a pointer to an instance.
+ *    @li The methods without `_ctx` use a default instance.
+ *    @li TX queue: the indices are free-running, [txTail, txCommit[ can be transmitted and
+ *        [txCommit, txHead[ is reserved by print methods (possibly interrupted by others)
+ *        which are still filling it in. "txHead", "txCommit" and "txPending" are only
+ *        changed in critical sections, "txTail" only by the TX handler (and while it's paused to
+ *        drop records, "txMoving").
+ *    @li RX queue: "rxHead" is the line the RX handler is filling in (only written by the
+ *        RX handler), "rxTail" the oldest received line (only written by "dbRelease_RXline_ctx"). */
+typedef struct dbprint_instance
+{
+	USART_TypeDef* pointer;           /**< Pointer to USARTx (`NULL` if the LEUART is used). */
+#if DBPRINT_LEUART == 1
+	LEUART_TypeDef* leuart;           /**< Pointer to LEUART0 (`NULL` if USARTx is used). */
+#endif
+	bool txQueued;                    /**< `true` if the print methods use the TX queue (interrupt mode). */
+	dbprint_txmode_t txMode;          /**< Interrupt used by the TX handler. */
+	dbprint_overflow_t txOverflow;    /**< What to do if the TX queue is full. */
+	volatile uint32_t* timestamp;     /**< Counter used to timestamp records (`NULL` - No timestamps). */
+	uint32_t timestampMask;           /**< Valid bits of the counter. */
+	uint32_t timestampLast;           /**< Counter value of the previous timestamped record. */
+	IRQn_Type txIRQn;                 /**< Interrupt that drains the TX queue (USARTx TX or DMA). */
+	uint8_t frameSeq;                 /**< Sequence number of the next binary frame. */
+
+	volatile char tx_buffer[DBPRINT_TX_BUFFER_SIZE]; /**< TX queue (ring buffer). */
+	volatile uint32_t txHead;         /**< End of the reserved data. */
+	volatile uint32_t txCommit;       /**< End of the committed data. */
+	volatile uint32_t txTail;         /**< Next character to transmit. */
+	volatile uint32_t txPending;      /**< Amount of reserved records that aren't committed yet. */
+	volatile bool txBusy;             /**< `true` if the TX handler is transmitting data from the queue. */
+	volatile bool txUsed;             /**< `true` once a character is handed to USARTx or the LEUART (*TX Complete* is only set afterwards). */
+
+	dbprint_txrecord_t txRecords[DBPRINT_TX_RECORDS]; /**< Records in the TX queue (so whole records can be dropped). */
+	volatile uint32_t recordHead;     /**< Next free entry in the record list. */
+	volatile uint32_t recordTail;     /**< Oldest entry in the record list. */
+	volatile uint32_t txDropped;      /**< Records dropped since the last `[N records dropped]` marker. */
+	volatile bool txMoving;           /**< `true` while the oldest record is moved to drop the ones after it (TX handler paused). */
+
+	volatile char rx_buffer[DBPRINT_RX_LINES][DBPRINT_BUFFER_SIZE]; /**< RX queue (ring of lines). */
+	volatile uint8_t rx_length[DBPRINT_RX_LINES]; /**< Length of the received lines. */
+	volatile uint32_t rxHead;         /**< Line the RX handler is filling in. */
+	volatile uint32_t rxTail;         /**< Oldest received line. */
+	uint32_t rxIndex;                 /**< Index in the line that is being filled in. */
+	bool rxDropping;                  /**< `true` if the characters of the current line are dropped. */
+	volatile uint8_t rx_event[DBPRINT_RX_LINES]; /**< Event that completed the received lines (`dbprint_rxevent_t`). */
+
+	dbprint_callback_t rxCallback;    /**< Callback of the asynchronous read (`NULL` - Received lines are polled). */
+	bool rxDeferred;                  /**< `true` if the callback is called by `dbReadAsync_poll_ctx` instead of the RX handler. */
+	uint32_t rxCount;                 /**< Amount of bytes that completes a read (`0` - Lines). */
+	uint32_t rxTimeout;               /**< Counter ticks without received data that complete a read (`0` - No timeout). */
+	volatile uint32_t rxLast;         /**< Counter value of the last received character (or the start of the read). */
+	volatile bool rxWaiting;          /**< `true` if the timeout is running. */
+	bool rxTimedOut;                  /**< `true` if a timeout without data still has to be delivered. */
+	volatile bool rxDelivering;       /**< `true` while `dbReadAsync_poll_ctx` calls the callback (the RX handler doesn't call it then). */
+
+#if DBPRINT_DMA == 1
+	DMA_CB_TypeDef dmaCallback;       /**< Callback called by the DMA handler when a chunk is transmitted. */
+	volatile uint32_t dmaChunk;       /**< Length of the chunk the DMA controller is transmitting. */
+	uint8_t dmaChannel;               /**< DMA channel used in `TX_DMA` mode. */
+#endif
+
+#if DBPRINT_IDLE_GATING == 1
+	bool idleGating;                  /**< `true` if the clock of USARTx is gated while the TX queue is idle. */
+	volatile bool gated;              /**< `true` if the clock of USARTx is gated (and the pins aren't routed). */
+	uint32_t idleThreshold;           /**< Counter ticks the TX queue has to be idle before the clock gets gated (`0` - Immediately). */
+	uint32_t idleStart;               /**< Counter value when USARTx became idle. */
+	volatile bool idleWaiting;        /**< `true` if USARTx is idle and `dbIdle_poll_ctx` gates the clock after `idleThreshold`. */
+	uint32_t route;                   /**< ROUTE register of USARTx, restored when the clock is enabled again. */
+	GPIO_Port_TypeDef rxPort;         /**< Port of the RX pin (a falling edge wakes up USARTx). */
+	uint8_t rxPin;                    /**< RX pin (also the GPIO interrupt number). */
+#endif
+
+#if DBPRINT_RX_PARSE == 1
+	bool rxParse;                     /**< `true` if the RX handler parses numbers instead of queueing lines. */
+	uint8_t parseState;               /**< State of the parser (part of the number that is being received). */
+	bool parseNegative;               /**< `true` if the number that is being received starts with `-`. */
+	uint32_t parseValue;              /**< Magnitude of the number received so far. */
+	volatile int32_t valueQueue[DBPRINT_RX_VALUES]; /**< Value queue (ring buffer). */
+	volatile uint32_t valueHead;      /**< Next free entry in the value queue (only written by the RX handler). */
+	volatile uint32_t valueTail;      /**< Oldest value (only written by "dbGet_RXvalue_ctx"). */
+#endif
+
+#if DBPRINT_COMPRESS == 1
+	bool compress;                    /**< `true` if the TX handler transmits compressed frames. */
+	uint8_t packFrame[DBPRINT_PACK_FRAME_SIZE]; /**< Frame that is being transmitted. */
+	volatile uint16_t packIndex;      /**< Next byte of the frame to transmit. */
+	volatile uint16_t packLength;     /**< Length of the frame. */
+	uint8_t packHash[DBPRINT_PACK_HASH_SIZE]; /**< Last position (+ 1) of three characters in the block (match table). */
+#endif
+
+	dbprint_stats_t stats;            /**< Statistics (plain increments, see `dbprint_stats_ctx`). */
+} dbprint_t;
+
+
+/** Function type of a shell command (`argv[0]` is the command itself, see `dbShell`). */
+typedef void (*dbprint_handler_t) (dbprint_t *db, uint32_t argc, char *argv[]);
+
+/** Struct type for a shell command (one slot of the command table, `name` is `NULL` for an empty slot). */
+typedef struct
+{
+	const char *name;          /**< Name of the command. */
+	dbprint_handler_t handler; /**< Method that executes the command. */
+	const char *help;          /**< Description printed by `help`. */
+} dbprint_command_t;
+
+/** Struct type for a command table, generated by `tools/dbshellgen.cpp` (perfect hash: every command has its own slot). */
+typedef struct
+{
+	const dbprint_command_t *slots; /**< The slots (commands) of the table. */
+	uint32_t size;                  /**< Amount of slots (**needs to be a power of two**). */
+	uint32_t seed;                  /**< Start value of the hash, chosen so no two commands share a slot. */
+} dbprint_shell_t;
+
+
+/* Setting of the LEUART in the default initialization settings (only if the field exists) */
+#if DBPRINT_LEUART == 1
+#define DBPRINT_INIT_LEUART NULL, /* USARTx instead of the LEUART */
+#else
+#define DBPRINT_INIT_LEUART
+#endif
+
+/** Default initialization settings (VCOM, interrupt mode, TX buffer level interrupt, wait if the TX queue is full, welcome banner). */
+#define DBPRINT_INIT_DEFAULT                                   \
+{                                                              \
+	USART1,          /* USART1 (VCOM) */                       \
+	4,               /* Location #4 (VCOM) */                  \
+	true,            /* Enable the isolation switch */         \
+	true,            /* Interrupt mode */                      \
+	TX_BUFFER_LEVEL, /* Gapless transmission using TXBL */     \
+	OVERFLOW_BLOCK,  /* Wait if the TX queue is full */        \
+	DBPRINT_INIT_LEUART                                        \
+	false,           /* Keep the clock of USARTx enabled */    \
+	0,               /* (Gate the clock immediately) */        \
+	NULL,            /* No timestamps */                       \
+	0,               /* (All bits of the counter) */           \
+	false,           /* No compression */                      \
+	true,            /* Print the welcome banner */            \
+	false            /* Queue received lines (no parser) */    \
+}
+
+
+/* The methods are only declared if dbprint is enabled, otherwise debug_dbprint.h
+ * replaces them by empty macros (the definitions and types above stay available) */
+#if DEBUG_DBPRINT == 1 /* DEBUG_DBPRINT */
+
+
 /* Public prototypes */
 void dbprint_INIT (USART_TypeDef* pointer, uint8_t location, bool vcom, bool interrupts);
+void dbprint_INIT_config (const dbprint_init_t *init);
 
 void dbAlert (void);
 void dbClear (void);
 
 void dbprint (char *message);
 void dbprintln (char *message);
+void dbprintn (const char *message, uint32_t length);
 
 void dbprintInt (int32_t value);
 void dbprintlnInt (int32_t value);
@@ -76,17 +461,23 @@ void dbprintlnInt (int32_t value);
 void dbprintInt_hex (int32_t value);
 void dbprintlnInt_hex (int32_t value);
 
+bool dbprint_frame (const uint8_t *data, uint32_t length);
+void dbHexdump (const void *data, uint32_t length);
+
 void dbprint_color (char *message, dbprint_color_t color);
 void dbprintln_color (char *message, dbprint_color_t color);
 
+void dbtrace (char *message);
 void dbinfo (char *message);
 void dbwarn (char *message);
 void dbcrit (char *message);
 
+void dbtraceInt (char *message1, int32_t value, char *message2);
 void dbinfoInt (char *message1, int32_t value, char *message2);
 void dbwarnInt (char *message1, int32_t value, char *message2);
 void dbcritInt (char *message1, int32_t value, char *message2);
 
+void dbtraceInt_hex (char *message1, int32_t value, char *message2);
 void dbinfoInt_hex (char *message1, int32_t value, char *message2);
 void dbwarnInt_hex (char *message1, int32_t value, char *message2);
 void dbcritInt_hex (char *message1, int32_t value, char *message2);
@@ -96,8 +487,215 @@ uint8_t dbReadInt (void);
 void dbReadLine (char *buf);
 
 bool dbGet_RXstatus (void);
+uint32_t dbGet_TXdropped (void);
+
+void dbFlush (void);
+bool dbFlush_timeout (uint32_t timeout);
+void dbIdle_poll (void);
+
+void dbprint_stats (dbprint_stats_t *stats);
+void dbprintStats (void);
+void dbprintStats_reset (void);
 // void dbSet_TXbuffer (char *message); // TODO: Needs fixing (but probably won't ever be used)
 void dbGet_RXbuffer (char *buf);
+char *dbGet_RXline (uint32_t *length);
+void dbRelease_RXline (void);
+bool dbGet_RXvalue (int32_t *value);
+bool dbShell (const dbprint_shell_t *shell);
+bool dbReadAsync (uint32_t count, uint32_t timeout, dbprint_callback_t callback, bool deferred);
+void dbReadAsync_poll (void);
+
+void dbprint_token (uint32_t token);
+void dbprint_tokenInt (uint32_t token, int32_t value);
+void dbprint_tokenInt_hex (uint32_t token, int32_t value);
+
+
+/* Public prototypes of the methods using a given instance (the ones above use the default instance) */
+void dbprint_INIT_ctx (dbprint_t *db, USART_TypeDef* pointer, uint8_t location, bool vcom, bool interrupts);
+void dbprint_INIT_config_ctx (dbprint_t *db, const dbprint_init_t *init);
+
+void dbAlert_ctx (dbprint_t *db);
+void dbClear_ctx (dbprint_t *db);
+
+void dbprint_ctx (dbprint_t *db, char *message);
+void dbprintln_ctx (dbprint_t *db, char *message);
+void dbprintn_ctx (dbprint_t *db, const char *message, uint32_t length);
+
+void dbprintInt_ctx (dbprint_t *db, int32_t value);
+void dbprintlnInt_ctx (dbprint_t *db, int32_t value);
+
+void dbprintInt_hex_ctx (dbprint_t *db, int32_t value);
+void dbprintlnInt_hex_ctx (dbprint_t *db, int32_t value);
+
+bool dbprint_frame_ctx (dbprint_t *db, const uint8_t *data, uint32_t length);
+void dbHexdump_ctx (dbprint_t *db, const void *data, uint32_t length);
+
+void dbprint_color_ctx (dbprint_t *db, char *message, dbprint_color_t color);
+void dbprintln_color_ctx (dbprint_t *db, char *message, dbprint_color_t color);
+
+void dbtrace_ctx (dbprint_t *db, char *message);
+void dbinfo_ctx (dbprint_t *db, char *message);
+void dbwarn_ctx (dbprint_t *db, char *message);
+void dbcrit_ctx (dbprint_t *db, char *message);
+
+void dbtraceInt_ctx (dbprint_t *db, char *message1, int32_t value, char *message2);
+void dbinfoInt_ctx (dbprint_t *db, char *message1, int32_t value, char *message2);
+void dbwarnInt_ctx (dbprint_t *db, char *message1, int32_t value, char *message2);
+void dbcritInt_ctx (dbprint_t *db, char *message1, int32_t value, char *message2);
+
+void dbtraceInt_hex_ctx (dbprint_t *db, char *message1, int32_t value, char *message2);
+void dbinfoInt_hex_ctx (dbprint_t *db, char *message1, int32_t value, char *message2);
+void dbwarnInt_hex_ctx (dbprint_t *db, char *message1, int32_t value, char *message2);
+void dbcritInt_hex_ctx (dbprint_t *db, char *message1, int32_t value, char *message2);
+
+char dbReadChar_ctx (dbprint_t *db);
+uint8_t dbReadInt_ctx (dbprint_t *db);
+void dbReadLine_ctx (dbprint_t *db, char *buf);
+
+bool dbGet_RXstatus_ctx (dbprint_t *db);
+uint32_t dbGet_TXdropped_ctx (dbprint_t *db);
+
+void dbFlush_ctx (dbprint_t *db);
+bool dbFlush_timeout_ctx (dbprint_t *db, uint32_t timeout);
+void dbIdle_poll_ctx (dbprint_t *db);
+
+void dbprint_stats_ctx (dbprint_t *db, dbprint_stats_t *stats);
+void dbprintStats_ctx (dbprint_t *db);
+void dbprintStats_reset_ctx (dbprint_t *db);
+
+void dbGet_RXbuffer_ctx (dbprint_t *db, char *buf);
+char *dbGet_RXline_ctx (dbprint_t *db, uint32_t *length);
+void dbRelease_RXline_ctx (dbprint_t *db);
+bool dbGet_RXvalue_ctx (dbprint_t *db, int32_t *value);
+bool dbShell_ctx (dbprint_t *db, const dbprint_shell_t *shell);
+bool dbReadAsync_ctx (dbprint_t *db, uint32_t count, uint32_t timeout, dbprint_callback_t callback, bool deferred);
+void dbReadAsync_poll_ctx (dbprint_t *db);
+
+void dbprint_token_ctx (dbprint_t *db, uint32_t token);
+void dbprint_tokenInt_ctx (dbprint_t *db, uint32_t token, int32_t value);
+void dbprint_tokenInt_hex_ctx (dbprint_t *db, uint32_t token, int32_t value);
+
+
+/* Tokenized logging: replace the info, warning and critical error methods by macros
+ * which put their strings in the "dbprint_tokens" section and only transmit the token
+ *   -> Not done in dbprint.c itself (DBPRINT_SOURCE), the methods are defined there
+ *   -> These macros are replaced by empty ones below if their level is disabled */
+#if (DBPRINT_TOKENIZED == 1) && !defined(DBPRINT_SOURCE)
+
+/** Start of the `dbprint_tokens` section (defined by the linker). */
+extern const char __start_dbprint_tokens[];
+
+/** Put a string table entry in the `dbprint_tokens` section and return its token (offset in the section).
+ *    @li `type` - Level (`"T"`, `"I"`, `"W"` or `"C"`) followed by the notation of the value (`"-"` none, `"d"` decimal, `"x"` hexadecimal).
+ *    @li Entry: `type` `message1` `\0` `message2` `\0` */
+#define DBPRINT_TOKEN(type, message1, message2)                                             \
+	__extension__ ({                                                                        \
+		static const char dbprint_token_entry[]                                             \
+			__attribute__((section("dbprint_tokens"), used)) = type message1 "\0" message2; \
+		(uint32_t)(dbprint_token_entry - __start_dbprint_tokens);                           \
+	})
+
+#define dbtrace(message)                           dbprint_token(DBPRINT_TOKEN("T-", message, ""))
+#define dbinfo(message)                            dbprint_token(DBPRINT_TOKEN("I-", message, ""))
+#define dbwarn(message)                            dbprint_token(DBPRINT_TOKEN("W-", message, ""))
+#define dbcrit(message)                            dbprint_token(DBPRINT_TOKEN("C-", message, ""))
+
+#define dbtraceInt(message1, value, message2)      dbprint_tokenInt(DBPRINT_TOKEN("Td", message1, message2), value)
+#define dbinfoInt(message1, value, message2)       dbprint_tokenInt(DBPRINT_TOKEN("Id", message1, message2), value)
+#define dbwarnInt(message1, value, message2)       dbprint_tokenInt(DBPRINT_TOKEN("Wd", message1, message2), value)
+#define dbcritInt(message1, value, message2)       dbprint_tokenInt(DBPRINT_TOKEN("Cd", message1, message2), value)
+
+#define dbtraceInt_hex(message1, value, message2)  dbprint_tokenInt_hex(DBPRINT_TOKEN("Tx", message1, message2), value)
+#define dbinfoInt_hex(message1, value, message2)   dbprint_tokenInt_hex(DBPRINT_TOKEN("Ix", message1, message2), value)
+#define dbwarnInt_hex(message1, value, message2)   dbprint_tokenInt_hex(DBPRINT_TOKEN("Wx", message1, message2), value)
+#define dbcritInt_hex(message1, value, message2)   dbprint_tokenInt_hex(DBPRINT_TOKEN("Cx", message1, message2), value)
+
+#define dbtrace_ctx(db, message)                          dbprint_token_ctx(db, DBPRINT_TOKEN("T-", message, ""))
+#define dbinfo_ctx(db, message)                           dbprint_token_ctx(db, DBPRINT_TOKEN("I-", message, ""))
+#define dbwarn_ctx(db, message)                           dbprint_token_ctx(db, DBPRINT_TOKEN("W-", message, ""))
+#define dbcrit_ctx(db, message)                           dbprint_token_ctx(db, DBPRINT_TOKEN("C-", message, ""))
+
+#define dbtraceInt_ctx(db, message1, value, message2)     dbprint_tokenInt_ctx(db, DBPRINT_TOKEN("Td", message1, message2), value)
+#define dbinfoInt_ctx(db, message1, value, message2)      dbprint_tokenInt_ctx(db, DBPRINT_TOKEN("Id", message1, message2), value)
+#define dbwarnInt_ctx(db, message1, value, message2)      dbprint_tokenInt_ctx(db, DBPRINT_TOKEN("Wd", message1, message2), value)
+#define dbcritInt_ctx(db, message1, value, message2)      dbprint_tokenInt_ctx(db, DBPRINT_TOKEN("Cd", message1, message2), value)
+
+#define dbtraceInt_hex_ctx(db, message1, value, message2) dbprint_tokenInt_hex_ctx(db, DBPRINT_TOKEN("Tx", message1, message2), value)
+#define dbinfoInt_hex_ctx(db, message1, value, message2)  dbprint_tokenInt_hex_ctx(db, DBPRINT_TOKEN("Ix", message1, message2), value)
+#define dbwarnInt_hex_ctx(db, message1, value, message2)  dbprint_tokenInt_hex_ctx(db, DBPRINT_TOKEN("Wx", message1, message2), value)
+#define dbcritInt_hex_ctx(db, message1, value, message2)  dbprint_tokenInt_hex_ctx(db, DBPRINT_TOKEN("Cx", message1, message2), value)
+
+#endif /* DBPRINT_TOKENIZED */
+
+
+/* Level filtering (DBPRINT_LEVEL in debug_dbprint.h): replace the methods of disabled
+ * levels by empty macros so the statements, their strings and the evaluation of
+ * their arguments are removed from the uploaded code */
+#if defined(DBPRINT_LEVEL) && !defined(DBPRINT_SOURCE)
+
+#if DBPRINT_LEVEL < DBPRINT_LEVEL_TRACE
+#undef dbtrace
+#undef dbtraceInt
+#undef dbtraceInt_hex
+#undef dbtrace_ctx
+#undef dbtraceInt_ctx
+#undef dbtraceInt_hex_ctx
+#define dbtrace(message)                                  ((void)0)
+#define dbtraceInt(message1, value, message2)             ((void)0)
+#define dbtraceInt_hex(message1, value, message2)         ((void)0)
+#define dbtrace_ctx(db, message)                          ((void)0)
+#define dbtraceInt_ctx(db, message1, value, message2)     ((void)0)
+#define dbtraceInt_hex_ctx(db, message1, value, message2) ((void)0)
+#endif
+
+#if DBPRINT_LEVEL < DBPRINT_LEVEL_INFO
+#undef dbinfo
+#undef dbinfoInt
+#undef dbinfoInt_hex
+#undef dbinfo_ctx
+#undef dbinfoInt_ctx
+#undef dbinfoInt_hex_ctx
+#define dbinfo(message)                                   ((void)0)
+#define dbinfoInt(message1, value, message2)              ((void)0)
+#define dbinfoInt_hex(message1, value, message2)          ((void)0)
+#define dbinfo_ctx(db, message)                           ((void)0)
+#define dbinfoInt_ctx(db, message1, value, message2)      ((void)0)
+#define dbinfoInt_hex_ctx(db, message1, value, message2)  ((void)0)
+#endif
+
+#if DBPRINT_LEVEL < DBPRINT_LEVEL_WARN
+#undef dbwarn
+#undef dbwarnInt
+#undef dbwarnInt_hex
+#undef dbwarn_ctx
+#undef dbwarnInt_ctx
+#undef dbwarnInt_hex_ctx
+#define dbwarn(message)                                   ((void)0)
+#define dbwarnInt(message1, value, message2)              ((void)0)
+#define dbwarnInt_hex(message1, value, message2)          ((void)0)
+#define dbwarn_ctx(db, message)                           ((void)0)
+#define dbwarnInt_ctx(db, message1, value, message2)      ((void)0)
+#define dbwarnInt_hex_ctx(db, message1, value, message2)  ((void)0)
+#endif
+
+#if DBPRINT_LEVEL < DBPRINT_LEVEL_CRIT
+#undef dbcrit
+#undef dbcritInt
+#undef dbcritInt_hex
+#undef dbcrit_ctx
+#undef dbcritInt_ctx
+#undef dbcritInt_hex_ctx
+#define dbcrit(message)                                   ((void)0)
+#define dbcritInt(message1, value, message2)              ((void)0)
+#define dbcritInt_hex(message1, value, message2)          ((void)0)
+#define dbcrit_ctx(db, message)                           ((void)0)
+#define dbcritInt_ctx(db, message1, value, message2)      ((void)0)
+#define dbcritInt_hex_ctx(db, message1, value, message2)  ((void)0)
+#endif
+
+#endif /* DBPRINT_LEVEL */
+
+#endif /* DEBUG_DBPRINT */
 
 
 #endif /* _DBPRINT_H_ */
@@ -28,7 +28,11 @@
  *
  *   In the file `debug_dbprint.h` **dbprint UART functionality can be enabled/disabled**
  *   with the definition `#define DEBUG_DBPRINT`. If it's value is `0`, all dbprint
- *   functionality is disabled.
+ *   functionality is disabled and the statements are replaced by empty macros.
+ *
+ *   The definition `DBPRINT_LEVEL` selects which `dbtrace`, `dbinfo`, `dbwarn` and
+ *   `dbcrit` statements are compiled in, the others are removed entirely (including
+ *   their strings and the evaluation of their arguments).
  *
  *   @warning
  *     This means that the **only header file to include in your projects** for
@@ -36,8 +40,8 @@
  *     `#include debug_dbprint.h`
  *
  *   @note
- *     If you also want to use this definition to enable/disable dbprint statements
- *     in your code, please use the following convention:@n
+ *     If you also want to use this definition to enable/disable other dbprint code
+ *     (for example statements using `dbprint_init_t`), please use the following convention:@n
  *     `#if DEBUG_DBPRINT == 1 // DEBUG_DBPRINT `@n
  *     `<your source code dbprint statements go here>`@n
  *     `#endif // DEBUG_DBPRINT`
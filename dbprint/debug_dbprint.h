@@ -4,8 +4,9 @@
  * @details
  *   **This header file should be called in every other file where there are UART
  *   dbprint debugging statements. Depending on the value of `DEBUG_DBPRINT`,
- *   UART statements are enabled or disabled.**
- * @version 7.0
+ *   UART statements are enabled or disabled.** `DBPRINT_LEVEL` selects which
+ *   info, warning and critical error statements are compiled in.
+ * @version 7.25
  * @author Brecht Van Eeckhoudt
  *
  * ******************************************************************************
@@ -48,8 +49,148 @@
 #define DEBUG_DBPRINT 1
 
 
-#if DEBUG_DBPRINT == 1 /* DEBUG_DBPRINT */
+/* Public definitions of the levels used by DBPRINT_LEVEL */
+#define DBPRINT_LEVEL_CRIT  1 /**< Only `dbcrit` statements. */
+#define DBPRINT_LEVEL_WARN  2 /**< `dbwarn` and `dbcrit` statements. */
+#define DBPRINT_LEVEL_INFO  3 /**< `dbinfo`, `dbwarn` and `dbcrit` statements. */
+#define DBPRINT_LEVEL_TRACE 4 /**< All of the above and `dbtrace` statements. */
+
+/** Public definition to select the level of the statements that are compiled in
+ *    @li Disabled statements (including their strings and the evaluation of their
+ *        arguments) are removed from the uploaded code, they don't need to be
+ *        surrounded with `#if ... #endif`.
+ *    @li The `Int(_hex)` variants follow the level of their method. */
+#define DBPRINT_LEVEL DBPRINT_LEVEL_INFO
+
+
+/* The definitions and types (like dbprint_init_t and dbprint_t) are always available */
 #include "dbprint.h"
+
+#if DEBUG_DBPRINT != 1 /* DEBUG_DBPRINT */
+/* Remove all dbprint statements (and the evaluation of their arguments) from the uploaded code
+ *   -> Instances, settings, statistics, command tables and callbacks are referenced (not evaluated
+ *      otherwise) so declaring them doesn't cause unused variable or function warnings
+ *   -> The getters return their "nothing" value and dbprint_stats(_ctx) zeroes the statistics
+ *      (code that reads the counters doesn't read uninitialized memory) */
+/** Empty statement with a value (no "statement with no effect" warning if the value isn't used). */
+#define DBPRINT_EMPTY(value) (__extension__ ({ value; }))
+
+#define dbprint_INIT(pointer, location, vcom, interrupts) ((void)0)
+#define dbprint_INIT_config(init)                         ((void)(init))
+
+#define dbAlert()                                         ((void)0)
+#define dbClear()                                         ((void)0)
+
+#define dbprint(message)                                  ((void)0)
+#define dbprintln(message)                                ((void)0)
+#define dbprintn(message, length)                         ((void)0)
+
+#define dbprintInt(value)                                 ((void)0)
+#define dbprintlnInt(value)                               ((void)0)
+
+#define dbprintInt_hex(value)                             ((void)0)
+#define dbprintlnInt_hex(value)                           ((void)0)
+
+#define dbprint_frame(data, length)                       DBPRINT_EMPTY(true)
+#define dbHexdump(data, length)                           ((void)0)
+
+#define dbprint_color(message, color)                     ((void)0)
+#define dbprintln_color(message, color)                   ((void)0)
+
+#define dbtrace(message)                                  ((void)0)
+#define dbinfo(message)                                   ((void)0)
+#define dbwarn(message)                                   ((void)0)
+#define dbcrit(message)                                   ((void)0)
+
+#define dbtraceInt(message1, value, message2)             ((void)0)
+#define dbinfoInt(message1, value, message2)              ((void)0)
+#define dbwarnInt(message1, value, message2)              ((void)0)
+#define dbcritInt(message1, value, message2)              ((void)0)
+
+#define dbtraceInt_hex(message1, value, message2)         ((void)0)
+#define dbinfoInt_hex(message1, value, message2)          ((void)0)
+#define dbwarnInt_hex(message1, value, message2)          ((void)0)
+#define dbcritInt_hex(message1, value, message2)          ((void)0)
+
+#define dbReadChar()                                      DBPRINT_EMPTY((char)0)
+#define dbReadInt()                                       DBPRINT_EMPTY((uint8_t)0)
+#define dbReadLine(buf)                                   ((void)0)
+
+#define dbGet_RXstatus()                                  DBPRINT_EMPTY(false)
+#define dbGet_TXdropped()                                 DBPRINT_EMPTY((uint32_t)0)
+#define dbFlush()                                         ((void)0)
+#define dbFlush_timeout(timeout)                          DBPRINT_EMPTY(true)
+#define dbIdle_poll()                                     ((void)0)
+#define dbGet_RXbuffer(buf)                               ((void)0)
+#define dbGet_RXline(length)                              DBPRINT_EMPTY((char *)0)
+#define dbRelease_RXline()                                ((void)0)
+#define dbGet_RXvalue(value)                              DBPRINT_EMPTY(false)
+#define dbShell(shell)                                    DBPRINT_EMPTY((void)(shell); false)
+#define dbReadAsync(count, timeout, callback, deferred)   DBPRINT_EMPTY((void)(callback); false)
+#define dbReadAsync_poll()                                ((void)0)
+
+#define dbprint_stats(stats)                              ((void)(*(stats) = (dbprint_stats_t){ 0 }))
+#define dbprintStats()                                    ((void)0)
+#define dbprintStats_reset()                              ((void)0)
+
+/* Methods using a given instance */
+#define dbprint_INIT_ctx(db, pointer, location, vcom, interrupts) ((void)(db))
+#define dbprint_INIT_config_ctx(db, init)                         ((void)(db), (void)(init))
+
+#define dbAlert_ctx(db)                                           ((void)(db))
+#define dbClear_ctx(db)                                           ((void)(db))
+
+#define dbprint_ctx(db, message)                                  ((void)(db))
+#define dbprintln_ctx(db, message)                                ((void)(db))
+#define dbprintn_ctx(db, message, length)                         ((void)(db))
+
+#define dbprintInt_ctx(db, value)                                 ((void)(db))
+#define dbprintlnInt_ctx(db, value)                               ((void)(db))
+
+#define dbprintInt_hex_ctx(db, value)                             ((void)(db))
+#define dbprintlnInt_hex_ctx(db, value)                           ((void)(db))
+
+#define dbprint_frame_ctx(db, data, length)                       DBPRINT_EMPTY((void)(db); true)
+#define dbHexdump_ctx(db, data, length)                           ((void)(db))
+
+#define dbprint_color_ctx(db, message, color)                     ((void)(db))
+#define dbprintln_color_ctx(db, message, color)                   ((void)(db))
+
+#define dbtrace_ctx(db, message)                                  ((void)(db))
+#define dbinfo_ctx(db, message)                                   ((void)(db))
+#define dbwarn_ctx(db, message)                                   ((void)(db))
+#define dbcrit_ctx(db, message)                                   ((void)(db))
+
+#define dbtraceInt_ctx(db, message1, value, message2)             ((void)(db))
+#define dbinfoInt_ctx(db, message1, value, message2)              ((void)(db))
+#define dbwarnInt_ctx(db, message1, value, message2)              ((void)(db))
+#define dbcritInt_ctx(db, message1, value, message2)              ((void)(db))
+
+#define dbtraceInt_hex_ctx(db, message1, value, message2)         ((void)(db))
+#define dbinfoInt_hex_ctx(db, message1, value, message2)          ((void)(db))
+#define dbwarnInt_hex_ctx(db, message1, value, message2)          ((void)(db))
+#define dbcritInt_hex_ctx(db, message1, value, message2)          ((void)(db))
+
+#define dbReadChar_ctx(db)                                        DBPRINT_EMPTY((void)(db); (char)0)
+#define dbReadInt_ctx(db)                                         DBPRINT_EMPTY((void)(db); (uint8_t)0)
+#define dbReadLine_ctx(db, buf)                                   ((void)(db))
+
+#define dbGet_RXstatus_ctx(db)                                    DBPRINT_EMPTY((void)(db); false)
+#define dbGet_TXdropped_ctx(db)                                   DBPRINT_EMPTY((void)(db); (uint32_t)0)
+#define dbFlush_ctx(db)                                           ((void)(db))
+#define dbFlush_timeout_ctx(db, timeout)                          DBPRINT_EMPTY((void)(db); true)
+#define dbIdle_poll_ctx(db)                                       ((void)(db))
+#define dbGet_RXbuffer_ctx(db, buf)                               ((void)(db))
+#define dbGet_RXline_ctx(db, length)                              DBPRINT_EMPTY((void)(db); (char *)0)
+#define dbRelease_RXline_ctx(db)                                  ((void)(db))
+#define dbGet_RXvalue_ctx(db, value)                              DBPRINT_EMPTY((void)(db); false)
+#define dbShell_ctx(db, shell)                                    DBPRINT_EMPTY((void)(db); (void)(shell); false)
+#define dbReadAsync_ctx(db, count, timeout, callback, deferred)   DBPRINT_EMPTY((void)(db); (void)(callback); false)
+#define dbReadAsync_poll_ctx(db)                                  ((void)(db))
+
+#define dbprint_stats_ctx(db, stats)                              ((void)(db), (void)(*(stats) = (dbprint_stats_t){ 0 }))
+#define dbprintStats_ctx(db)                                      ((void)(db))
+#define dbprintStats_reset_ctx(db)                                ((void)(db))
 #endif /* DEBUG_DBPRINT */
 
 
@@ -0,0 +1,309 @@
+/***************************************************************************//**
+ * @file dbdecode.cpp
+ * @brief Host-side decoder for tokenized "DeBugPrint" output.
+ * @details
+ *   Turns a capture of the UART output of a firmware using `DBPRINT_TOKENIZED`
+ *   back into the text `dbtrace`, `dbinfo`, `dbwarn` and `dbcrit` (and their `Int(_hex)`
+ *   variants) would have printed. All other characters are copied unchanged.
+ * @version 7.16
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section Usage
+ *
+ *   Extract the string table from the firmware and decode a capture:@n
+ *   `arm-none-eabi-objcopy -O binary --only-section=dbprint_tokens firmware.axf tokens.bin`@n
+ *   `g++ -std=c++11 -O2 -o dbdecode dbdecode.cpp`@n
+ *   `./dbdecode tokens.bin capture.bin > log.txt` (or read the capture from `stdin`)
+ *
+ * ******************************************************************************
+ *
+ * @section Format
+ *
+ *   - Record: `DBPRINT_TOKEN_START` (`0x01`), token (varint), value (varint, optional).
+ *   - Record with a timestamp: `DBPRINT_TOKEN_START_TIME` (`0x02`), delta (varint, counter
+ *     ticks since the previous record), token (varint), value (varint, optional).
+ *   - Token: offset of the entry in the `dbprint_tokens` section.
+ *   - Entry: level (`T`, `I`, `W` or `C`), notation (`-` none, `d` decimal, `x` hexadecimal),
+ *     `message1`, `\0`, `message2`, `\0`.
+ *   - Decimal values are *zigzag* encoded, hexadecimal values are sent as-is.
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include <cstdint>   /* (u)intXX_t */
+#include <cstdio>    /* fopen, fgetc, ... */
+#include <string>    /* std::string */
+#include <vector>    /* std::vector */
+
+
+/* Have to match DBPRINT_TOKEN_START(_TIME) in dbprint.h */
+#define DBPRINT_TOKEN_START      0x01
+#define DBPRINT_TOKEN_START_TIME 0x02
+
+/* ANSI colors (same as dbprint.c) */
+#define COLOR_RED     "\x1b[31m"
+#define COLOR_YELLOW  "\x1b[33m"
+#define COLOR_RESET   "\x1b[0m"
+
+
+/**************************************************************************//**
+ * @brief
+ *   Read a varint (LEB128) from a stream.
+ *
+ * @param[in] in
+ *   The stream to read from.
+ *
+ * @param[out] value
+ *   The decoded value.
+ *
+ * @return
+ *   @li `true` - A complete varint was read.
+ *   @li `false` - The stream ended or the varint was too long.
+ *****************************************************************************/
+static bool readVarint (FILE *in, uint32_t &value)
+{
+	value = 0;
+
+	for (uint32_t shift = 0; shift < 35; shift += 7)
+	{
+		int byte = fgetc(in);
+		if (byte == EOF) return (false);
+
+		value |= (uint32_t)(byte & 0x7F) << shift;
+
+		/* MSB cleared: last byte */
+		if (!(byte & 0x80)) return (true);
+	}
+
+	return (false);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Format a value the way `dbprintInt` or `dbprintInt_hex` would.
+ *
+ * @param[in] value
+ *   The value received after the token.
+ *
+ * @param[in] notation
+ *   `d` for decimal (zigzag encoded), `x` for hexadecimal.
+ *
+ * @return
+ *   The formatted value.
+ *****************************************************************************/
+static std::string formatValue (uint32_t value, char notation)
+{
+	char buf[16];
+
+	if (notation == 'd')
+	{
+		/* Undo zigzag encoding */
+		int32_t decoded = (int32_t)((value >> 1) ^ (0u - (value & 1)));
+		snprintf(buf, sizeof(buf), "%ld", (long)decoded);
+	}
+	else if (value <= 0xFFFF)
+	{
+		snprintf(buf, sizeof(buf), "0x%04lX", (unsigned long)value);
+	}
+	else
+	{
+		/* Eight nibbles are printed in two groups of four */
+		snprintf(buf, sizeof(buf), "0x%04lX %04lX", (unsigned long)(value >> 16), (unsigned long)(value & 0xFFFF));
+	}
+
+	return (buf);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Reconstruct the text of a record the way `dbtrace`, `dbinfo`, `dbwarn` and `dbcrit`
+ *   (and their `Int(_hex)` variants) print it.
+ *
+ * @param[in] level
+ *   `T`, `I`, `W` or `C`.
+ *
+ * @param[in] message1
+ *   The first part of the string.
+ *
+ * @param[in] value
+ *   The formatted value (empty if the record has no value).
+ *
+ * @param[in] message2
+ *   The second part of the string.
+ *
+ * @return
+ *   The reconstructed text.
+ *****************************************************************************/
+static std::string formatRecord (char level, const std::string &message1,
+                                 const std::string &value, const std::string &message2)
+{
+	std::string text;
+
+	if (level == 'T')
+	{
+		text = "TRACE: " + message1 + value + message2;
+	}
+	else if (level == 'I')
+	{
+		text = "INFO: " + message1 + value + message2;
+	}
+	else
+	{
+		/* The prefix and messages are colored, the value is printed in the default color
+		 *   -> Color codes are only sent when the color changes (same as "dbprint_record") */
+		std::string color = (level == 'W') ? COLOR_YELLOW : COLOR_RED;
+
+		text = color + (level == 'W' ? "WARN: " : "CRIT: ") + message1 + COLOR_RESET;
+
+		if (!value.empty())
+		{
+			text += value;
+			if (!message2.empty()) text += color + message2 + COLOR_RESET;
+		}
+	}
+
+	return (text + "\r\n");
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Decode a capture, copy all other characters unchanged.
+ *
+ * @param[in] table
+ *   The contents of the `dbprint_tokens` section.
+ *
+ * @param[in] in
+ *   The capture to decode.
+ *
+ * @param[in] out
+ *   The stream to write the text to.
+ *****************************************************************************/
+static void decode (const std::vector<char> &table, FILE *in, FILE *out)
+{
+	int byte;
+
+	while ((byte = fgetc(in)) != EOF)
+	{
+		if ((byte != DBPRINT_TOKEN_START) && (byte != DBPRINT_TOKEN_START_TIME))
+		{
+			fputc(byte, out);
+			continue;
+		}
+
+		/* The timestamp is printed the same way as in plain text mode ("+delta ") */
+		std::string timestamp;
+		if (byte == DBPRINT_TOKEN_START_TIME)
+		{
+			uint32_t delta;
+			if (!readVarint(in, delta)) break;
+
+			timestamp = "+" + std::to_string((unsigned long)delta) + " ";
+		}
+
+		uint32_t token;
+		if (!readVarint(in, token)) break;
+
+		/* Check if the entry (at least the type and two terminators) fits in the table */
+		if ((token + 4) > table.size())
+		{
+			fprintf(out, "<unknown token %lu>\r\n", (unsigned long)token);
+			continue;
+		}
+
+		char level = table[token];
+		char notation = table[token + 1];
+
+		/* The table always ends with a terminator, message2 is empty if it's missing */
+		std::string message1(&table[token + 2]);
+		uint32_t index2 = token + 2 + message1.size() + 1;
+		std::string message2 = (index2 < table.size()) ? &table[index2] : "";
+		std::string value;
+
+		if (notation != '-')
+		{
+			uint32_t raw;
+			if (!readVarint(in, raw)) break;
+
+			value = formatValue(raw, notation);
+		}
+
+		fputs((timestamp + formatRecord(level, message1, value, message2)).c_str(), out);
+	}
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Main function.
+ *
+ * @param[in] argc
+ *   Argument count.
+ *
+ * @param[in] argv
+ *   `tokens.bin` and (optional) the capture, otherwise `stdin` is used.
+ *
+ * @return
+ *   `0` on success, `1` if a file couldn't be opened.
+ *****************************************************************************/
+int main (int argc, char *argv[])
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s tokens.bin [capture.bin]\n", argv[0]);
+		return (1);
+	}
+
+	/* Read the string table */
+	FILE *tokens = fopen(argv[1], "rb");
+	if (!tokens)
+	{
+		fprintf(stderr, "Can't open %s\n", argv[1]);
+		return (1);
+	}
+
+	std::vector<char> table;
+	int byte;
+	while ((byte = fgetc(tokens)) != EOF) table.push_back((char)byte);
+	fclose(tokens);
+
+	/* Make sure the last entry is terminated */
+	table.push_back('\0');
+
+	/* Decode the capture */
+	FILE *in = (argc > 2) ? fopen(argv[2], "rb") : stdin;
+	if (!in)
+	{
+		fprintf(stderr, "Can't open %s\n", argv[2]);
+		return (1);
+	}
+
+	decode(table, in, stdout);
+
+	if (in != stdin) fclose(in);
+
+	return (0);
+}
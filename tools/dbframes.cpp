@@ -0,0 +1,254 @@
+/***************************************************************************//**
+ * @file dbframes.cpp
+ * @brief Host-side decoder for the binary frames of "DeBugPrint".
+ * @details
+ *   Splits a capture of the UART output of a firmware using `dbprint_frame`
+ *   in text and binary frames. The text is passed through, every frame is
+ *   printed as a line with its sequence number and data (hexadecimal).
+ *   The amount of valid, corrupt and lost frames is printed to `stderr`
+ *   afterwards.
+ * @version 7.18
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section Usage
+ *
+ *   `g++ -std=c++11 -O2 -o dbframes dbframes.cpp`@n
+ *   `./dbframes capture.bin > log.txt` (or read the capture from `stdin`)@n
+ *   With compression the capture needs to be given to `dbunpack` first:@n
+ *   `./dbunpack capture.bin | ./dbframes > log.txt`
+ *
+ * ******************************************************************************
+ *
+ * @section Format
+ *
+ *   - Frame: `DBPRINT_FRAME_START` (`0x03`), COBS encoded data, `0x00`.
+ *   - Decoded data: sequence number (one byte), data, CRC-16 (CCITT, polynomial `0x1021`,
+ *     start value `0xFFFF`, most significant byte first) of the sequence number and data.
+ *   - `0x00` never occurs inside a frame (`0x03` can), a frame that is longer than
+ *     `DBPRINT_FRAME_SIZE` (because its `0x00` got lost) is corrupt.
+ *   - A gap in the sequence numbers that isn't explained by corrupt frames is counted
+ *     as lost frames (dropped by the firmware because the TX queue was full, or lost
+ *     on the line).
+ *   - Tokenized records (`DBPRINT_TOKENIZED`) can contain these characters, so they
+ *     can't be used together with binary frames.
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include <cstdint>   /* (u)intXX_t */
+#include <cstdio>    /* fopen, fgetc, ... */
+#include <vector>    /* std::vector */
+
+
+/* Have to match DBPRINT_FRAME_START and DBPRINT_FRAME_SIZE in dbprint.h */
+#define DBPRINT_FRAME_START 0x03
+#define DBPRINT_FRAME_SIZE  128
+
+/* Longest encoded frame: sequence number, data, CRC and COBS overhead */
+#define FRAME_ENCODED_MAX (DBPRINT_FRAME_SIZE + 3 + ((DBPRINT_FRAME_SIZE + 3) / 254) + 1)
+
+
+/**************************************************************************//**
+ * @brief
+ *   Update a CRC-16 (CCITT, polynomial `0x1021`) with one byte.
+ *
+ * @param[in] crc
+ *   The CRC so far (`0xFFFF` to start).
+ *
+ * @param[in] data
+ *   The byte to add.
+ *
+ * @return
+ *   The updated CRC.
+ *****************************************************************************/
+static uint16_t crc16_update (uint16_t crc, uint8_t data)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		bool bit = ((crc >> 15) ^ (data >> (7 - i))) & 1;
+		crc <<= 1;
+		if (bit) crc ^= 0x1021;
+	}
+
+	return (crc);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Decode COBS encoded data.
+ *
+ * @param[in] in
+ *   The encoded data (without the start character and `0x00`).
+ *
+ * @param[out] out
+ *   The decoded data.
+ *
+ * @return
+ *   @li `true` - The encoding is valid.
+ *   @li `false` - A distance points past the end of the data.
+ *****************************************************************************/
+static bool cobs_decode (const std::vector<uint8_t> &in, std::vector<uint8_t> &out)
+{
+	out.clear();
+
+	size_t i = 0;
+	while (i < in.size())
+	{
+		uint8_t code = in[i++];
+		if ((i + code - 1) > in.size()) return (false);
+
+		for (uint8_t j = 1; j < code; j++) out.push_back(in[i++]);
+
+		/* A zero byte follows, except after a full block and at the end */
+		if ((code != 0xFF) && (i < in.size())) out.push_back(0x00);
+	}
+
+	return (true);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Split a capture in text and frames.
+ *
+ * @param[in] in
+ *   The capture to decode.
+ *
+ * @param[in] out
+ *   The stream to write the text and frames to.
+ *****************************************************************************/
+static void decode (FILE *in, FILE *out)
+{
+	unsigned long valid = 0, crcErrors = 0, corrupt = 0, lost = 0;
+	unsigned long bad = 0; /* Corrupt frames since the last valid frame */
+	bool first = true;
+	uint8_t expected = 0;
+	int byte = fgetc(in);
+
+	while (byte != EOF)
+	{
+		/* Pass text through */
+		if (byte != DBPRINT_FRAME_START)
+		{
+			fputc(byte, out);
+			byte = fgetc(in);
+			continue;
+		}
+
+		/* Read until the end of the frame */
+		std::vector<uint8_t> encoded;
+		byte = fgetc(in);
+		while ((byte != EOF) && (byte != 0x00) && (encoded.size() <= FRAME_ENCODED_MAX))
+		{
+			encoded.push_back((uint8_t)byte);
+			byte = fgetc(in);
+		}
+
+		/* Too long or incomplete, skip the rest of it */
+		if (byte != 0x00)
+		{
+			corrupt++;
+			bad++;
+			fprintf(out, "[corrupt frame]\n");
+			while ((byte != EOF) && (byte != 0x00)) byte = fgetc(in);
+			if (byte != EOF) byte = fgetc(in);
+			continue;
+		}
+
+		std::vector<uint8_t> data;
+		if (!cobs_decode(encoded, data) || (data.size() < 3))
+		{
+			corrupt++;
+			bad++;
+			fprintf(out, "[corrupt frame]\n");
+			byte = fgetc(in);
+			continue;
+		}
+
+		uint16_t crc = 0xFFFF;
+		for (size_t i = 0; i < (data.size() - 2); i++) crc = crc16_update(crc, data[i]);
+
+		if (crc != ((data[data.size() - 2] << 8) | data[data.size() - 1]))
+		{
+			crcErrors++;
+			bad++;
+			fprintf(out, "[frame CRC error]\n");
+			byte = fgetc(in);
+			continue;
+		}
+
+		/* Frames between the previous and this sequence number are lost (or were corrupt) */
+		uint8_t seq = data[0];
+		uint8_t gap = seq - expected;
+		if (!first && (gap > bad)) lost += gap - bad;
+		first = false;
+		bad = 0;
+		expected = seq + 1;
+		valid++;
+
+		fprintf(out, "[frame %u, %u bytes]", seq, (unsigned)(data.size() - 3));
+		for (size_t i = 1; i < (data.size() - 2); i++) fprintf(out, " %02X", data[i]);
+		fprintf(out, "\n");
+
+		byte = fgetc(in);
+	}
+
+	unsigned long total = valid + crcErrors + corrupt + lost;
+
+	fprintf(stderr, "%lu frames valid, %lu CRC errors, %lu corrupt, %lu lost", valid, crcErrors, corrupt, lost);
+	if (total > 0) fprintf(stderr, " (%.2f %% corrupt, %.2f %% lost)",
+	                       (100.0 * (crcErrors + corrupt)) / total, (100.0 * lost) / total);
+	fprintf(stderr, "\n");
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Main function.
+ *
+ * @param[in] argc
+ *   Argument count.
+ *
+ * @param[in] argv
+ *   The capture (optional), otherwise `stdin` is used.
+ *
+ * @return
+ *   `0` on success, `1` if the file couldn't be opened.
+ *****************************************************************************/
+int main (int argc, char *argv[])
+{
+	FILE *in = (argc > 1) ? fopen(argv[1], "rb") : stdin;
+	if (!in)
+	{
+		fprintf(stderr, "Can't open %s\n", argv[1]);
+		return (1);
+	}
+
+	decode(in, stdout);
+
+	if (in != stdin) fclose(in);
+
+	return (0);
+}
@@ -0,0 +1,336 @@
+/***************************************************************************//**
+ * @file dbshellgen.cpp
+ * @brief Generator of the command table used by `dbShell` ("DeBugPrint").
+ * @details
+ *   Reads a list of commands and writes a C file with the command table
+ *   (`dbprint_shell_t`). The seed of the hash is chosen so every command gets
+ *   its own slot (perfect hash), `dbShell` then only has to compare the
+ *   received command with the one command in its slot.
+ * @version 7.24
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section Usage
+ *
+ *   `g++ -std=c++11 -O2 -o dbshellgen dbshellgen.cpp`@n
+ *   `./dbshellgen commands.txt > dbshell_commands.c` (the table is called `dbshell`)@n
+ *   `./dbshellgen commands.txt mytable > mytable.c` (another name for the table)@n
+ *   Add the generated file to your project and call `dbShell(&dbshell);` in the main loop.
+ *
+ * ******************************************************************************
+ *
+ * @section Format
+ *
+ *   - One command per line: name, handler and description (the rest of the line),
+ *     separated by spaces or tabs. Empty lines and lines starting with `#` are skipped.@n
+ *     `led  cmd_led  Set the LED (led on/off)`
+ *   - The handlers are defined by the application:@n
+ *     `void cmd_led (dbprint_t *db, uint32_t argc, char *argv[]);`
+ *   - The hash (FNV-1a with the seed as start value, slot = hash & (size - 1)) has to
+ *     match `shell_hash` in `dbprint.c`.
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include <cstdint>   /* (u)intXX_t */
+#include <cstdio>    /* fopen, fgets, ... */
+#include <string>    /* std::string */
+#include <vector>    /* std::vector */
+
+
+/* Has to match DBPRINT_SHELL_PRIME in dbprint.h */
+#define DBPRINT_SHELL_PRIME 16777619
+
+/* Amount of seeds that are tried before the table is made larger */
+#define SEED_ATTEMPTS 1000000
+
+
+/** Struct type for a command read from the list. */
+struct command_t
+{
+	std::string name;
+	std::string handler;
+	std::string help;
+};
+
+
+/**************************************************************************//**
+ * @brief
+ *   Calculate the hash of a command (FNV-1a), the same way as `shell_hash`.
+ *
+ * @param[in] name
+ *   The command.
+ *
+ * @param[in] seed
+ *   The start value of the hash.
+ *
+ * @return
+ *   The hash.
+ *****************************************************************************/
+static uint32_t shellHash (const std::string &name, uint32_t seed)
+{
+	uint32_t hash = seed;
+
+	for (unsigned char c : name)
+	{
+		hash ^= c;
+		hash *= DBPRINT_SHELL_PRIME;
+	}
+
+	return (hash);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Read the list of commands.
+ *
+ * @param[in] in
+ *   The list.
+ *
+ * @param[out] commands
+ *   The commands.
+ *
+ * @return
+ *   @li `true` - The list is valid.
+ *   @li `false` - A line is incomplete or a command is listed twice.
+ *****************************************************************************/
+static bool readCommands (FILE *in, std::vector<command_t> &commands)
+{
+	char buf[512];
+	unsigned line = 0;
+
+	while (fgets(buf, sizeof(buf), in))
+	{
+		line++;
+
+		std::string text(buf);
+		while (!text.empty() && ((text.back() == '\n') || (text.back() == '\r'))) text.pop_back();
+
+		/* Split in name, handler and description */
+		std::vector<std::string> fields;
+		size_t i = 0;
+		while ((fields.size() < 2) && (i < text.size()))
+		{
+			while ((i < text.size()) && ((text[i] == ' ') || (text[i] == '\t'))) i++;
+			size_t start = i;
+			while ((i < text.size()) && (text[i] != ' ') && (text[i] != '\t')) i++;
+			if (i > start) fields.push_back(text.substr(start, i - start));
+		}
+		while ((i < text.size()) && ((text[i] == ' ') || (text[i] == '\t'))) i++;
+
+		if (fields.empty() || (fields[0][0] == '#')) continue;
+
+		if (fields.size() < 2)
+		{
+			fprintf(stderr, "Line %u: a command needs a name and a handler\n", line);
+			return (false);
+		}
+
+		for (const command_t &command : commands)
+		{
+			if (command.name == fields[0])
+			{
+				fprintf(stderr, "Line %u: \"%s\" is listed twice\n", line, fields[0].c_str());
+				return (false);
+			}
+		}
+
+		commands.push_back({ fields[0], fields[1], text.substr(i) });
+	}
+
+	return (true);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Find a seed for which every command gets its own slot.
+ *
+ * @details
+ *   The table starts at twice the amount of commands (rounded up to a power
+ *   of two) and is made larger if no seed is found.
+ *
+ * @param[in] commands
+ *   The commands.
+ *
+ * @param[out] size
+ *   The amount of slots.
+ *
+ * @param[out] seed
+ *   The seed.
+ *****************************************************************************/
+static void findSeed (const std::vector<command_t> &commands, uint32_t &size, uint32_t &seed)
+{
+	size = 1;
+	while (size < (2 * commands.size())) size <<= 1;
+
+	while (true)
+	{
+		for (uint32_t attempt = 0; attempt < SEED_ATTEMPTS; attempt++)
+		{
+			seed = 2166136261u + attempt; /* FNV offset basis for the first attempt */
+
+			std::vector<bool> used(size, false);
+			bool perfect = true;
+
+			for (const command_t &command : commands)
+			{
+				uint32_t slot = shellHash(command.name, seed) & (size - 1);
+				if (used[slot])
+				{
+					perfect = false;
+					break;
+				}
+				used[slot] = true;
+			}
+
+			if (perfect) return;
+		}
+
+		size <<= 1;
+	}
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Write a string as C string literal.
+ *
+ * @param[in] out
+ *   The stream to write to.
+ *
+ * @param[in] text
+ *   The string.
+ *****************************************************************************/
+static void writeLiteral (FILE *out, const std::string &text)
+{
+	fputc('"', out);
+	for (char c : text)
+	{
+		if ((c == '"') || (c == '\\')) fputc('\\', out);
+		fputc(c, out);
+	}
+	fputc('"', out);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Write the C file with the command table.
+ *
+ * @param[in] out
+ *   The stream to write to.
+ *
+ * @param[in] commands
+ *   The commands.
+ *
+ * @param[in] table
+ *   The name of the table (`dbprint_shell_t`).
+ *****************************************************************************/
+static void writeTable (FILE *out, const std::vector<command_t> &commands, const std::string &table)
+{
+	uint32_t size, seed;
+	findSeed(commands, size, seed);
+
+	std::vector<const command_t *> slots(size, nullptr);
+	for (const command_t &command : commands) slots[shellHash(command.name, seed) & (size - 1)] = &command;
+
+	fprintf(out, "/* Generated by dbshellgen (tools/dbshellgen.cpp), do not edit */\n\n");
+	fprintf(out, "#include \"debug_dbprint.h\"\n\n");
+	fprintf(out, "#if DEBUG_DBPRINT == 1 /* DEBUG_DBPRINT */\n\n");
+
+	/* Prototypes of the handlers (every handler only once) */
+	fprintf(out, "/* Handlers of the commands (defined by the application) */\n");
+	for (size_t i = 0; i < commands.size(); i++)
+	{
+		bool first = true;
+		for (size_t j = 0; j < i; j++) if (commands[j].handler == commands[i].handler) first = false;
+		if (first) fprintf(out, "void %s (dbprint_t *db, uint32_t argc, char *argv[]);\n", commands[i].handler.c_str());
+	}
+
+	fprintf(out, "\n/* Slots of the table (the hash of a command selects its slot) */\n");
+	fprintf(out, "static const dbprint_command_t %s_slots[%u] =\n{\n", table.c_str(), size);
+	for (uint32_t i = 0; i < size; i++)
+	{
+		fprintf(out, "\t{ ");
+		if (slots[i] == nullptr)
+		{
+			fprintf(out, "NULL, NULL, NULL");
+		}
+		else
+		{
+			writeLiteral(out, slots[i]->name);
+			fprintf(out, ", %s, ", slots[i]->handler.c_str());
+			writeLiteral(out, slots[i]->help);
+		}
+		fprintf(out, " }%s\n", (i + 1 < size) ? "," : "");
+	}
+	fprintf(out, "};\n\n");
+
+	fprintf(out, "/* Command table (%u commands, %u slots) */\n", (unsigned)commands.size(), size);
+	fprintf(out, "const dbprint_shell_t %s = { %s_slots, %u, 0x%08X };\n\n", table.c_str(), table.c_str(), size, seed);
+	fprintf(out, "#endif /* DEBUG_DBPRINT */\n");
+
+	fprintf(stderr, "%u commands in %u slots, seed 0x%08X\n", (unsigned)commands.size(), size, seed);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Main function.
+ *
+ * @param[in] argc
+ *   Argument count.
+ *
+ * @param[in] argv
+ *   The list of commands and the name of the table (optional, `dbshell`).
+ *
+ * @return
+ *   `0` on success, `1` if the list couldn't be opened or is invalid.
+ *****************************************************************************/
+int main (int argc, char *argv[])
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s commands.txt [table] > table.c\n", argv[0]);
+		return (1);
+	}
+
+	FILE *in = fopen(argv[1], "r");
+	if (!in)
+	{
+		fprintf(stderr, "Can't open %s\n", argv[1]);
+		return (1);
+	}
+
+	std::vector<command_t> commands;
+	bool valid = readCommands(in, commands);
+	fclose(in);
+
+	if (!valid) return (1);
+
+	writeTable(stdout, commands, (argc > 2) ? argv[2] : "dbshell");
+
+	return (0);
+}
@@ -0,0 +1,217 @@
+/***************************************************************************//**
+ * @file dbunpack.cpp
+ * @brief Host-side decompressor for compressed "DeBugPrint" output.
+ * @details
+ *   Turns a capture of the UART output of a firmware using `init.compress`
+ *   (`DBPRINT_COMPRESS`) back into the text that was put in the TX queue.
+ *   The compression ratio is printed to `stderr` afterwards.
+ * @version 7.17
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section Usage
+ *
+ *   `g++ -std=c++11 -O2 -o dbunpack dbunpack.cpp`@n
+ *   `./dbunpack capture.bin > log.txt` (or read the capture from `stdin`)@n
+ *   With tokenized logging the output can be given to `dbdecode` afterwards:@n
+ *   `./dbunpack capture.bin | ./dbdecode tokens.bin > log.txt`
+ *
+ * ******************************************************************************
+ *
+ * @section Format
+ *
+ *   - Frame: `DBPRINT_PACK_START` (`0xFF`), length (`0x00 - 0xFE`), data.
+ *   - `0x00 - 0x7F`: Literal character.
+ *   - `0x80 - 0xFD`, offset: Copy `byte - 0x80 + 3` characters starting `offset + 1`
+ *     characters back (only in the same frame).
+ *   - `0xFE`, character: Literal character `0x80 - 0xFF` (minus `0x80`).
+ *   - `0xFF` never occurs inside a frame, the data before the first frame (or after a
+ *     corrupt frame) is skipped until the next `0xFF`.
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include <cstdint>   /* (u)intXX_t */
+#include <cstdio>    /* fopen, fgetc, ... */
+#include <string>    /* std::string */
+#include <vector>    /* std::vector */
+
+
+/* Has to match DBPRINT_PACK_START in dbprint.h */
+#define DBPRINT_PACK_START 0xFF
+
+
+/**************************************************************************//**
+ * @brief
+ *   Decompress the data of one frame.
+ *
+ * @param[in] data
+ *   The data of the frame (without the start character and length).
+ *
+ * @param[out] text
+ *   The decompressed characters.
+ *
+ * @return
+ *   @li `true` - The frame is valid.
+ *   @li `false` - The frame is corrupt (incomplete item or an offset before the start of the frame).
+ *****************************************************************************/
+static bool unpackFrame (const std::vector<uint8_t> &data, std::string &text)
+{
+	text.clear();
+
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		uint8_t byte = data[i];
+
+		if (byte < 0x80)
+		{
+			text += (char)byte;
+		}
+		else if (byte == 0xFE)
+		{
+			if ((i + 1) >= data.size()) return (false);
+			text += (char)(data[++i] + 0x80);
+		}
+		else
+		{
+			if ((i + 1) >= data.size()) return (false);
+
+			size_t length = byte - 0x80 + 3;
+			size_t offset = data[++i] + 1;
+			if (offset > text.size()) return (false);
+
+			/* Copy one by one, the match can overlap the characters it produces */
+			size_t from = text.size() - offset;
+			for (size_t j = 0; j < length; j++) text += text[from + j];
+		}
+	}
+
+	return (true);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Decompress a capture.
+ *
+ * @param[in] in
+ *   The capture to decompress.
+ *
+ * @param[in] out
+ *   The stream to write the text to.
+ *****************************************************************************/
+static void unpack (FILE *in, FILE *out)
+{
+	unsigned long bytes = 0, characters = 0, frames = 0, skipped = 0, corrupt = 0;
+	int byte = fgetc(in);
+
+	while (byte != EOF)
+	{
+		bytes++;
+
+		/* Skip everything until the start of a frame */
+		if (byte != DBPRINT_PACK_START)
+		{
+			skipped++;
+			byte = fgetc(in);
+			continue;
+		}
+
+		int length = fgetc(in);
+		if (length == EOF) break;
+		bytes++;
+
+		/* A start character can't be a length, it's the start of the next frame */
+		if (length == DBPRINT_PACK_START)
+		{
+			corrupt++;
+			byte = length;
+			bytes--;
+			continue;
+		}
+
+		std::vector<uint8_t> data;
+		while ((int)data.size() < length)
+		{
+			byte = fgetc(in);
+			if ((byte == EOF) || (byte == DBPRINT_PACK_START)) break;
+			data.push_back((uint8_t)byte);
+			bytes++;
+		}
+
+		std::string text;
+		if (((int)data.size() == length) && unpackFrame(data, text))
+		{
+			fwrite(text.data(), 1, text.size(), out);
+			characters += text.size();
+			frames++;
+		}
+		else
+		{
+			corrupt++;
+		}
+
+		/* Continue with the start character that interrupted the frame (if any) */
+		if (((int)data.size() < length) && (byte == DBPRINT_PACK_START))
+		{
+			bytes--;
+			continue;
+		}
+
+		byte = fgetc(in);
+	}
+
+	fprintf(stderr, "%lu frames, %lu bytes -> %lu characters", frames, bytes, characters);
+	if (characters > 0) fprintf(stderr, " (%.1f %% of the size)", (100.0 * bytes) / characters);
+	fprintf(stderr, ", %lu bytes skipped, %lu corrupt frames\n", skipped, corrupt);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Main function.
+ *
+ * @param[in] argc
+ *   Argument count.
+ *
+ * @param[in] argv
+ *   The capture (optional), otherwise `stdin` is used.
+ *
+ * @return
+ *   `0` on success, `1` if the file couldn't be opened.
+ *****************************************************************************/
+int main (int argc, char *argv[])
+{
+	FILE *in = (argc > 1) ? fopen(argv[1], "rb") : stdin;
+	if (!in)
+	{
+		fprintf(stderr, "Can't open %s\n", argv[1]);
+		return (1);
+	}
+
+	unpack(in, stdout);
+
+	if (in != stdin) fclose(in);
+
+	return (0);
+}
@@ -0,0 +1,205 @@
+/***************************************************************************//**
+ * @file bench_dbwarn.c
+ * @brief Cost of `dbwarn` and `dbwarnInt` before and after the tables of literals (v7.21).
+ * @details
+ *   dbprint.c is included so the record is also assembled like before v7.21:
+ *   the color code and prefix as separate strings, the length of every
+ *   string counted character by character before it's appended with
+ *   `record_appendn` (the record parts and TX queue are the same for both).
+ *   The host time and the CPU cycles (time stamp counter on x86) per call
+ *   are printed with a producer that outruns the TX line (`sim_hold`, in
+ *   batches that fit in the TX queue). The output has to be the same byte
+ *   for byte.
+ * @version 7.22
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+
+
+#define _POSIX_C_SOURCE 199309L /* clock_gettime */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> /* __rdtsc */
+#endif
+#include "dbprint.c" /* record_start, record_appendn, record_appendInt, record_submit */
+#include "sim.h"
+
+
+/* Calls per measurement */
+#define CALLS 20000
+
+
+/* Messages compared */
+static char *messages[] = { "Low battery", "Sensor didn't answer in time, retrying with a longer timeout" };
+
+
+/* Output of the current method (compared with the old one) */
+static char expected[DBPRINT_TX_BUFFER_SIZE];
+static size_t expectedLength;
+
+static unsigned int mismatches;
+
+
+/* Host time in nanoseconds */
+static double now (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e9 + ts.tv_nsec);
+}
+
+
+/* CPU cycles (0 if there is no time stamp counter) */
+static unsigned long long cycles (void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return (__rdtsc());
+#else
+	return (0);
+#endif
+}
+
+
+/* Append a string to a record (before v7.21) */
+static void old_append (record_t *record, const char *string)
+{
+	uint32_t length = 0;
+	while (string[length] != '\0') length++;
+
+	record_appendn(record, string, length);
+}
+
+
+/* dbprint_record before v7.21 (no timestamps in this benchmark) */
+__attribute__((noinline)) static void old_record (dbprint_t *db, uint8_t level, const char *prefix, const char *color,
+                                                 char *message1, int32_t value, char notation, char *message2)
+{
+	record_t record;
+	record_start(&record, db, level);
+
+	db->stats.records[level - 1]++;
+
+	if (color != NULL) old_append(&record, color);
+	old_append(&record, prefix);
+	old_append(&record, message1);
+
+	if (notation != '-')
+	{
+		if (color != NULL) old_append(&record, COLOR_RESET);
+		record_appendInt(&record, value, notation);
+
+		if ((color != NULL) && (message2[0] != '\0'))
+		{
+			old_append(&record, color);
+			old_append(&record, message2);
+			old_append(&record, COLOR_RESET);
+		}
+		else
+		{
+			old_append(&record, message2);
+		}
+	}
+	else
+	{
+		old_append(&record, message2);
+		if (color != NULL) old_append(&record, COLOR_RESET);
+	}
+
+	old_append(&record, "\r\n");
+
+	record_submit(&record);
+}
+
+
+/* Call dbwarn or dbwarnInt (value) as it is now or like before v7.21 (old) in batches, prints the cost per call */
+static void run (bool value, char *message, bool old)
+{
+	char line[128];
+	snprintf(line, sizeof(line), "WARN: %s%s", message, value ? "-123 mV" : "");
+	uint32_t length = (uint32_t)strlen(line) + (uint32_t)(sizeof(COLOR_YELLOW COLOR_RESET "\r\n") - 1) +
+	                  (value ? (uint32_t)(sizeof(COLOR_YELLOW COLOR_RESET) - 1) : 0);
+	uint32_t batch = (DBPRINT_TX_BUFFER_SIZE - 1) / length; /* Calls that fit in the TX queue */
+	double fastest = 0;
+	unsigned long long fewest = 0;
+
+	for (uint32_t b = 0; b < (CALLS / batch); b++)
+	{
+		/* Nothing is transmitted during the calls (the fastest batch counts) */
+		sim_hold = true;
+		double start = now();
+		unsigned long long startCycles = cycles();
+		for (uint32_t i = 0; i < batch; i++)
+		{
+			if (old) old_record(&dbdefault, DBPRINT_LEVEL_WARN, "WARN: ", COLOR_YELLOW, message, -123, value ? 'd' : '-', value ? " mV" : "");
+			else if (value) dbwarnInt(message, -123, " mV");
+			else dbwarn(message);
+		}
+		unsigned long long spent = (cycles() - startCycles) / batch;
+		double time = (now() - start) / batch;
+		sim_hold = false;
+		dbFlush();
+
+		if ((b == 0) || (time < fastest)) fastest = time;
+		if ((b == 0) || (spent < fewest)) fewest = spent;
+
+		/* The same output byte for byte */
+		if (!old && (b == 0))
+		{
+			expectedLength = sim_port[SIM_USART1].length;
+			memcpy(expected, sim_port[SIM_USART1].output, expectedLength);
+		}
+		if ((sim_port[SIM_USART1].length != expectedLength) ||
+		    (memcmp(sim_port[SIM_USART1].output, expected, expectedLength) != 0)) mismatches++;
+		sim_clearOutput(SIM_USART1);
+	}
+
+	printf("bench_dbwarn: %-9s %-10s %3lu characters %7.1f ns %6llu cycles per call (host)\n", value ? "dbwarnInt" : "dbwarn",
+	       old ? "(< v7.21)" : "(current)", (unsigned long)length, fastest, fewest);
+}
+
+
+int main (void)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+
+	sim_reset();
+	sim_sleepLimit = 0; /* Every batch is flushed */
+	init.banner = false;
+	dbprint_INIT_config(&init);
+
+	for (unsigned int m = 0; m < (sizeof(messages) / sizeof(messages[0])); m++)
+	{
+		run(false, messages[m], false);
+		run(false, messages[m], true);
+	}
+	run(true, messages[0], false);
+	run(true, messages[0], true);
+
+	if (mismatches) fprintf(stderr, "bench_dbwarn: %u mismatch(es)\n", mismatches);
+
+	return (mismatches != 0);
+}
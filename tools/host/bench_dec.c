@@ -0,0 +1,223 @@
+/***************************************************************************//**
+ * @file bench_dec.c
+ * @brief Cost of the decimal conversion of `dbprintInt`: per-digit `% 10` and
+ *        `/ 10` (up to v7.4) versus `uint32_to_charDec` (reciprocal and pairs).
+ * @details
+ *   dbprint.c is included so the static `uint32_to_charDec` is called
+ *   directly. Both conversions have to give the same string for every value
+ *   of a sweep over the full `int32_t` range (every 4099th value, negative
+ *   ones are converted like `dbprintInt` does) and for values of every
+ *   length. The host time per conversion is printed per length and for the
+ *   sweep (the fastest of several runs).@n
+ *   `make size` compiles this file with `DEC_SIZE` (no benchmark) and
+ *   reports the size of both conversions and the library calls they need
+ *   (for example `__aeabi_uidivmod` versus `__aeabi_lmul` on the Cortex-M0+).
+ * @version 7.5
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#define _POSIX_C_SOURCE 199309L /* clock_gettime */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "dbprint.c" /* uint32_to_charDec */
+
+
+/* Macro definition that returns a character when given a value (v7.4) */
+#define TO_DEC(i) (i <= 9 ? '0' + i : '?') /* return "?" if out of range */
+
+
+/**************************************************************************//**
+ * @brief
+ *   Convert a `uint32_t` value to a decimal char array (string), the
+ *   implementation up to v7.4 (two library calls per digit on the
+ *   Cortex-M0+, which has no hardware divider).
+ *
+ * @param[out] buf
+ *   The buffer to put the resulting string in (`char buf[11];`).
+ *
+ * @param[in] value
+ *   The `uint32_t` value to convert to a string.
+ *****************************************************************************/
+__attribute__((noinline)) void uint32_to_charDec_div (char *buf, uint32_t value)
+{
+	if (value == 0)
+	{
+		buf[0] = '0';
+		buf[1] = '\0'; /* NULL termination character */
+	}
+	else
+	{
+		/* MAX uint32_t value = FFFFFFFFh = 4294967295d (10 decimal chars) */
+		char backwardsBuf[10];
+
+		uint32_t calcval = value;
+		uint8_t length = 0;
+		uint8_t lengthCounter = 0;
+
+
+		/* Loop until the value is zero (separate characters 0-9) and calculate length */
+		while (calcval)
+		{
+			uint32_t rem = calcval % 10;
+			backwardsBuf[length] = TO_DEC(rem); /* Convert to ASCII character */
+			length++;
+
+			calcval = calcval - rem;
+			calcval = calcval / 10;
+		}
+
+		/* Backwards counter */
+		lengthCounter = length;
+
+		/* Reverse the characters in the buffer for the final string */
+		for (uint8_t i = 0; i < length; i++)
+		{
+			buf[i] = backwardsBuf[lengthCounter-1];
+			lengthCounter--;
+		}
+
+		/* Add NULL termination character */
+		buf[length] = '\0';
+	}
+}
+
+
+#ifndef DEC_SIZE
+
+/* Step of the sweep over the int32_t range (prime, so every last digit occurs) */
+#define STEP 4099
+
+/* Values per length */
+#define VALUES 100000
+
+/* Runs per measurement (the fastest one counts) */
+#define RUNS 7
+
+
+/* Conversion under test */
+typedef void (*convert_t) (char *buf, uint32_t value);
+
+/* Keeps the results alive */
+static volatile char sink;
+
+static unsigned int mismatches;
+
+
+/* Absolute value of an int32_t value (like dbprintInt) */
+static uint32_t magnitude (int32_t value)
+{
+	return ((value < 0) ? (~(uint32_t)value) + 1 : (uint32_t)value);
+}
+
+
+/* Host time in nanoseconds */
+static double now (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e9 + ts.tv_nsec);
+}
+
+
+/* Convert "count" values (value(i) = first + i * step) and return the host time in nanoseconds per conversion */
+static double run (convert_t convert, uint32_t first, uint32_t step, uint32_t count, bool sweep)
+{
+	char buf[11];
+	double fastest = 0;
+
+	for (uint8_t r = 0; r < RUNS; r++)
+	{
+		double start = now();
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			uint32_t value = first + (i * step);
+			convert(buf, sweep ? magnitude((int32_t)value) : value);
+			sink = buf[0];
+		}
+
+		double time = (now() - start) / count;
+		if ((r == 0) || (time < fastest)) fastest = time;
+	}
+
+	return (fastest);
+}
+
+
+/* Compare both conversions for "count" values */
+static void compare (uint32_t first, uint32_t step, uint32_t count, bool sweep)
+{
+	char old[11], new[11];
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t value = first + (i * step);
+		if (sweep) value = magnitude((int32_t)value);
+
+		uint32_to_charDec_div(old, value);
+		uint32_to_charDec(new, value);
+		if (strcmp(old, new) != 0)
+		{
+			if (mismatches++ < 10) fprintf(stderr, "bench_dec: %lu -> \"%s\" instead of \"%s\"\n", (unsigned long)value, new, old);
+		}
+	}
+}
+
+
+int main (void)
+{
+	/* Every length: values spread over [10^(length - 1), 10^length[ */
+	printf("bench_dec: %-8s %10s %10s\n", "digits", "% 10, / 10", "pairs");
+	uint64_t high = 1;
+	for (uint8_t length = 1; length <= 10; length++)
+	{
+		uint64_t low = (length == 1) ? 0 : high;
+		high = (length == 10) ? 0x100000000ull : high * 10;
+		uint32_t step = (uint32_t)((high - low) / VALUES) + 1;
+		uint32_t count = (uint32_t)((high - low + step - 1) / step);
+
+		compare((uint32_t)low, step, count, false);
+		double old = run(uint32_to_charDec_div, (uint32_t)low, step, count, false);
+		double new = run(uint32_to_charDec, (uint32_t)low, step, count, false);
+		printf("bench_dec: %-8u %8.1f ns %7.1f ns\n", length, old, new);
+	}
+
+	/* Sweep over the int32_t range (most values have ten digits) */
+	uint32_t count = (uint32_t)(0x100000000ull / STEP);
+	compare(0x80000000, STEP, count, true);
+	compare(0, 1, 100000, true);
+	compare(0xFFFFFFFF - 100000, 1, 100001, true);
+	double old = run(uint32_to_charDec_div, 0x80000000, STEP, count, true);
+	double new = run(uint32_to_charDec, 0x80000000, STEP, count, true);
+	printf("bench_dec: int32_t range (%lu values) %.1f ns with %% 10, / 10, %.1f ns with pairs (%.1fx, host)\n",
+	       (unsigned long)count, old, new, old / new);
+
+	if (mismatches) fprintf(stderr, "bench_dec: %u mismatch(es)\n", mismatches);
+
+	return (mismatches != 0);
+}
+
+#endif /* DEC_SIZE */
@@ -0,0 +1,122 @@
+/***************************************************************************//**
+ * @file bench_hexdump.c
+ * @brief Cost per byte of `dbHexdump` versus printing the words with `dbprintInt_hex`.
+ * @details
+ *   The same data is dumped with `dbHexdump` (one record per line of 16
+ *   bytes) and with a `dbprintInt_hex` per word (a space after every word,
+ *   a new line after every four), the way it was done before `dbHexdump`.
+ *   The producer outruns the TX line (`sim_hold`). The host time, critical
+ *   sections and output characters per dumped byte are printed, and the
+ *   bytes per microsecond (host).
+ * @version 7.22
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+
+
+#define _POSIX_C_SOURCE 199309L /* clock_gettime */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "debug_dbprint.h"
+#include "sim.h"
+
+
+/* Bytes dumped per run */
+#define BYTES 4096
+
+/* Runs per method (the fastest one counts) */
+#define RUNS 20
+
+
+static uint32_t data[BYTES / 4];
+
+
+/* Host time in nanoseconds */
+static double now (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e9 + ts.tv_nsec);
+}
+
+
+/* The way a buffer was dumped before dbHexdump */
+static void dumpWords (const uint32_t *words, uint32_t count)
+{
+	for (uint32_t i = 0; i < count; i++)
+	{
+		dbprintInt_hex((int32_t)words[i]);
+		if ((i & 3) == 3) dbprintln("");
+		else dbprint(" ");
+	}
+}
+
+
+/* Dump the data with a method and print the cost per byte */
+static void run (bool hexdump, const char *name)
+{
+	double fastest = 0;
+	unsigned long locks = 0;
+	size_t characters = 0;
+
+	for (unsigned int r = 0; r < RUNS; r++)
+	{
+		sim_clearOutput(SIM_USART1);
+		memset(&sim_lock, 0, sizeof(sim_lock));
+
+		double start = now();
+		sim_hold = true;
+		if (hexdump) dbHexdump(data, BYTES);
+		else dumpWords(data, BYTES / 4);
+		dbFlush();
+		sim_hold = false;
+		double time = now() - start;
+
+		if ((r == 0) || (time < fastest)) fastest = time;
+		locks = sim_lock.count;
+		characters = sim_port[SIM_USART1].length;
+	}
+
+	printf("bench_hexdump: %-15s %6.1f ns, %5.2f critical sections and %4.2f characters per byte, %5.1f bytes per us (host)\n",
+	       name, fastest / BYTES, (double)locks / BYTES, (double)characters / BYTES, BYTES * 1000.0 / fastest);
+}
+
+
+int main (void)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+
+	for (uint32_t i = 0; i < (BYTES / 4); i++) data[i] = i * 0x9E3779B9u;
+
+	sim_reset();
+	init.banner = false;
+	dbprint_INIT_config(&init);
+
+	run(true, "dbHexdump");
+	run(false, "dbprintInt_hex");
+
+	return (0);
+}
@@ -0,0 +1,169 @@
+/***************************************************************************//**
+ * @file bench_init.c
+ * @brief Cost of the welcome banner and pin routing of the initialization.
+ * @details
+ *   Prints the characters written by `dbprint_INIT_config` without
+ *   interrupts (synchronously) with and without `init.banner`, and checks
+ *   the pin modes and ROUTE register of every location of USART0, USART1
+ *   and LEUART0 (`DBPRINT_LEUART`) against the pin tables in the README.
+ * @version 7.22
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include <stdio.h>
+#include <string.h>
+#include "debug_dbprint.h"
+#include "sim.h"
+#include "em_gpio.h"
+#include "em_leuart.h"
+
+
+/* Pin of the README table: port (0 - A, ...) and pin, port -1 if there is none */
+typedef struct
+{
+	int port;
+	int pin;
+} pin_t;
+
+/* RX and TX pins of USART0 and USART1 (README, "Alternate locations of pins") */
+static const pin_t readmePins[2][7][2] =
+{
+	{ /* USART0 */
+		{ { 4, 11 }, { 4, 10 } }, /* #0: PE11, PE10 */
+		{ { -1, 0 }, { -1, 0 } }, /* #1: - */
+		{ { 2, 10 }, { -1, 0 } }, /* #2: PC10, - */
+		{ { 4, 12 }, { 4, 13 } }, /* #3: PE12, PE13 */
+		{ { 1, 8 }, { 1, 7 } },   /* #4: PB8, PB7 */
+		{ { 2, 1 }, { 2, 0 } },   /* #5: PC1, PC0 */
+		{ { 2, 1 }, { 2, 0 } }    /* #6: PC1, PC0 */
+	},
+	{ /* USART1 */
+		{ { 2, 1 }, { 2, 0 } },   /* #0: PC1, PC0 */
+		{ { -1, 0 }, { -1, 0 } }, /* #1: - */
+		{ { 3, 6 }, { 3, 7 } },   /* #2: PD6, PD7 */
+		{ { 3, 6 }, { 3, 7 } },   /* #3: PD6, PD7 */
+		{ { 0, 0 }, { 5, 2 } },   /* #4: PA0, PF2 */
+		{ { 2, 2 }, { 2, 1 } },   /* #5: PC2, PC1 */
+		{ { -1, 0 }, { -1, 0 } }  /* #6: - */
+	}
+};
+
+/* RX and TX pins of LEUART0 (README, "Alternate locations of pins") */
+static const pin_t readmeLeuartPins[5][2] =
+{
+	{ { 3, 5 }, { 3, 4 } },   /* #0: PD5, PD4 */
+	{ { 1, 14 }, { 1, 13 } }, /* #1: PB14, PB13 */
+	{ { 4, 15 }, { 4, 14 } }, /* #2: PE15, PE14 */
+	{ { 5, 1 }, { 5, 0 } },   /* #3: PF1, PF0 */
+	{ { 0, 0 }, { 5, 2 } }    /* #4: PA0, PF2 */
+};
+
+
+/* Characters written by a synchronous initialization */
+static size_t initChars (bool banner)
+{
+	static dbprint_t db;
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+
+	sim_reset();
+	memset(&db, 0, sizeof(db));
+	init.interrupts = false;
+	init.banner = banner;
+	dbprint_INIT_config_ctx(&db, &init);
+
+	return (sim_port[SIM_USART1].length);
+}
+
+
+/* Check the pins and routing of a location (port: SIM_USART0, SIM_USART1 or SIM_LEUART0), returns the amount of mismatches */
+static unsigned int checkLocation (unsigned int port, uint8_t location)
+{
+	static dbprint_t db;
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+	const pin_t *rx = (port == SIM_LEUART0) ? &readmeLeuartPins[location][0] : &readmePins[port][location][0];
+	const pin_t *tx = (port == SIM_LEUART0) ? &readmeLeuartPins[location][1] : &readmePins[port][location][1];
+	unsigned int errors = 0;
+	unsigned int used = 0;
+
+	sim_reset();
+	memset(&db, 0, sizeof(db));
+	init.pointer = (port == SIM_USART1) ? USART1 : USART0;
+	if (port == SIM_LEUART0) init.leuart = LEUART0;
+	init.location = location;
+	init.vcom = false;
+	init.interrupts = false;
+	init.banner = false;
+	dbprint_INIT_config_ctx(&db, &init);
+
+	if (port == SIM_LEUART0)
+	{
+		if (sim_leuart.ROUTE != (LEUART_ROUTE_TXPEN | LEUART_ROUTE_RXPEN | ((uint32_t)location << 8))) errors++;
+	}
+	else if (sim_usart[port].ROUTE != (USART_ROUTE_TXPEN | USART_ROUTE_RXPEN | ((uint32_t)location << 8))) errors++;
+	if (rx->port >= 0)
+	{
+		if (sim_pinMode[rx->port][rx->pin] != gpioModeInput) errors++;
+		used++;
+	}
+	if (tx->port >= 0)
+	{
+		if (sim_pinMode[tx->port][tx->pin] != gpioModePushPull) errors++;
+		used++;
+	}
+
+	/* No other pins are configured */
+	for (unsigned int port = 0; port < 6; port++)
+	{
+		for (unsigned int pin = 0; pin < 16; pin++)
+		{
+			if (sim_pinMode[port][pin] != gpioModeDisabled) used--;
+		}
+	}
+	if (used != 0) errors++;
+
+	if (errors) fprintf(stderr, "bench_init: %s location #%u doesn't match the README\n",
+	                    (port == SIM_LEUART0) ? "LEUART0" : (port ? "USART1" : "USART0"), location);
+	return (errors);
+}
+
+
+int main (void)
+{
+	unsigned int errors = 0;
+	size_t banner = initChars(true);
+	size_t fast = initChars(false);
+
+	printf("bench_init: %zu characters written during a synchronous initialization with the banner "
+	       "(%.1f ms at 115200 baud), %zu without\n", banner, banner * 10 * 1000.0 / 115200, fast);
+
+	for (unsigned int usart = 0; usart < 2; usart++)
+	{
+		for (uint8_t location = 0; location < 7; location++) errors += checkLocation(usart, location);
+	}
+	for (uint8_t location = 0; location < 5; location++) errors += checkLocation(SIM_LEUART0, location);
+	printf("bench_init: pins and ROUTE of USART0/1 locations #0 - #6 and LEUART0 locations #0 - #4 %s the README\n",
+	       errors ? "don't match" : "match");
+
+	return ((errors || fast) ? 1 : 0);
+}
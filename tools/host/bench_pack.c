@@ -0,0 +1,117 @@
+/***************************************************************************//**
+ * @file bench_pack.c
+ * @brief Compression ratio and cost per character of `init.compress`.
+ * @details
+ *   The same records are written to an instance with compression (USART1)
+ *   and one without (USART0). The link is saturated: the TX handler only
+ *   runs when a print method waits for room in the TX queue (`sim_hold`),
+ *   so it finds full blocks to compress.
+ *   The captures are written to `<dir>/pack_capture.bin` and
+ *   `<dir>/pack_plain.txt` (`make bench` checks that `dbunpack` turns the
+ *   first into the second).
+ * @version 7.22
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#define _POSIX_C_SOURCE 199309L /* clock_gettime */
+
+#include <stdio.h>
+#include <time.h>
+#include "debug_dbprint.h"
+#include "sim.h"
+
+
+#define ROUNDS 5000
+
+
+static dbprint_t plain;
+static dbprint_t packed;
+
+
+/* Write the records and return the host time in nanoseconds per character */
+static double run (dbprint_t *db, bool compress, USART_TypeDef *usart)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+	dbprint_stats_t stats;
+	struct timespec start, end;
+
+	init.pointer = usart;
+	init.vcom = false;
+	init.banner = false;
+	init.compress = compress;
+	dbprint_INIT_config_ctx(db, &init);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	sim_hold = true;
+	for (int32_t r = 0; r < ROUNDS; r++)
+	{
+		dbinfoInt_ctx(db, "Battery voltage: ", 3300 - (r & 255), " mV");
+		dbwarnInt_hex_ctx(db, "Register STATUS = ", 0x1234 + r * 7, "");
+	}
+	dbFlush_ctx(db);
+	sim_hold = false;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	dbprint_stats_ctx(db, &stats);
+	return (((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / stats.queued);
+}
+
+
+/* Write the captured output of a port to a file */
+static int save (const char *dir, const char *name, unsigned int port)
+{
+	char path[512];
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	FILE *file = fopen(path, "wb");
+	if (file == NULL) return (1);
+	fwrite(sim_port[port].output, 1, sim_port[port].length, file);
+	return (fclose(file) != 0);
+}
+
+
+int main (int argc, char **argv)
+{
+	dbprint_stats_t stats;
+	const char *dir = (argc > 1) ? argv[1] : ".";
+
+	sim_reset();
+
+	double plainCost = run(&plain, false, USART0);
+	double packedCost = run(&packed, true, USART1);
+
+	dbprint_stats_ctx(&packed, &stats);
+	printf("bench_pack: %lu characters in %lu frames of %lu bytes (%.1f %% of the text)\n",
+	       (unsigned long)stats.packed, (unsigned long)stats.frames, (unsigned long)stats.sent,
+	       100.0 * stats.sent / stats.packed);
+	printf("bench_pack: %.1f ns per character without compression, %.1f ns with compression (host)\n",
+	       plainCost, packedCost);
+
+	if (save(dir, "pack_capture.bin", SIM_USART1) || save(dir, "pack_plain.txt", SIM_USART0))
+	{
+		fprintf(stderr, "bench_pack: can't write the captures to %s\n", dir);
+		return (1);
+	}
+
+	return (0);
+}
@@ -0,0 +1,184 @@
+/***************************************************************************//**
+ * @file bench_strlen.c
+ * @brief Cost of `string_length` and `dbprintn` versus a byte loop (up to v7.19).
+ * @details
+ *   dbprint.c is included so the static `string_length` is called directly.
+ *   For strings of several lengths (at every alignment) the host time is
+ *   printed of:
+ *     - The length: a byte loop versus `string_length` (one word at a time).
+ *     - A print method (the producer outruns the TX line, `sim_hold`): the
+ *       byte loop followed by `dbprintn` (what `dbprint` did up to v7.19),
+ *       `dbprint` (`string_length`) and `dbprintn` (length already known).
+ *   The lengths have to be the same.
+ * @version 7.22
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+
+
+#define _POSIX_C_SOURCE 199309L /* clock_gettime */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "dbprint.c" /* string_length */
+#include "sim.h"
+
+
+/* Lengths compared */
+static const uint32_t lengths[] = { 4, 16, 64, 200 };
+
+/* Calls per length (length) and per print method (print, in batches that fit in the TX queue) */
+#define CALLS 1000000
+#define PRINTS 20000
+
+/* Runs per length measurement (the fastest one counts) */
+#define RUNS 5
+
+
+/* Strings at every alignment (4 bytes of alignment + NULL) */
+static char strings[4][208];
+
+/* Keeps the results alive */
+static volatile uint32_t sink;
+
+static unsigned int mismatches;
+
+
+/* Host time in nanoseconds */
+static double now (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e9 + ts.tv_nsec);
+}
+
+
+/* The length of a string up to v7.19 */
+__attribute__((noinline)) static uint32_t byte_length (const char *string)
+{
+	uint32_t length = 0;
+	while (string[length] != 0) length++;
+	return (length);
+}
+
+
+/* Length with a method: 0 - byte loop, 1 - string_length, returns the host time in nanoseconds per call */
+static double timeLength (int method, uint32_t length)
+{
+	double fastest = 0;
+
+	for (int r = 0; r < RUNS; r++)
+	{
+		double start = now();
+		for (uint32_t i = 0; i < CALLS; i++)
+		{
+			const char *string = &strings[i & 3][i & 3];
+			sink = (method == 0) ? byte_length(string) : string_length(string);
+		}
+		double time = (now() - start) / CALLS;
+		if ((r == 0) || (time < fastest)) fastest = time;
+	}
+
+	for (int a = 0; a < 4; a++)
+	{
+		if ((byte_length(&strings[a][a]) != length) || (string_length(&strings[a][a]) != length)) mismatches++;
+	}
+
+	return (fastest);
+}
+
+
+/* Print with a method: 0 - byte loop + dbprintn, 1 - dbprint, 2 - dbprintn, returns the host time in nanoseconds per call */
+static double timePrint (int method, uint32_t length)
+{
+	uint32_t batch = (DBPRINT_TX_BUFFER_SIZE - 1) / length; /* Calls that fit in the TX queue */
+	double fastest = 0;
+
+	for (uint32_t b = 0; b < (PRINTS / batch); b++)
+	{
+		/* Nothing is transmitted during the calls (the fastest batch counts) */
+		sim_hold = true;
+		double start = now();
+		for (uint32_t i = 0; i < batch; i++)
+		{
+			char *string = &strings[i & 3][i & 3];
+			if (method == 0) dbprintn(string, byte_length(string));
+			else if (method == 1) dbprint(string);
+			else dbprintn(string, length);
+		}
+		double time = (now() - start) / batch;
+		sim_hold = false;
+		dbFlush();
+
+		if (sim_port[SIM_USART1].length != (batch * length)) mismatches++;
+		sim_clearOutput(SIM_USART1);
+		if ((b == 0) || (time < fastest)) fastest = time;
+	}
+
+	return (fastest);
+}
+
+
+int main (void)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+
+	sim_reset();
+	sim_sleepLimit = 0; /* Every batch is flushed */
+	init.banner = false;
+	dbprint_INIT_config(&init);
+
+	printf("bench_strlen: %-6s %20s %20s\n", "length", "byte loop", "string_length");
+	for (unsigned int l = 0; l < (sizeof(lengths) / sizeof(lengths[0])); l++)
+	{
+		for (int a = 0; a < 4; a++)
+		{
+			memset(&strings[a][a], 'a', lengths[l]);
+			strings[a][a + lengths[l]] = '\0';
+		}
+
+		printf("bench_strlen: %-6lu %17.1f ns %17.1f ns (host)\n", (unsigned long)lengths[l],
+		       timeLength(0, lengths[l]), timeLength(1, lengths[l]));
+	}
+
+	printf("bench_strlen: %-6s %20s %20s %20s\n", "length", "byte loop + dbprintn", "dbprint", "dbprintn");
+	for (unsigned int l = 0; l < (sizeof(lengths) / sizeof(lengths[0])); l++)
+	{
+		for (int a = 0; a < 4; a++)
+		{
+			memset(&strings[a][a], 'a', lengths[l]);
+			strings[a][a + lengths[l]] = '\0';
+		}
+
+		double loop = timePrint(0, lengths[l]);
+		double scan = timePrint(1, lengths[l]);
+		double known = timePrint(2, lengths[l]);
+		printf("bench_strlen: %-6lu %17.1f ns %17.1f ns %17.1f ns (host)\n", (unsigned long)lengths[l], loop, scan, known);
+	}
+
+	if (mismatches) fprintf(stderr, "bench_strlen: %u mismatch(es)\n", mismatches);
+
+	return (mismatches != 0);
+}
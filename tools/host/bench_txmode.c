@@ -0,0 +1,93 @@
+/***************************************************************************//**
+ * @file bench_txmode.c
+ * @brief TX interrupts per character of `TX_COMPLETE` and `TX_BUFFER_LEVEL`.
+ * @details
+ *   The same records are written using the TXC interrupt and using the TXBL
+ *   interrupt, the outputs have to be identical.
+ * @version 7.2
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include <stdio.h>
+#include <string.h>
+#include "debug_dbprint.h"
+#include "sim.h"
+
+
+#define ROUNDS 1000
+
+
+/* Output of TX_COMPLETE (compared with the one of TX_BUFFER_LEVEL) */
+static char first[ROUNDS * 128];
+static size_t firstLength;
+
+
+/* Write the records and print the TX interrupts per character, returns "false" if the output differs */
+static bool run (dbprint_txmode_t txMode, const char *name)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+
+	sim_reset();
+	init.txMode = txMode;
+	dbprint_INIT_config(&init);
+	sim_service();
+	sim_clearOutput(SIM_USART1); /* Welcome banner */
+	unsigned long interrupts = sim_port[SIM_USART1].txInterrupts;
+
+	for (int32_t r = 0; r < ROUNDS; r++)
+	{
+		dbinfoInt("Battery voltage: ", 3300 - (r & 255), " mV");
+		dbwarnInt_hex("Register STATUS = ", 0x1234 + r * 7, "");
+		dbprintln("Odd length");
+	}
+	sim_service();
+
+	size_t length = sim_port[SIM_USART1].length;
+	interrupts = sim_port[SIM_USART1].txInterrupts - interrupts;
+	printf("bench_txmode: %-15s %lu characters, %lu TX interrupts (%.2f per character)\n", name,
+	       (unsigned long)length, interrupts, (double)interrupts / length);
+
+	if (txMode == TX_COMPLETE)
+	{
+		firstLength = (length < sizeof(first)) ? length : sizeof(first);
+		memcpy(first, sim_port[SIM_USART1].output, firstLength);
+		return (true);
+	}
+
+	return ((length == firstLength) && (memcmp(sim_port[SIM_USART1].output, first, length) == 0));
+}
+
+
+int main (void)
+{
+	run(TX_COMPLETE, "TX_COMPLETE");
+
+	if (!run(TX_BUFFER_LEVEL, "TX_BUFFER_LEVEL"))
+	{
+		fprintf(stderr, "bench_txmode: the outputs differ\n");
+		return (1);
+	}
+
+	return (0);
+}
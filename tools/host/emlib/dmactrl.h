@@ -0,0 +1,9 @@
+/* Host stub of the DMA control block of the Silicon Labs examples */
+#ifndef DMACTRL_H
+#define DMACTRL_H
+
+#include "em_dma.h"
+
+extern DMA_DESCRIPTOR_TypeDef dmaControlBlock[];
+
+#endif /* DMACTRL_H */
@@ -0,0 +1,31 @@
+/* Host stub of emlib's em_cmu.h */
+#ifndef EM_CMU_H
+#define EM_CMU_H
+
+#include "em_device.h"
+
+typedef enum
+{
+	cmuClock_HFPER,
+	cmuClock_GPIO,
+	cmuClock_USART0,
+	cmuClock_USART1,
+	cmuClock_DMA,
+	cmuClock_CORELE,
+	cmuClock_LFB,
+	cmuClock_LEUART0,
+	SIM_CLOCKS
+} CMU_Clock_TypeDef;
+
+typedef enum
+{
+	cmuSelect_LFXO,
+	cmuSelect_LFRCO,
+	cmuSelect_CORELEDIV2
+} CMU_Select_TypeDef;
+
+void CMU_ClockEnable (CMU_Clock_TypeDef clock, bool enable);
+void CMU_ClockSelectSet (CMU_Clock_TypeDef clock, CMU_Select_TypeDef ref);
+uint32_t CMU_ClockFreqGet (CMU_Clock_TypeDef clock);
+
+#endif /* EM_CMU_H */
@@ -0,0 +1,17 @@
+/* Host stub of emlib's em_core.h: the critical sections are implemented by the host model (sim.c) */
+#ifndef EM_CORE_H
+#define EM_CORE_H
+
+#include "em_device.h"
+
+typedef uint32_t CORE_irqState_t;
+
+#define CORE_DECLARE_IRQ_STATE CORE_irqState_t irqState
+#define CORE_ENTER_CRITICAL()  irqState = CORE_EnterCritical()
+#define CORE_EXIT_CRITICAL()   CORE_ExitCritical(irqState)
+
+CORE_irqState_t CORE_EnterCritical (void);
+void CORE_ExitCritical (CORE_irqState_t irqState);
+bool CORE_IrqIsBlocked (IRQn_Type irq);
+
+#endif /* EM_CORE_H */
@@ -0,0 +1,68 @@
+/* Host stub of the EFM32HG device header (only what dbprint and the host model use) */
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* USART registers (only the ones dbprint uses, not in the hardware order) */
+typedef struct
+{
+	volatile uint32_t CTRL;
+	volatile uint32_t CMD;
+	volatile uint32_t STATUS;
+	volatile uint32_t IF;
+	volatile uint32_t IEN;
+	volatile uint32_t ROUTE;
+	volatile uint32_t TXDATA;
+	volatile uint32_t RXDATA;
+} USART_TypeDef;
+
+/* LEUART registers (only the ones dbprint uses) */
+typedef struct
+{
+	volatile uint32_t CTRL;
+	volatile uint32_t CMD;
+	volatile uint32_t STATUS;
+	volatile uint32_t IF;
+	volatile uint32_t IEN;
+	volatile uint32_t ROUTE;
+	volatile uint32_t TXDATA;
+	volatile uint32_t RXDATA;
+} LEUART_TypeDef;
+
+/* DMA registers (only the ones dbprint uses) */
+typedef struct
+{
+	volatile uint32_t STATUS;
+} DMA_TypeDef;
+
+extern USART_TypeDef sim_usart[2];
+extern LEUART_TypeDef sim_leuart;
+extern DMA_TypeDef sim_dma;
+
+#define USART0  (&sim_usart[0])
+#define USART1  (&sim_usart[1])
+#define LEUART0 (&sim_leuart)
+#define DMA     (&sim_dma)
+
+typedef enum
+{
+	DMA_IRQn,
+	GPIO_EVEN_IRQn,
+	USART0_RX_IRQn,
+	USART0_TX_IRQn,
+	USART1_RX_IRQn,
+	USART1_TX_IRQn,
+	LEUART0_IRQn,
+	GPIO_ODD_IRQn,
+	SIM_IRQS
+} IRQn_Type;
+
+void NVIC_EnableIRQ (IRQn_Type irq);
+void NVIC_DisableIRQ (IRQn_Type irq);
+void NVIC_ClearPendingIRQ (IRQn_Type irq);
+void NVIC_SetPendingIRQ (IRQn_Type irq);
+
+#endif /* EM_DEVICE_H */
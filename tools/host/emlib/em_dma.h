@@ -0,0 +1,58 @@
+/* Host stub of emlib's em_dma.h (transfers complete when the host model delivers interrupts) */
+#ifndef EM_DMA_H
+#define EM_DMA_H
+
+#include "em_device.h"
+
+#define DMA_STATUS_EN       0x1
+#define DMAREQ_USART0_TXBL  0x0C0001
+#define DMAREQ_USART1_TXBL  0x0D0001
+#define DMAREQ_LEUART0_TXBL 0x100001
+
+typedef void (*DMA_FuncPtr_TypeDef) (unsigned int channel, bool primary, void *user);
+
+typedef struct
+{
+	DMA_FuncPtr_TypeDef cbFunc;
+	void *userPtr;
+	uint8_t primary;
+} DMA_CB_TypeDef;
+
+typedef struct
+{
+	bool highPri;
+	bool enableInt;
+	uint32_t select;
+	DMA_CB_TypeDef *cb;
+} DMA_CfgChannel_TypeDef;
+
+typedef enum { dmaDataInc1, dmaDataInc2, dmaDataInc4, dmaDataIncNone } DMA_DataInc_TypeDef;
+typedef enum { dmaDataSize1, dmaDataSize2, dmaDataSize4 } DMA_DataSize_TypeDef;
+typedef enum { dmaArbitrate1 } DMA_ArbiterConfig_TypeDef;
+
+typedef struct
+{
+	DMA_DataInc_TypeDef dstInc;
+	DMA_DataInc_TypeDef srcInc;
+	DMA_DataSize_TypeDef size;
+	DMA_ArbiterConfig_TypeDef arbRate;
+	uint8_t hprot;
+} DMA_CfgDescr_TypeDef;
+
+typedef struct
+{
+	uint32_t word[4];
+} DMA_DESCRIPTOR_TypeDef;
+
+typedef struct
+{
+	uint8_t hprot;
+	DMA_DESCRIPTOR_TypeDef *controlBlock;
+} DMA_Init_TypeDef;
+
+void DMA_Init (DMA_Init_TypeDef *init);
+void DMA_CfgChannel (unsigned int channel, DMA_CfgChannel_TypeDef *cfg);
+void DMA_CfgDescr (unsigned int channel, bool primary, DMA_CfgDescr_TypeDef *cfg);
+void DMA_ActivateBasic (unsigned int channel, bool primary, bool useBurst, void *dst, const void *src, unsigned int nMinus1);
+
+#endif /* EM_DMA_H */
@@ -0,0 +1,7 @@
+/* Host stub of emlib's em_emu.h: sleeping in EM1 lets the host model deliver interrupts and advance time */
+#ifndef EM_EMU_H
+#define EM_EMU_H
+
+void EMU_EnterEM1 (void);
+
+#endif /* EM_EMU_H */
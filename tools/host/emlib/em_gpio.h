@@ -0,0 +1,32 @@
+/* Host stub of emlib's em_gpio.h (the pin modes are recorded by the host model) */
+#ifndef EM_GPIO_H
+#define EM_GPIO_H
+
+#include "em_device.h"
+
+typedef enum
+{
+	gpioPortA,
+	gpioPortB,
+	gpioPortC,
+	gpioPortD,
+	gpioPortE,
+	gpioPortF
+} GPIO_Port_TypeDef;
+
+typedef enum
+{
+	gpioModeDisabled,
+	gpioModeInput,
+	gpioModeInputPull,
+	gpioModePushPull
+} GPIO_Mode_TypeDef;
+
+void GPIO_PinModeSet (GPIO_Port_TypeDef port, unsigned int pin, GPIO_Mode_TypeDef mode, unsigned int out);
+void GPIO_PinOutSet (GPIO_Port_TypeDef port, unsigned int pin);
+void GPIO_IntConfig (GPIO_Port_TypeDef port, unsigned int pin, bool risingEdge, bool fallingEdge, bool enable);
+void GPIO_IntClear (uint32_t flags);
+void GPIO_IntEnable (uint32_t flags);
+void GPIO_IntDisable (uint32_t flags);
+
+#endif /* EM_GPIO_H */
@@ -0,0 +1,60 @@
+/* Host stub of emlib's em_leuart.h (the peripheral is modelled in sim.c) */
+#ifndef EM_LEUART_H
+#define EM_LEUART_H
+
+#include "em_device.h"
+
+#define LEUART_IF_TXC               (1u << 0)
+#define LEUART_IF_TXBL              (1u << 1)
+#define LEUART_IF_RXDATAV           (1u << 2)
+#define LEUART_IF_RXOF              (1u << 3)
+#define LEUART_IEN_TXC              LEUART_IF_TXC
+#define LEUART_IEN_TXBL             LEUART_IF_TXBL
+#define LEUART_IEN_RXDATAV          LEUART_IF_RXDATAV
+
+#define LEUART_STATUS_TXC           (1u << 4)
+#define LEUART_STATUS_TXBL          (1u << 5)
+#define LEUART_STATUS_RXDATAV       (1u << 6)
+
+#define LEUART_CTRL_TXDMAWU         (1u << 13)
+
+#define LEUART_ROUTE_RXPEN          (1u << 0)
+#define LEUART_ROUTE_TXPEN          (1u << 1)
+#define LEUART_ROUTE_LOCATION_LOC0  (0u << 8)
+#define LEUART_ROUTE_LOCATION_LOC1  (1u << 8)
+#define LEUART_ROUTE_LOCATION_LOC2  (2u << 8)
+#define LEUART_ROUTE_LOCATION_LOC3  (3u << 8)
+#define LEUART_ROUTE_LOCATION_LOC4  (4u << 8)
+
+typedef enum { leuartDisable, leuartEnableRx, leuartEnableTx, leuartEnable } LEUART_Enable_TypeDef;
+typedef enum { leuartDatabits8 = 8 } LEUART_Databits_TypeDef;
+typedef enum { leuartNoParity } LEUART_Parity_TypeDef;
+typedef enum { leuartStopbits1 } LEUART_Stopbits_TypeDef;
+
+typedef struct
+{
+	LEUART_Enable_TypeDef enable;
+	uint32_t refFreq;
+	uint32_t baudrate;
+	LEUART_Databits_TypeDef databits;
+	LEUART_Parity_TypeDef parity;
+	LEUART_Stopbits_TypeDef stopbits;
+} LEUART_Init_TypeDef;
+
+#define LEUART_INIT_DEFAULT { leuartEnable, 0, 9600, leuartDatabits8, leuartNoParity, leuartStopbits1 }
+
+void LEUART_Init (LEUART_TypeDef *leuart, const LEUART_Init_TypeDef *init);
+void LEUART_Tx (LEUART_TypeDef *leuart, uint8_t data);
+uint8_t LEUART_Rx (LEUART_TypeDef *leuart);
+void LEUART_IntSet (LEUART_TypeDef *leuart, uint32_t flags);
+void LEUART_IntEnable (LEUART_TypeDef *leuart, uint32_t flags);
+
+static inline void LEUART_Enable (LEUART_TypeDef *leuart, LEUART_Enable_TypeDef enable) { (void)leuart; (void)enable; }
+static inline void LEUART_IntDisable (LEUART_TypeDef *leuart, uint32_t flags) { leuart->IEN &= ~flags; }
+/* TXBL follows the level of the TX buffer, it can't be cleared */
+static inline void LEUART_IntClear (LEUART_TypeDef *leuart, uint32_t flags) { leuart->IF &= ~(flags & ~LEUART_IF_TXBL); }
+static inline uint32_t LEUART_IntGet (LEUART_TypeDef *leuart) { return (leuart->IF); }
+static inline uint32_t LEUART_IntGetEnabled (LEUART_TypeDef *leuart) { return (leuart->IF & leuart->IEN); }
+static inline void LEUART_TxDmaInEM2Enable (LEUART_TypeDef *leuart, bool enable) { if (enable) leuart->CTRL |= LEUART_CTRL_TXDMAWU; else leuart->CTRL &= ~LEUART_CTRL_TXDMAWU; }
+
+#endif /* EM_LEUART_H */
@@ -0,0 +1,69 @@
+/* Host stub of emlib's em_usart.h (the peripheral is modelled in sim.c) */
+#ifndef EM_USART_H
+#define EM_USART_H
+
+#include "em_device.h"
+
+#define USART_IF_TXC                 (1u << 0)
+#define USART_IF_TXBL                (1u << 1)
+#define USART_IF_RXDATAV             (1u << 2)
+#define USART_IF_RXOF                (1u << 5)
+#define USART_IEN_TXC                USART_IF_TXC
+#define USART_IEN_TXBL               USART_IF_TXBL
+#define USART_IEN_RXDATAV            USART_IF_RXDATAV
+#define USART_IFS_TXC                USART_IF_TXC
+
+#define USART_STATUS_TXC             (1u << 5)
+#define USART_STATUS_TXBL            (1u << 6)
+#define USART_STATUS_RXDATAV         (1u << 7)
+
+#define USART_ROUTE_RXPEN            (1u << 0)
+#define USART_ROUTE_TXPEN            (1u << 1)
+#define USART_ROUTE_LOCATION_LOC0    (0u << 8)
+#define USART_ROUTE_LOCATION_LOC1    (1u << 8)
+#define USART_ROUTE_LOCATION_LOC2    (2u << 8)
+#define USART_ROUTE_LOCATION_LOC3    (3u << 8)
+#define USART_ROUTE_LOCATION_LOC4    (4u << 8)
+#define USART_ROUTE_LOCATION_LOC5    (5u << 8)
+#define USART_ROUTE_LOCATION_LOC6    (6u << 8)
+#define USART_ROUTE_LOCATION_DEFAULT USART_ROUTE_LOCATION_LOC0
+#define _USART_ROUTE_LOCATION_MASK   (7u << 8)
+
+typedef enum { usartDisable, usartEnableRx, usartEnableTx, usartEnable } USART_Enable_TypeDef;
+typedef enum { usartOVS16, usartOVS8, usartOVS6, usartOVS4 } USART_OVS_TypeDef;
+typedef enum { usartDatabits8 = 8 } USART_Databits_TypeDef;
+typedef enum { usartNoParity } USART_Parity_TypeDef;
+typedef enum { usartStopbits1 } USART_Stopbits_TypeDef;
+
+typedef struct
+{
+	USART_Enable_TypeDef enable;
+	uint32_t refFreq;
+	uint32_t baudrate;
+	USART_OVS_TypeDef oversampling;
+	USART_Databits_TypeDef databits;
+	USART_Parity_TypeDef parity;
+	USART_Stopbits_TypeDef stopbits;
+	bool mvdis;
+	bool prsRxEnable;
+	uint32_t prsRxCh;
+	bool autoCsEnable;
+} USART_InitAsync_TypeDef;
+
+#define USART_INITASYNC_DEFAULT { usartEnable, 0, 115200, usartOVS16, usartDatabits8, usartNoParity, usartStopbits1, false, false, 0, false }
+
+void USART_InitAsync (USART_TypeDef *usart, const USART_InitAsync_TypeDef *init);
+void USART_Enable (USART_TypeDef *usart, USART_Enable_TypeDef enable);
+void USART_Tx (USART_TypeDef *usart, uint8_t data);
+void USART_TxDouble (USART_TypeDef *usart, uint16_t data);
+uint8_t USART_Rx (USART_TypeDef *usart);
+void USART_IntSet (USART_TypeDef *usart, uint32_t flags);
+void USART_IntEnable (USART_TypeDef *usart, uint32_t flags);
+
+static inline void USART_IntDisable (USART_TypeDef *usart, uint32_t flags) { usart->IEN &= ~flags; }
+/* TXBL follows the level of the TX buffer, it can't be cleared */
+static inline void USART_IntClear (USART_TypeDef *usart, uint32_t flags) { usart->IF &= ~(flags & ~USART_IF_TXBL); }
+static inline uint32_t USART_IntGet (USART_TypeDef *usart) { return (usart->IF); }
+static inline uint32_t USART_IntGetEnabled (USART_TypeDef *usart) { return (usart->IF & usart->IEN); }
+
+#endif /* EM_USART_H */
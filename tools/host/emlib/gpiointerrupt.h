@@ -0,0 +1,12 @@
+/* Host stub of emdrv's gpiointerrupt.h (the callbacks are called by sim_rxEdge) */
+#ifndef GPIOINTERRUPT_H
+#define GPIOINTERRUPT_H
+
+#include <stdint.h>
+
+typedef void (*GPIOINT_IrqCallbackPtr_t) (uint8_t pin);
+
+void GPIOINT_Init (void);
+void GPIOINT_CallbackRegister (uint8_t pin, GPIOINT_IrqCallbackPtr_t callbackPtr);
+
+#endif /* GPIOINTERRUPT_H */
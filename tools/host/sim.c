@@ -0,0 +1,699 @@
+/***************************************************************************//**
+ * @file sim.c
+ * @brief Host model of the EFM32HG peripherals used by "DeBugPrint".
+ * @details
+ *   Implements the emlib stubs in `emlib/`, see `sim.h`. The TX lines are
+ *   instant (a written character is captured and the TX flags are set again
+ *   right away) unless `sim_stall` is set. Interrupt handlers only run when
+ *   interrupts aren't masked and no other handler is running (one priority
+ *   level).
+ * @version 7.1
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#define _POSIX_C_SOURCE 199309L /* clock_gettime */
+
+#include <stdio.h>          /* fprintf */
+#include <stdlib.h>         /* exit */
+#include <string.h>         /* memset, memcpy */
+#include <time.h>           /* clock_gettime */
+#include "sim.h"
+#include "em_core.h"
+#include "em_emu.h"
+#include "em_cmu.h"
+#include "em_gpio.h"
+#include "em_usart.h"
+#include "em_leuart.h"
+#include "em_dma.h"
+#include "dmactrl.h"
+#include "gpiointerrupt.h"
+
+
+/* Interrupt handlers of dbprint.c (weak: not every test links them) */
+void USART0_RX_IRQHandler (void) __attribute__((weak));
+void USART0_TX_IRQHandler (void) __attribute__((weak));
+void USART1_RX_IRQHandler (void) __attribute__((weak));
+void USART1_TX_IRQHandler (void) __attribute__((weak));
+void LEUART0_IRQHandler (void) __attribute__((weak));
+
+/* Amount of DMA channels */
+#define SIM_DMA_CHANNELS 8
+
+
+/* Registers and control block */
+USART_TypeDef sim_usart[2];
+LEUART_TypeDef sim_leuart;
+DMA_TypeDef sim_dma;
+DMA_DESCRIPTOR_TypeDef dmaControlBlock[SIM_DMA_CHANNELS * 2];
+
+/* Model state, see sim.h */
+sim_port_t sim_port[SIM_PORTS];
+volatile uint32_t sim_time;
+uint32_t sim_sleepTicks;
+uint32_t sim_exitTicks;
+unsigned long sim_sleeps;
+unsigned long sim_sleepLimit;
+bool sim_stall;
+bool sim_hold;
+void (*sim_preempt) (void);
+unsigned long sim_preemptAt;
+unsigned long sim_exits;
+sim_lock_t sim_lock;
+uint8_t sim_pinMode[6][16];
+bool sim_clock[SIM_CLOCKS];
+
+/* Core state */
+static uint32_t primask;
+static unsigned int isrDepth;
+static uint64_t lockStart;
+static bool nvicEnabled[SIM_IRQS];
+static bool nvicPending[SIM_IRQS];
+
+/* GPIO interrupts */
+static uint32_t gpioEnabled;
+static GPIOINT_IrqCallbackPtr_t gpioCallback[16];
+
+/* The core slept: interrupts are delivered even if "sim_hold" is set */
+static bool woken;
+
+/* Ports that lost characters while the TX lines were stalled */
+static bool wedged[SIM_PORTS];
+
+/* DMA channels */
+static struct
+{
+	DMA_CB_TypeDef *cb;
+	bool active;
+	bool primary;
+	volatile uint32_t *dst;
+	const uint8_t *src;
+	unsigned int length;
+} dmaChannel[SIM_DMA_CHANNELS];
+
+
+/* Host time in nanoseconds */
+static uint64_t now (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+
+
+/* Run an interrupt handler (interrupts of the same priority are blocked meanwhile) */
+static void isr (void (*handler) (void))
+{
+	isrDepth++;
+	handler();
+	isrDepth--;
+}
+
+
+/* Port of a data register, -1 if it's none */
+static int portOf (volatile uint32_t *txdata)
+{
+	if (txdata == &sim_usart[0].TXDATA) return (SIM_USART0);
+	if (txdata == &sim_usart[1].TXDATA) return (SIM_USART1);
+	if (txdata == &sim_leuart.TXDATA) return (SIM_LEUART0);
+	return (-1);
+}
+
+
+/* Transmit a character: captured right away (or lost when the line is stalled) */
+static void transmit (unsigned int port, uint8_t data)
+{
+	sim_port_t *p = &sim_port[port];
+	volatile uint32_t *status, *flags;
+	uint32_t txFlags, txStatus;
+	bool clocked, routed;
+
+	if (port == SIM_LEUART0)
+	{
+		status = &sim_leuart.STATUS;
+		flags = &sim_leuart.IF;
+		txFlags = LEUART_IF_TXC | LEUART_IF_TXBL;
+		txStatus = LEUART_STATUS_TXC | LEUART_STATUS_TXBL;
+		clocked = sim_clock[cmuClock_LEUART0];
+		routed = sim_leuart.ROUTE & LEUART_ROUTE_TXPEN;
+	}
+	else
+	{
+		status = &sim_usart[port].STATUS;
+		flags = &sim_usart[port].IF;
+		txFlags = USART_IF_TXC | USART_IF_TXBL;
+		txStatus = USART_STATUS_TXC | USART_STATUS_TXBL;
+		clocked = sim_clock[port == SIM_USART0 ? cmuClock_USART0 : cmuClock_USART1];
+		routed = sim_usart[port].ROUTE & USART_ROUTE_TXPEN;
+	}
+
+	if (sim_stall)
+	{
+		p->lost++;
+		wedged[port] = true;
+		*status &= ~txStatus;
+		*flags &= ~txFlags;
+		return;
+	}
+
+	if (!clocked || !routed) p->gatedWrites++;
+	if (p->length < SIM_OUTPUT_SIZE) p->output[p->length++] = (char)data;
+	*status |= txStatus;
+	*flags |= txFlags;
+}
+
+
+/* The TX lines work again: the TX buffers of the ports that were stalled are empty */
+static void unwedge (void)
+{
+	for (unsigned int port = 0; port < SIM_PORTS; port++)
+	{
+		if (!wedged[port]) continue;
+		wedged[port] = false;
+
+		if (port == SIM_LEUART0)
+		{
+			sim_leuart.STATUS |= LEUART_STATUS_TXC | LEUART_STATUS_TXBL;
+			sim_leuart.IF |= LEUART_IF_TXC | LEUART_IF_TXBL;
+		}
+		else
+		{
+			sim_usart[port].STATUS |= USART_STATUS_TXC | USART_STATUS_TXBL;
+			sim_usart[port].IF |= USART_IF_TXC | USART_IF_TXBL;
+		}
+	}
+}
+
+
+/* Complete the active DMA transfers */
+static bool dmaService (void)
+{
+	bool serviced = false;
+
+	for (unsigned int ch = 0; ch < SIM_DMA_CHANNELS; ch++)
+	{
+		if (!dmaChannel[ch].active) continue;
+
+		int port = portOf(dmaChannel[ch].dst);
+		for (unsigned int i = 0; i < dmaChannel[ch].length; i++)
+		{
+			if (port >= 0)
+			{
+				transmit((unsigned int)port, dmaChannel[ch].src[i]);
+				sim_port[port].dmaBytes++;
+			}
+		}
+		dmaChannel[ch].active = false;
+		serviced = true;
+
+		if (port >= 0) sim_port[port].dmaInterrupts++;
+		if ((dmaChannel[ch].cb != NULL) && (dmaChannel[ch].cb->cbFunc != NULL))
+		{
+			isrDepth++;
+			dmaChannel[ch].cb->cbFunc(ch, dmaChannel[ch].primary, dmaChannel[ch].cb->userPtr);
+			isrDepth--;
+		}
+	}
+
+	return (serviced);
+}
+
+
+/* Deliver the pending interrupts of a USART */
+static bool usartService (unsigned int n)
+{
+	USART_TypeDef *usart = &sim_usart[n];
+	IRQn_Type rxIRQn = (n == 0) ? USART0_RX_IRQn : USART1_RX_IRQn;
+	IRQn_Type txIRQn = (n == 0) ? USART0_TX_IRQn : USART1_TX_IRQn;
+	void (*rxHandler) (void) = (n == 0) ? USART0_RX_IRQHandler : USART1_RX_IRQHandler;
+	void (*txHandler) (void) = (n == 0) ? USART0_TX_IRQHandler : USART1_TX_IRQHandler;
+	bool serviced = false;
+
+	if (nvicEnabled[rxIRQn] && (rxHandler != NULL) &&
+	    ((usart->IF & usart->IEN & (USART_IF_RXDATAV | USART_IF_RXOF)) || nvicPending[rxIRQn]))
+	{
+		nvicPending[rxIRQn] = false;
+		sim_port[n].rxInterrupts++;
+		isr(rxHandler);
+		serviced = true;
+	}
+	if (!sim_stall && nvicEnabled[txIRQn] && (txHandler != NULL) &&
+	    ((usart->IF & usart->IEN & (USART_IF_TXC | USART_IF_TXBL)) || nvicPending[txIRQn]))
+	{
+		nvicPending[txIRQn] = false;
+		sim_port[n].txInterrupts++;
+		isr(txHandler);
+		serviced = true;
+	}
+
+	return (serviced);
+}
+
+
+/* Deliver the pending interrupts of the LEUART */
+static bool leuartService (void)
+{
+	uint32_t mask = LEUART_IF_RXDATAV | LEUART_IF_RXOF;
+
+	if (!sim_stall) mask |= LEUART_IF_TXC | LEUART_IF_TXBL;
+
+	if (nvicEnabled[LEUART0_IRQn] && (LEUART0_IRQHandler != NULL) &&
+	    ((sim_leuart.IF & sim_leuart.IEN & mask) || nvicPending[LEUART0_IRQn]))
+	{
+		nvicPending[LEUART0_IRQn] = false;
+		if (sim_leuart.IF & sim_leuart.IEN & (LEUART_IF_TXC | LEUART_IF_TXBL)) sim_port[SIM_LEUART0].txInterrupts++;
+		else sim_port[SIM_LEUART0].rxInterrupts++;
+		isr(LEUART0_IRQHandler);
+		return (true);
+	}
+
+	return (false);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Deliver the pending interrupts (nothing happens while interrupts are
+ *   masked, in an interrupt handler or while `sim_hold` is set and the core
+ *   didn't sleep).
+ *****************************************************************************/
+void sim_service (void)
+{
+	bool serviced;
+
+	if (!sim_stall) unwedge();
+	if (primask || (isrDepth > 0) || (sim_hold && !woken)) return;
+	woken = false;
+
+	do
+	{
+		serviced = usartService(0);
+		serviced |= usartService(1);
+		serviced |= leuartService();
+		if (!sim_stall && nvicEnabled[DMA_IRQn]) serviced |= dmaService();
+	} while (serviced);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Reset the model (registers, interrupts, captured output and settings).
+ *****************************************************************************/
+void sim_reset (void)
+{
+	memset(sim_usart, 0, sizeof(sim_usart));
+	memset(&sim_leuart, 0, sizeof(sim_leuart));
+	memset(&sim_dma, 0, sizeof(sim_dma));
+	memset(sim_port, 0, sizeof(sim_port));
+	memset(&sim_lock, 0, sizeof(sim_lock));
+	memset(sim_pinMode, 0, sizeof(sim_pinMode));
+	memset(sim_clock, 0, sizeof(sim_clock));
+	memset(nvicEnabled, 0, sizeof(nvicEnabled));
+	memset(nvicPending, 0, sizeof(nvicPending));
+	memset(gpioCallback, 0, sizeof(gpioCallback));
+	memset(dmaChannel, 0, sizeof(dmaChannel));
+	memset(wedged, 0, sizeof(wedged));
+	gpioEnabled = 0;
+	woken = false;
+	primask = 0;
+	isrDepth = 0;
+	sim_time = 0;
+	sim_sleepTicks = 1;
+	sim_exitTicks = 0;
+	sim_sleeps = 0;
+	sim_sleepLimit = 1000000;
+	sim_stall = false;
+	sim_hold = false;
+	sim_preempt = NULL;
+	sim_preemptAt = 0;
+	sim_exits = 0;
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Receive characters on a port (the RX interrupt is delivered after every
+ *   character, a character that wasn't read yet is overwritten and sets the
+ *   overflow flag).
+ *
+ * @details
+ *   When the USART isn't clocked or the RX pin isn't routed (idle gating)
+ *   the first character only causes an edge on the RX pin (`sim_rxEdge`)
+ *   and is lost, like on the MCU.
+ *****************************************************************************/
+void sim_receive (unsigned int port, const char *data, size_t length)
+{
+	for (size_t i = 0; i < length; i++)
+	{
+		if (port == SIM_LEUART0)
+		{
+			if (sim_leuart.STATUS & LEUART_STATUS_RXDATAV) sim_leuart.IF |= LEUART_IF_RXOF;
+			sim_leuart.STATUS |= LEUART_STATUS_RXDATAV;
+			sim_leuart.IF |= LEUART_IF_RXDATAV;
+		}
+		else
+		{
+			USART_TypeDef *usart = &sim_usart[port];
+			bool clocked = sim_clock[port == SIM_USART0 ? cmuClock_USART0 : cmuClock_USART1];
+
+			if (!clocked || !(usart->ROUTE & USART_ROUTE_RXPEN))
+			{
+				sim_rxEdge();
+				continue;
+			}
+			if (usart->STATUS & USART_STATUS_RXDATAV) usart->IF |= USART_IF_RXOF;
+			usart->STATUS |= USART_STATUS_RXDATAV;
+			usart->IF |= USART_IF_RXDATAV;
+		}
+		sim_port[port].rxData = (uint8_t)data[i];
+		sim_service();
+	}
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Edge on the RX pins: call the enabled GPIO interrupt callbacks.
+ *
+ * @return
+ *   The amount of callbacks called.
+ *****************************************************************************/
+unsigned int sim_rxEdge (void)
+{
+	unsigned int called = 0;
+
+	for (unsigned int pin = 0; pin < 16; pin++)
+	{
+		if ((gpioEnabled & (1u << pin)) && (gpioCallback[pin] != NULL))
+		{
+			isrDepth++;
+			gpioCallback[pin]((uint8_t)pin);
+			isrDepth--;
+			called++;
+		}
+	}
+	sim_service();
+
+	return (called);
+}
+
+
+/**************************************************************************//**
+ * @brief
+ *   Discard the captured output of a port.
+ *****************************************************************************/
+void sim_clearOutput (unsigned int port)
+{
+	sim_port[port].length = 0;
+}
+
+
+/* ---- em_core.h ---- */
+
+CORE_irqState_t CORE_EnterCritical (void)
+{
+	CORE_irqState_t state = primask;
+
+	if (!state)
+	{
+		primask = 1;
+		lockStart = now();
+	}
+
+	return (state);
+}
+
+void CORE_ExitCritical (CORE_irqState_t irqState)
+{
+	if (irqState) return;
+
+	uint64_t held = now() - lockStart;
+	sim_lock.count++;
+	sim_lock.total += held;
+	if (held > sim_lock.max) sim_lock.max = held;
+	primask = 0;
+
+	if (isrDepth == 0)
+	{
+		sim_time += sim_exitTicks;
+		sim_exits++;
+		if ((sim_preempt != NULL) && (sim_exits == sim_preemptAt)) isr(sim_preempt);
+	}
+
+	sim_service();
+}
+
+bool CORE_IrqIsBlocked (IRQn_Type irq)
+{
+	(void)irq;
+	return (primask || (isrDepth > 0));
+}
+
+
+/* ---- em_emu.h ---- */
+
+void EMU_EnterEM1 (void)
+{
+	sim_sleeps++;
+	sim_time += sim_sleepTicks;
+	if (sim_sleepLimit && (sim_sleeps > sim_sleepLimit))
+	{
+		fprintf(stderr, "sim: the core keeps sleeping (waiting forever?)\n");
+		exit(3);
+	}
+
+	/* An interrupt wakes the core up even if interrupts are masked (WFI),
+	 * the handler runs when they're unmasked again */
+	woken = true;
+	sim_service();
+}
+
+
+/* ---- NVIC ---- */
+
+void NVIC_EnableIRQ (IRQn_Type irq)
+{
+	nvicEnabled[irq] = true;
+	sim_service();
+}
+
+void NVIC_DisableIRQ (IRQn_Type irq)
+{
+	nvicEnabled[irq] = false;
+}
+
+void NVIC_ClearPendingIRQ (IRQn_Type irq)
+{
+	nvicPending[irq] = false;
+}
+
+void NVIC_SetPendingIRQ (IRQn_Type irq)
+{
+	nvicPending[irq] = true;
+	sim_service();
+}
+
+
+/* ---- em_cmu.h ---- */
+
+void CMU_ClockEnable (CMU_Clock_TypeDef clock, bool enable)
+{
+	sim_clock[clock] = enable;
+}
+
+void CMU_ClockSelectSet (CMU_Clock_TypeDef clock, CMU_Select_TypeDef ref)
+{
+	(void)clock;
+	(void)ref;
+}
+
+uint32_t CMU_ClockFreqGet (CMU_Clock_TypeDef clock)
+{
+	if ((clock == cmuClock_LFB) || (clock == cmuClock_LEUART0)) return (32768);
+	return (14000000);
+}
+
+
+/* ---- em_gpio.h and gpiointerrupt.h ---- */
+
+void GPIO_PinModeSet (GPIO_Port_TypeDef port, unsigned int pin, GPIO_Mode_TypeDef mode, unsigned int out)
+{
+	(void)out;
+	sim_pinMode[port][pin & 15] = (uint8_t)mode;
+}
+
+void GPIO_PinOutSet (GPIO_Port_TypeDef port, unsigned int pin)
+{
+	(void)port;
+	(void)pin;
+}
+
+void GPIO_IntConfig (GPIO_Port_TypeDef port, unsigned int pin, bool risingEdge, bool fallingEdge, bool enable)
+{
+	(void)port;
+	(void)risingEdge;
+	(void)fallingEdge;
+	if (enable) gpioEnabled |= 1u << (pin & 15);
+	else gpioEnabled &= ~(1u << (pin & 15));
+}
+
+void GPIO_IntClear (uint32_t flags)
+{
+	(void)flags;
+}
+
+void GPIO_IntEnable (uint32_t flags)
+{
+	gpioEnabled |= flags;
+}
+
+void GPIO_IntDisable (uint32_t flags)
+{
+	gpioEnabled &= ~flags;
+}
+
+void GPIOINT_Init (void)
+{
+}
+
+void GPIOINT_CallbackRegister (uint8_t pin, GPIOINT_IrqCallbackPtr_t callbackPtr)
+{
+	gpioCallback[pin & 15] = callbackPtr;
+}
+
+
+/* ---- em_usart.h ---- */
+
+void USART_InitAsync (USART_TypeDef *usart, const USART_InitAsync_TypeDef *init)
+{
+	(void)init;
+	usart->STATUS |= USART_STATUS_TXBL;
+	usart->IF |= USART_IF_TXBL;
+}
+
+void USART_Enable (USART_TypeDef *usart, USART_Enable_TypeDef enable)
+{
+	(void)usart;
+	(void)enable;
+}
+
+void USART_Tx (USART_TypeDef *usart, uint8_t data)
+{
+	transmit((usart == USART0) ? SIM_USART0 : SIM_USART1, data);
+}
+
+void USART_TxDouble (USART_TypeDef *usart, uint16_t data)
+{
+	USART_Tx(usart, (uint8_t)data);
+	USART_Tx(usart, (uint8_t)(data >> 8));
+}
+
+uint8_t USART_Rx (USART_TypeDef *usart)
+{
+	usart->STATUS &= ~USART_STATUS_RXDATAV;
+	usart->IF &= ~USART_IF_RXDATAV;
+	return (sim_port[(usart == USART0) ? SIM_USART0 : SIM_USART1].rxData);
+}
+
+void USART_IntSet (USART_TypeDef *usart, uint32_t flags)
+{
+	usart->IF |= flags;
+	sim_service();
+}
+
+void USART_IntEnable (USART_TypeDef *usart, uint32_t flags)
+{
+	usart->IEN |= flags;
+	sim_service();
+}
+
+
+/* ---- em_leuart.h ---- */
+
+void LEUART_Init (LEUART_TypeDef *leuart, const LEUART_Init_TypeDef *init)
+{
+	(void)init;
+	leuart->STATUS |= LEUART_STATUS_TXBL;
+	leuart->IF |= LEUART_IF_TXBL;
+}
+
+void LEUART_Tx (LEUART_TypeDef *leuart, uint8_t data)
+{
+	(void)leuart;
+	transmit(SIM_LEUART0, data);
+}
+
+uint8_t LEUART_Rx (LEUART_TypeDef *leuart)
+{
+	leuart->STATUS &= ~LEUART_STATUS_RXDATAV;
+	leuart->IF &= ~LEUART_IF_RXDATAV;
+	return (sim_port[SIM_LEUART0].rxData);
+}
+
+void LEUART_IntSet (LEUART_TypeDef *leuart, uint32_t flags)
+{
+	leuart->IF |= flags;
+	sim_service();
+}
+
+void LEUART_IntEnable (LEUART_TypeDef *leuart, uint32_t flags)
+{
+	leuart->IEN |= flags;
+	sim_service();
+}
+
+
+/* ---- em_dma.h ---- */
+
+void DMA_Init (DMA_Init_TypeDef *init)
+{
+	(void)init;
+	sim_dma.STATUS |= DMA_STATUS_EN;
+
+	/* Like emlib: the DMA interrupt is enabled (the callbacks are called by its handler) */
+	NVIC_ClearPendingIRQ(DMA_IRQn);
+	NVIC_EnableIRQ(DMA_IRQn);
+}
+
+void DMA_CfgChannel (unsigned int channel, DMA_CfgChannel_TypeDef *cfg)
+{
+	dmaChannel[channel].cb = cfg->cb;
+}
+
+void DMA_CfgDescr (unsigned int channel, bool primary, DMA_CfgDescr_TypeDef *cfg)
+{
+	(void)channel;
+	(void)primary;
+	(void)cfg;
+}
+
+void DMA_ActivateBasic (unsigned int channel, bool primary, bool useBurst, void *dst, const void *src, unsigned int nMinus1)
+{
+	(void)useBurst;
+	dmaChannel[channel].active = true;
+	dmaChannel[channel].primary = primary;
+	dmaChannel[channel].dst = (volatile uint32_t *)dst;
+	dmaChannel[channel].src = (const uint8_t *)src;
+	dmaChannel[channel].length = nMinus1 + 1;
+	sim_service();
+}
@@ -0,0 +1,104 @@
+/***************************************************************************//**
+ * @file sim.h
+ * @brief Host model of the EFM32HG peripherals used by "DeBugPrint".
+ * @details
+ *   `dbprint.c` is compiled on the host against the emlib stubs in `emlib/`,
+ *   this model implements them: USART0/1 and LEUART0 (the transmitted
+ *   characters are captured), the DMA controller, GPIO interrupts, the NVIC
+ *   and the critical sections (PRIMASK). Interrupts are delivered when they
+ *   would be taken on the MCU: when a critical section ends, when the core
+ *   sleeps in EM1 or when an interrupt is enabled or set.
+ * @version 7.1
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#ifndef _SIM_H_
+#define _SIM_H_
+
+
+#include <stdint.h>    /* (u)intXX_t */
+#include <stdbool.h>   /* "bool", "true", "false" */
+#include <stddef.h>    /* size_t */
+#include "em_device.h" /* USART_TypeDef, IRQn_Type, ... */
+#include "em_cmu.h"    /* SIM_CLOCKS */
+
+
+/* Ports of the model (index of "sim_port") */
+#define SIM_USART0  0
+#define SIM_USART1  1
+#define SIM_LEUART0 2
+#define SIM_PORTS   3
+
+/* Amount of characters captured per port */
+#define SIM_OUTPUT_SIZE (1 << 20)
+
+
+/** Struct type for a port of the model. */
+typedef struct
+{
+	char output[SIM_OUTPUT_SIZE]; /**< Transmitted characters. */
+	size_t length;                /**< Amount of transmitted characters. */
+	unsigned long lost;           /**< Characters written while the TX line was stalled (`sim_stall`). */
+	unsigned long gatedWrites;    /**< Characters written while the clock was disabled or the TX pin wasn't routed. */
+	unsigned long txInterrupts;   /**< TX handler invocations. */
+	unsigned long rxInterrupts;   /**< RX handler invocations. */
+	unsigned long dmaInterrupts;  /**< DMA callbacks (completed transfers). */
+	unsigned long dmaBytes;       /**< Characters written by the DMA controller (not touched by the CPU). */
+	uint8_t rxData;               /**< Received character that wasn't read yet. */
+} sim_port_t;
+
+
+/** Struct type for the statistics of the critical sections (outermost ones, in host nanoseconds). */
+typedef struct
+{
+	unsigned long count; /**< Amount of critical sections. */
+	uint64_t total;      /**< Total time interrupts were disabled. */
+	uint64_t max;        /**< Longest critical section. */
+} sim_lock_t;
+
+
+extern sim_port_t sim_port[SIM_PORTS];   /**< The ports (`SIM_USART0`, `SIM_USART1` and `SIM_LEUART0`). */
+extern volatile uint32_t sim_time;       /**< Counter for `init.timestamp`, advanced by `sim_sleepTicks` every time the core sleeps (and `sim_exitTicks`). */
+extern uint32_t sim_sleepTicks;          /**< Ticks of `sim_time` per sleep (EM1). */
+extern uint32_t sim_exitTicks;           /**< Ticks of `sim_time` per critical section ended in the main code (time spent polling), `0` by default. */
+extern unsigned long sim_sleeps;         /**< Amount of times the core slept (EM1). */
+extern unsigned long sim_sleepLimit;     /**< The test fails if the core sleeps more often (waiting forever), `0` - No limit. */
+extern bool sim_stall;                   /**< `true` - The TX lines are stuck: no TX interrupts, written characters are lost. */
+extern bool sim_hold;                    /**< `true` - Interrupts are only delivered when the core sleeps (the producer outruns the TX line). */
+extern void (*sim_preempt) (void);       /**< Interrupt handler that preempts the main code at the end of critical section `sim_preemptAt`. */
+extern unsigned long sim_preemptAt;      /**< Critical section (counted from 1) after which `sim_preempt` runs. */
+extern unsigned long sim_exits;          /**< Critical sections ended in the main code. */
+extern sim_lock_t sim_lock;              /**< Statistics of the critical sections. */
+extern uint8_t sim_pinMode[6][16];       /**< `GPIO_Mode_TypeDef` of every pin. */
+extern bool sim_clock[SIM_CLOCKS];       /**< Enabled clocks. */
+
+
+void sim_reset (void);
+void sim_service (void);
+void sim_receive (unsigned int port, const char *data, size_t length);
+unsigned int sim_rxEdge (void);
+void sim_clearOutput (unsigned int port);
+
+
+#endif /* _SIM_H_ */
@@ -0,0 +1,58 @@
+/***************************************************************************//**
+ * @file size_levels.c
+ * @brief Application used by `make size` to compare the size of the call sites per `DBPRINT_LEVEL`.
+ * @details
+ *   The same statements are compiled with every level (and with dbprint
+ *   disabled), `make size` reports `.text` and `.rodata` of the object.
+ *   Every string is unique so none of them are merged.
+ * @version 7.6
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include "debug_dbprint.h"
+
+
+/** Value read by the statements (its evaluation is removed with the statement). */
+volatile int32_t sensor;
+
+
+/** Statements of every level, like in an application. */
+void application (void)
+{
+	dbtrace("Entering the measurement loop");
+	dbtraceInt("Raw sample ", sensor, "");
+	dbtraceInt_hex("Status register ", sensor, "");
+
+	dbinfo("Measurement started");
+	dbinfoInt("Temperature: ", sensor, " C");
+	dbinfoInt_hex("Device ID: ", sensor, "");
+
+	dbwarn("Battery voltage is low");
+	dbwarnInt("Retries: ", sensor, "");
+	dbwarnInt_hex("Unexpected flags: ", sensor, "");
+
+	dbcrit("Sensor doesn't respond");
+	dbcritInt("Error code: ", sensor, "");
+	dbcritInt_hex("Fault address: ", sensor, "");
+}
@@ -0,0 +1,81 @@
+/***************************************************************************//**
+ * @file test.h
+ * @brief Checks for the host tests of "DeBugPrint".
+ * @details
+ *   A failing check prints its location and expression to `stderr`, `main`
+ *   of a test returns `test_result()` (non-zero if a check failed).
+ * @version 7.1
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#ifndef _TEST_H_
+#define _TEST_H_
+
+
+#include <stdio.h>  /* fprintf */
+#include <string.h> /* strlen, memcmp */
+#include "sim.h"
+
+
+/* Color codes of dbprint.c */
+#define YELLOW_ "\x1b[33m"
+#define RED_    "\x1b[31m"
+#define RESET_  "\x1b[0m"
+
+
+static unsigned int test_failures;
+
+
+/** Check a condition. */
+#define CHECK(condition) \
+	do { if (!(condition)) { test_failures++; fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); } } while (0)
+
+/** Check the captured output of a port (and discard it). */
+#define CHECK_OUTPUT(port, expected) \
+	test_output(__FILE__, __LINE__, port, expected, sizeof(expected) - 1)
+
+
+/** Compare the captured output of a port with the expected text and discard it. */
+static inline void test_output (const char *file, int line, unsigned int port, const char *expected, size_t length)
+{
+	if ((sim_port[port].length != length) || (memcmp(sim_port[port].output, expected, length) != 0))
+	{
+		test_failures++;
+		fprintf(stderr, "%s:%d: output check failed\n  expected: \"%.*s\"\n  output:   \"%.*s\"\n",
+		        file, line, (int)length, expected, (int)sim_port[port].length, sim_port[port].output);
+	}
+	sim_clearOutput(port);
+}
+
+
+/** Print the result of a test, return value for `main`. */
+static inline int test_result (const char *name)
+{
+	if (test_failures) fprintf(stderr, "%s: %u check(s) failed\n", name, test_failures);
+	else printf("%s: passed\n", name);
+	return (test_failures ? 1 : 0);
+}
+
+
+#endif /* _TEST_H_ */
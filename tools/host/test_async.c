@@ -0,0 +1,228 @@
+/***************************************************************************//**
+ * @file test_async.c
+ * @brief Host test of the asynchronous read (`dbReadAsync` and `dbReadAsync_poll`).
+ * @details
+ *   Lines, byte counts and timeouts (measured with the counter of
+ *   `init.timestamp`, `sim_time`) have to reach the callback once and in
+ *   order, from the RX handler or from `dbReadAsync_poll` (deferred and for
+ *   every timeout). `dbReadAsync_poll` calls the callback with interrupts
+ *   enabled, lines received in the meantime are delivered after it.
+ * @version 7.25
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include "em_core.h"
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+/* Events remembered by the callback */
+#define EVENTS 16
+
+
+/** Struct type for an event given to the callback. */
+typedef struct
+{
+	dbprint_rxevent_t event;
+	char data[DBPRINT_BUFFER_SIZE];
+	uint32_t length;
+	bool blocked; /**< `true` if interrupts were disabled (or the RX handler called the callback). */
+} event_t;
+
+static event_t events[EVENTS];
+static unsigned int received;
+
+/** Nesting of the callback (it's never called while it executes). */
+static unsigned int depth;
+static unsigned int maxDepth;
+
+/** Data received while the callback executes (`NULL` - none). */
+static const char *inject;
+
+
+/** Callback of the asynchronous read: remember the event. */
+static void callback (dbprint_t *db, dbprint_rxevent_t event, char *data, uint32_t length)
+{
+	depth++;
+	if (depth > maxDepth) maxDepth = depth;
+
+	if (received < EVENTS)
+	{
+		events[received].event = event;
+		events[received].length = length;
+		snprintf(events[received].data, sizeof(events[received].data), "%s", data);
+		events[received].blocked = CORE_IrqIsBlocked(USART1_RX_IRQn);
+	}
+	received++;
+
+	if (inject != NULL)
+	{
+		const char *data = inject;
+
+		inject = NULL;
+		sim_receive(SIM_USART1, data, strlen(data));
+	}
+
+	depth--;
+}
+
+
+/** Check event "index". */
+static void checkEvent (unsigned int index, dbprint_rxevent_t event, const char *data, bool blocked)
+{
+	CHECK(index < received);
+	if (index >= received) return;
+	CHECK(events[index].event == event);
+	CHECK((events[index].length == strlen(data)) && (strcmp(events[index].data, data) == 0));
+	CHECK(events[index].blocked == blocked);
+}
+
+
+/** Receive a string on USART1. */
+static void receive (const char *data)
+{
+	sim_receive(SIM_USART1, data, strlen(data));
+}
+
+
+/** Reset the model and the events and initialize the default instance (with a counter). */
+static void start (void)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+
+	sim_reset();
+	init.banner = false;
+	init.timestamp = &sim_time;
+	init.timestampMask = 0xFFFFFFFF;
+	dbprint_INIT_config(&init);
+
+	memset(events, 0, sizeof(events));
+	received = 0;
+	depth = 0;
+	maxDepth = 0;
+	inject = NULL;
+}
+
+
+int main (void)
+{
+	/* Lines, called by the RX handler */
+	start();
+	CHECK(dbReadAsync(0, 0, callback, false));
+	receive("hello\rworld\r");
+	CHECK(received == 2);
+	checkEvent(0, RX_LINE, "hello", true);
+	checkEvent(1, RX_LINE, "world", true);
+
+	/* Byte counts (CR is data) */
+	start();
+	CHECK(dbReadAsync(4, 0, callback, false));
+	receive("ab\rcdefg");
+	CHECK(received == 2);
+	checkEvent(0, RX_COUNT, "ab\rc", true);
+	checkEvent(1, RX_COUNT, "defg", true);
+
+	/* Deferred: the lines wait in the RX queue until dbReadAsync_poll */
+	start();
+	CHECK(dbReadAsync(0, 0, callback, true));
+	receive("one\rtwo\r");
+	CHECK(received == 0);
+	dbReadAsync_poll();
+	CHECK(received == 2);
+	checkEvent(0, RX_LINE, "one", false);
+	checkEvent(1, RX_LINE, "two", false);
+
+	/* Timeout with data: only after "timeout" ticks without a character, also if the callback isn't deferred */
+	start();
+	CHECK(dbReadAsync(0, 100, callback, false));
+	receive("par");
+	sim_time += 99;
+	dbReadAsync_poll();
+	CHECK(received == 0);
+	sim_time += 1;
+	dbReadAsync_poll();
+	CHECK(received == 1);
+	checkEvent(0, RX_TIMEOUT, "par", false);
+
+	/* The timeout of the next read starts with its first character */
+	sim_time += 1000;
+	dbReadAsync_poll();
+	CHECK(received == 1);
+	receive("tial\r");
+	CHECK(received == 2);
+	checkEvent(1, RX_LINE, "tial", true);
+
+	/* Timeout without data (starts when the callback is registered) */
+	start();
+	CHECK(dbReadAsync(0, 100, callback, false));
+	sim_time += 100;
+	dbReadAsync_poll();
+	dbReadAsync_poll();
+	CHECK(received == 1);
+	checkEvent(0, RX_TIMEOUT, "", false);
+
+	/* A line received while dbReadAsync_poll calls the callback: delivered once, afterwards */
+	start();
+	CHECK(dbReadAsync(0, 100, callback, false));
+	sim_time += 100;
+	inject = "late\r";
+	dbReadAsync_poll();
+	CHECK(received == 2);
+	CHECK(maxDepth == 1);
+	checkEvent(0, RX_TIMEOUT, "", false);
+	checkEvent(1, RX_LINE, "late", false);
+	receive("next\r");
+	CHECK(received == 3);
+	checkEvent(2, RX_LINE, "next", true);
+
+	/* Deferred timeout of a byte count */
+	start();
+	CHECK(dbReadAsync(3, 100, callback, true));
+	receive("xyzxy");
+	sim_time += 100;
+	dbReadAsync_poll();
+	CHECK(received == 2);
+	checkEvent(0, RX_COUNT, "xyz", false);
+	checkEvent(1, RX_TIMEOUT, "xy", false);
+
+	/* Without a callback the lines are polled again */
+	CHECK(dbReadAsync(0, 0, NULL, false));
+	receive("poll\r");
+	dbReadAsync_poll();
+	CHECK(received == 2);
+	uint32_t length = 0;
+	char *line = dbGet_RXline(&length);
+	CHECK((line != NULL) && (length == 4) && (strcmp(line, "poll") == 0));
+	dbRelease_RXline();
+
+	/* A timeout needs a counter */
+	start();
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+	init.banner = false;
+	dbprint_INIT_config(&init);
+	CHECK(!dbReadAsync(0, 100, callback, false));
+	CHECK(dbReadAsync(0, 0, callback, false));
+
+	return (test_result("test_async"));
+}
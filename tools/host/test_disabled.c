@@ -0,0 +1,134 @@
+/***************************************************************************//**
+ * @file test_disabled.c
+ * @brief Host test of the empty macros used if dbprint is disabled.
+ * @details
+ *   Built with `DEBUG_DBPRINT` set to `0` (and `-Werror`): code written for
+ *   the enabled library (instances, statistics, command tables, callbacks)
+ *   has to compile without warnings, the statements don't transmit anything
+ *   and their arguments aren't evaluated, `dbprint_stats` zeroes the statistics.
+ * @version 7.25
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+#if DEBUG_DBPRINT != 0
+#error "test_disabled needs to be built with DEBUG_DBPRINT set to 0!"
+#endif
+
+
+/** Instance used by the `_ctx` methods. */
+static dbprint_t usart0;
+
+
+/** Command handler of the shell. */
+static void led (dbprint_t *db, uint32_t argc, char *argv[])
+{
+	dbinfo_ctx(db, argv[0]);
+}
+
+
+/** Command table of the shell (normally generated by `dbshellgen`). */
+static const dbprint_command_t commands[] = { { "led", led, "Toggle the LED" } };
+
+/** Shell using the command table. */
+static const dbprint_shell_t shell = { commands, 1, 0 };
+
+
+/** Callback of the asynchronous read. */
+static void received (dbprint_t *db, dbprint_rxevent_t event, char *data, uint32_t length)
+{
+	dbprintn_ctx(db, data, length);
+}
+
+
+int main (void)
+{
+	int32_t evaluated = 0; /* Incremented by the arguments */
+
+	/* Initialization with the settings structure */
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+	init.banner = false;
+	dbprint_INIT_config(&init);
+	dbprint_INIT(USART1, 4, true, true);
+
+	/* Statements */
+	dbprint("Hello");
+	dbprintln("world");
+	dbprintInt(evaluated++);
+	dbprintlnInt_hex(evaluated++);
+	dbinfoInt("Value ", evaluated++, "");
+	dbwarn("Warning");
+	dbcrit("Critical");
+	dbprint_color("Color", RED);
+	dbFlush();
+	dbIdle_poll();
+
+	/* Methods using a given instance */
+	dbprint_init_t init0 = DBPRINT_INIT_DEFAULT;
+	init0.pointer = USART0;
+	dbprint_INIT_config_ctx(&usart0, &init0);
+	dbprintln_ctx(&usart0, "Data");
+	dbcritInt_ctx(&usart0, "Value ", evaluated++, "");
+	CHECK(!dbGet_RXstatus_ctx(&usart0));
+	dbFlush_timeout_ctx(&usart0, 10);
+	dbIdle_poll_ctx(&usart0);
+	CHECK(!dbShell_ctx(&usart0, &shell));
+
+	/* Methods with a return value can be used as a statement */
+	dbGet_RXstatus();
+	dbGet_TXdropped_ctx(&usart0);
+	dbFlush_timeout(10);
+	dbprint_frame((const uint8_t *)"Frame", 5);
+	dbShell(&shell);
+	dbReadAsync(0, 0, received, false);
+
+	/* The statistics are zeroed (not left uninitialized) */
+	const dbprint_stats_t zero = { 0 };
+	dbprint_stats_t stats;
+	memset(&stats, 0xFF, sizeof(stats));
+	dbprint_stats(&stats);
+	CHECK(memcmp(&stats, &zero, sizeof(zero)) == 0);
+	memset(&stats, 0xFF, sizeof(stats));
+	dbprint_stats_ctx(&usart0, &stats);
+	CHECK(memcmp(&stats, &zero, sizeof(zero)) == 0);
+	dbprintStats();
+	dbprintStats_reset();
+
+	/* Getters */
+	char buffer[DBPRINT_BUFFER_SIZE] = "";
+	dbReadLine(buffer);
+	CHECK(buffer[0] == '\0');
+	CHECK(!dbGet_RXstatus());
+	CHECK(dbGet_RXline(NULL) == NULL);
+	CHECK(dbGet_TXdropped() == 0);
+	CHECK(dbFlush_timeout(10));
+
+	CHECK(sim_port[SIM_USART1].length == 0);
+	CHECK(evaluated == 0);
+
+	return (test_result("test_disabled"));
+}
@@ -0,0 +1,99 @@
+/***************************************************************************//**
+ * @file test_dma.c
+ * @brief Host test of the DMA TX mode (`DBPRINT_DMA`, `TX_DMA`).
+ * @details
+ *   The records have to arrive byte-exact and every character has to be
+ *   written by the DMA controller (the CPU doesn't touch the queued
+ *   characters), with one interrupt per chunk. The characters touched by
+ *   the CPU and the interrupts per KB are printed for `TX_DMA` and
+ *   `TX_BUFFER_LEVEL`, with an idle TX line (every record is its own chunk)
+ *   and with a producer that outruns the TX line (`sim_hold` for bursts of
+ *   records that fit in the TX queue, they're sent as one chunk).
+ * @version 7.3
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+#define ROUNDS 200
+
+/* Rounds written while the TX line is held (fit in the TX queue) */
+#define BURST 3
+
+
+static char expected[ROUNDS * 64];
+
+
+/* Write the records (the TX line outruns the producer unless "hold"), check the output and print the cost per KB */
+static void run (dbprint_txmode_t txMode, bool hold, const char *name)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+	size_t length = 0;
+
+	sim_reset();
+	init.txMode = txMode;
+	dbprint_INIT_config(&init);
+	sim_service();
+	sim_clearOutput(SIM_USART1); /* Welcome banner */
+	unsigned long dmaBytes = sim_port[SIM_USART1].dmaBytes;
+	unsigned long interrupts = sim_port[SIM_USART1].dmaInterrupts + sim_port[SIM_USART1].txInterrupts;
+
+	for (int32_t r = 0; r < ROUNDS; r++)
+	{
+		if ((r % BURST) == 0)
+		{
+			sim_hold = false;
+			sim_service();
+			sim_hold = hold;
+		}
+		dbinfoInt("Battery voltage: ", 3300 - (r & 255), " mV");
+		dbprintln("Odd length");
+		length += (size_t)snprintf(&expected[length], sizeof(expected) - length,
+		                           "INFO: Battery voltage: %ld mV\r\nOdd length\r\n", (long)(3300 - (r & 255)));
+	}
+	sim_hold = false;
+	sim_service();
+
+	dmaBytes = sim_port[SIM_USART1].dmaBytes - dmaBytes;
+	interrupts = sim_port[SIM_USART1].dmaInterrupts + sim_port[SIM_USART1].txInterrupts - interrupts;
+	CHECK((sim_port[SIM_USART1].length == length) && (memcmp(sim_port[SIM_USART1].output, expected, length) == 0));
+	if (txMode == TX_DMA) CHECK(dmaBytes == length);
+
+	double kb = length / 1024.0;
+	printf("test_dma: %-15s %-10s %5zu bytes, %5lu touched by the CPU, %6.1f interrupts per KB\n", name,
+	       hold ? "(busy)" : "(idle)", length, (unsigned long)(length - dmaBytes), interrupts / kb);
+}
+
+
+int main (void)
+{
+	run(TX_DMA, false, "TX_DMA");
+	run(TX_DMA, true, "TX_DMA");
+	run(TX_BUFFER_LEVEL, false, "TX_BUFFER_LEVEL");
+	run(TX_BUFFER_LEVEL, true, "TX_BUFFER_LEVEL");
+
+	return (test_result("test_dma"));
+}
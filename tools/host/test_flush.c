@@ -0,0 +1,129 @@
+/***************************************************************************//**
+ * @file test_flush.c
+ * @brief Host test of `dbFlush` and `dbFlush_timeout`.
+ * @details
+ *   The timeout is measured with the counter of `init.timestamp` (`sim_time`,
+ *   advanced while polling): it has to end the wait if the TX line is stuck
+ *   (TX queue or shift register), without a counter a finite timeout is
+ *   refused. `dbFlush` has to return before anything is transmitted and
+ *   while an interrupt handler keeps adding records to the TX queue.
+ * @version 7.22
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+/** Records added by the producer (interrupt handler). */
+static unsigned int produced;
+
+
+/** Interrupt handler that adds a record at the end of every critical section of the main code. */
+static void producer (void)
+{
+	if (produced++ < 100)
+	{
+		dbprintln("Other producer");
+		sim_preemptAt = sim_exits + 1;
+	}
+}
+
+
+/** Reset the model and initialize the default instance (with or without a counter). */
+static void start (bool counter)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+
+	sim_reset();
+	sim_exitTicks = 1;
+	init.banner = false;
+	init.timestamp = counter ? &sim_time : NULL;
+	init.timestampMask = 0xFFFFFFFF;
+	dbprint_INIT_config(&init);
+}
+
+
+int main (void)
+{
+	/* Nothing transmitted yet (TX Complete isn't set after a reset) */
+	start(true);
+	USART1->STATUS &= ~USART_STATUS_TXC;
+	CHECK(dbFlush_timeout(0));
+	dbFlush();
+
+	/* Data that can be transmitted */
+	dbprintln("Flushed");
+	CHECK(dbFlush_timeout(1000));
+	CHECK_OUTPUT(SIM_USART1, "Flushed\r\n");
+
+	/* The TX line is stuck: the timeout ends the wait */
+	sim_stall = true;
+	dbprintln("Stuck in the TX queue");
+	uint32_t begin = sim_time;
+	CHECK(!dbFlush_timeout(100));
+	CHECK(((sim_time - begin) >= 100) && ((sim_time - begin) < 200));
+	CHECK(dbFlush_timeout(0) == false);
+	sim_stall = false;
+	sim_service();
+	CHECK(dbFlush_timeout(1000));
+	sim_clearOutput(SIM_USART1);
+
+	/* A character stays in the shift register: the timeout also ends that wait */
+	USART1->STATUS &= ~USART_STATUS_TXC;
+	begin = sim_time;
+	CHECK(!dbFlush_timeout(50));
+	CHECK(((sim_time - begin) >= 50) && ((sim_time - begin) < 100));
+	USART1->STATUS |= USART_STATUS_TXC;
+	CHECK(dbFlush_timeout(0));
+
+	/* Without a counter a finite timeout is refused (nothing is waited for) */
+	start(false);
+	sim_stall = true;
+	dbprintln("Stuck without a counter");
+	unsigned long exits = sim_exits;
+	CHECK(!dbFlush_timeout(100));
+	CHECK((sim_exits - exits) <= 2);
+	sim_stall = false;
+	sim_service();
+	dbFlush();
+	sim_clearOutput(SIM_USART1);
+
+	/* Another producer keeps the TX queue busy: only the data before the call is waited for */
+	start(true);
+	sim_hold = true;
+	dbprintln("Mine");
+	produced = 0;
+	sim_preempt = producer;
+	sim_preemptAt = sim_exits + 1;
+	dbFlush();
+	CHECK(produced < 10);
+	CHECK(memcmp(sim_port[SIM_USART1].output, "Mine\r\n", 6) == 0);
+	sim_preempt = NULL;
+	sim_hold = false;
+	sim_service();
+	dbFlush();
+
+	return (test_result("test_flush"));
+}
@@ -0,0 +1,156 @@
+/***************************************************************************//**
+ * @file test_frame.c
+ * @brief Host test of the binary frames (`dbprint_frame`).
+ * @details
+ *   An interrupt handler that also sends a frame preempts `dbprint_frame`
+ *   after every critical section in turn. Both frames have to be valid
+ *   (COBS encoding and CRC-16), get their own sequence number and be
+ *   counted in the `txFrames` statistic.
+ * @version 7.22
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+/** Data of the frames (with zero bytes, COBS has to encode them). */
+static const uint8_t mainData[] = { 0x01, 0x00, 0xFF, 0x10, 0x00, 0x20 };
+static const uint8_t isrData[] = { 0x00, 0x00, 0x42 };
+
+
+/** Interrupt handler that preempts the main code. */
+static void isr (void)
+{
+	dbprint_frame(isrData, sizeof(isrData));
+}
+
+
+/** CRC-16 (CCITT) of dbprint.c. */
+static uint16_t crc16 (const uint8_t *data, size_t length)
+{
+	uint16_t crc = 0xFFFF;
+
+	for (size_t i = 0; i < length; i++)
+	{
+		uint8_t x = (crc >> 8) ^ data[i];
+		x ^= x >> 4;
+		crc = (crc << 8) ^ ((uint16_t)x << 12) ^ ((uint16_t)x << 5) ^ x;
+	}
+
+	return (crc);
+}
+
+
+/** Decode the frames in the captured output, return the amount of valid ones (sequence numbers in `seq`). */
+static unsigned int decode (uint8_t seq[], unsigned int max)
+{
+	const uint8_t *out = (const uint8_t *)sim_port[SIM_USART1].output;
+	size_t length = sim_port[SIM_USART1].length;
+	unsigned int frames = 0;
+	size_t i = 0;
+
+	while (i < length)
+	{
+		if (out[i++] != DBPRINT_FRAME_START) return (0);
+
+		/* COBS decoding until the end character */
+		uint8_t raw[DBPRINT_FRAME_SIZE + 3];
+		size_t size = 0;
+
+		while ((i < length) && (out[i] != 0x00))
+		{
+			uint8_t code = out[i++];
+
+			for (uint8_t k = 1; k < code; k++)
+			{
+				if ((i >= length) || (out[i] == 0x00) || (size >= sizeof(raw))) return (0);
+				raw[size++] = out[i++];
+			}
+			if ((code < 0xFF) && (i < length) && (out[i] != 0x00) && (size < sizeof(raw))) raw[size++] = 0x00;
+		}
+		i++; /* End character */
+
+		/* Sequence number, data and CRC */
+		if ((size < 3) || (crc16(raw, size - 2) != (((uint16_t)raw[size - 2] << 8) | raw[size - 1]))) return (0);
+
+		bool isr = (size - 3 == sizeof(isrData)) && (memcmp(&raw[1], isrData, sizeof(isrData)) == 0);
+		bool main = (size - 3 == sizeof(mainData)) && (memcmp(&raw[1], mainData, sizeof(mainData)) == 0);
+		if (!(isr || main) || (frames >= max)) return (0);
+
+		seq[frames++] = raw[0];
+	}
+
+	return (frames);
+}
+
+
+int main (void)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+	dbprint_stats_t stats;
+	uint8_t seq[2];
+
+	sim_reset();
+	init.banner = false;
+	dbprint_INIT_config(&init);
+
+	/* Amount of critical sections of dbprint_frame itself */
+	unsigned long start = sim_exits;
+	CHECK(dbprint_frame(mainData, sizeof(mainData)));
+	unsigned long exits = sim_exits - start;
+	CHECK(exits >= 2); /* Sequence number and record */
+	dbFlush();
+	CHECK((decode(seq, 2) == 1) && (seq[0] == 0));
+	sim_clearOutput(SIM_USART1);
+
+	uint8_t next = 1;
+
+	for (unsigned long at = 1; at <= exits; at++)
+	{
+		dbprint_stats(&stats);
+		uint32_t frames = stats.txFrames;
+
+		sim_preempt = isr;
+		sim_preemptAt = sim_exits + at;
+		CHECK(dbprint_frame(mainData, sizeof(mainData)));
+		sim_preempt = NULL;
+		dbFlush();
+
+		dbprint_stats(&stats);
+		CHECK(stats.txFrames == frames + 2);
+
+		/* Two valid frames with the next two sequence numbers (in any order) */
+		if ((decode(seq, 2) != 2) || (seq[0] == seq[1]) ||
+		    !(((seq[0] == next) && (seq[1] == (uint8_t)(next + 1))) || ((seq[1] == next) && (seq[0] == (uint8_t)(next + 1)))))
+		{
+			test_failures++;
+			fprintf(stderr, "preempted after critical section %lu: wrong frames\n", at);
+		}
+		next += 2;
+		sim_clearOutput(SIM_USART1);
+	}
+
+	return (test_result("test_frame"));
+}
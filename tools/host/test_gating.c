@@ -0,0 +1,177 @@
+/***************************************************************************//**
+ * @file test_gating.c
+ * @brief Host test of the clock gating of USARTx (`DBPRINT_IDLE_GATING`).
+ * @details
+ *   Nothing may be written to USARTx while its clock is gated or its pins
+ *   aren't routed (`gatedWrites`). Without threshold the clock is gated as
+ *   soon as the TX queue is idle, with `init.idleThreshold` only after that
+ *   many ticks of the counter (`sim_time`, `dbIdle_poll`) so a burst of
+ *   records with short pauses keeps the clock enabled. Received data wakes
+ *   USARTx up (the first character is lost) and the clock gets gated again
+ *   after the line. A threshold without counter is refused (no gating).
+ *   The gate transitions of a burst are printed with and without threshold.
+ * @version 7.22
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+
+
+/* Records of a burst */
+#define BURST 20
+
+/* Counter ticks between the records of a burst */
+#define PAUSE 50
+
+
+/** Reset the model and initialize the default instance with clock gating. */
+static void start (uint32_t threshold, bool counter)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+
+	sim_reset();
+	init.banner = false;
+	init.idleGating = true;
+	init.idleThreshold = threshold;
+	init.timestamp = counter ? &sim_time : NULL;
+	dbprint_INIT_config(&init);
+}
+
+
+/** `true` if the clock of USART1 is enabled and its pins are routed. */
+static bool clocked (void)
+{
+	return (sim_clock[cmuClock_USART1] && (USART1->ROUTE != 0));
+}
+
+
+/** Write a burst of records with pauses in between (calling dbIdle_poll), returns the gate transitions. */
+static uint32_t burst (void)
+{
+	dbprint_stats_t stats;
+
+	dbprintStats_reset();
+	for (int32_t i = 0; i < BURST; i++)
+	{
+		dbinfoInt("Sample ", i, "");
+		sim_time += PAUSE;
+		dbIdle_poll();
+	}
+	dbprint_stats(&stats);
+	sim_clearOutput(SIM_USART1);
+
+	return (stats.gated);
+}
+
+
+int main (void)
+{
+	dbprint_stats_t stats;
+
+	/* No threshold: gated as soon as the TX queue is idle, enabled again by a print method */
+	start(0, false);
+	CHECK(clocked()); /* Only after the first output */
+	dbprintln("Gated");
+	CHECK_OUTPUT(SIM_USART1, "Gated\r\n");
+	CHECK(!clocked());
+	dbprintln("Ungated");
+	CHECK_OUTPUT(SIM_USART1, "Ungated\r\n");
+	CHECK(!clocked());
+	dbprint_stats(&stats);
+	CHECK((stats.gated == 2) && (stats.ungated == 1));
+	uint32_t immediate = burst();
+	CHECK(immediate == BURST);
+
+	/* Received data wakes USARTx up (the character of the edge is lost), gated again after the line */
+	sim_receive(SIM_USART1, "xhello\r", 7);
+	uint32_t length = 0;
+	char *line = dbGet_RXline(&length);
+	CHECK((line != NULL) && (strcmp(line, "hello") == 0));
+	dbRelease_RXline();
+	dbprint_stats(&stats);
+	CHECK(stats.rxWakeups == 1);
+	CHECK(!clocked());
+
+	/* Threshold: the clock stays enabled during the burst and gets gated once the idle time has passed */
+	start(2 * PAUSE, true);
+	CHECK(clocked());
+	uint32_t delayed = burst();
+	CHECK(delayed == 0);
+	CHECK(clocked());
+	sim_time += PAUSE;
+	dbIdle_poll();
+	CHECK(!clocked());
+	dbprint_stats(&stats);
+	CHECK(stats.gated == 1);
+
+	/* Received data: the idle time starts over after the line */
+	sim_receive(SIM_USART1, "xab", 3);
+	CHECK(clocked());
+	sim_time += 3 * PAUSE;
+	dbIdle_poll();
+	CHECK(clocked()); /* The line isn't complete yet */
+	sim_receive(SIM_USART1, "c\r", 2);
+	line = dbGet_RXline(&length);
+	CHECK((line != NULL) && (strcmp(line, "abc") == 0));
+	dbRelease_RXline();
+	sim_time += PAUSE;
+	dbIdle_poll();
+	CHECK(clocked());
+	sim_time += PAUSE;
+	dbIdle_poll();
+	CHECK(!clocked());
+	dbprint_stats(&stats);
+	CHECK((stats.rxWakeups == 1) && (stats.gated == 2));
+
+	/* A record while idle (not gated yet) restarts the idle time */
+	dbprintln("Restart");
+	sim_time += PAUSE;
+	dbIdle_poll();
+	dbprintln("Restart");
+	sim_time += PAUSE + 1;
+	dbIdle_poll();
+	CHECK(clocked());
+	sim_time += PAUSE;
+	dbIdle_poll();
+	CHECK(!clocked());
+	CHECK_OUTPUT(SIM_USART1, "Restart\r\nRestart\r\n");
+
+	/* A threshold needs a counter */
+	start(2 * PAUSE, false);
+	dbprintln("No counter");
+	sim_time += 10 * PAUSE;
+	dbIdle_poll();
+	CHECK(clocked());
+	CHECK_OUTPUT(SIM_USART1, "No counter\r\n");
+
+	CHECK(sim_port[SIM_USART1].gatedWrites == 0);
+
+	printf("test_gating: %d records %d ticks apart: %lu gate transitions without threshold, %lu with %d ticks\n",
+	       BURST, PAUSE, (unsigned long)immediate, (unsigned long)delayed, 2 * PAUSE);
+
+	return (test_result("test_gating"));
+}
@@ -0,0 +1,77 @@
+/***************************************************************************//**
+ * @file test_leuart.c
+ * @brief Host test of the LEUART backend (`DBPRINT_LEUART`, `init.leuart`).
+ * @details
+ *   An instance on LEUART0 has to transmit 300 records byte-exact (the TX
+ *   queue wraps around several times), receive lines and leave USART1
+ *   (the `init.pointer` of the default settings) silent.
+ * @version 7.22
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+/* Amount of records */
+#define RECORDS 300
+
+
+static char expected[RECORDS * 32];
+
+
+int main (void)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+	size_t length = 0;
+
+	sim_reset();
+	init.banner = false;
+	init.leuart = LEUART0;
+	init.location = 0;
+	dbprint_INIT_config(&init);
+
+	/* Records of every length (the TX queue wraps around) */
+	for (int i = 0; i < RECORDS; i++)
+	{
+		dbinfoInt("Record ", i, "");
+		length += (size_t)snprintf(&expected[length], sizeof(expected) - length, "INFO: Record %d\r\n", i);
+	}
+	dbFlush();
+	CHECK(sim_port[SIM_LEUART0].length == length);
+	CHECK(memcmp(sim_port[SIM_LEUART0].output, expected, length) == 0);
+	CHECK(sim_port[SIM_LEUART0].txInterrupts > 0);
+	CHECK(sim_port[SIM_USART1].length == 0);
+	CHECK(sim_port[SIM_USART1].txInterrupts == 0);
+
+	/* Received lines */
+	sim_receive(SIM_LEUART0, "leuart\r", 7);
+	uint32_t rxLength = 0;
+	char *line = dbGet_RXline(&rxLength);
+	CHECK((line != NULL) && (rxLength == 6) && (strcmp(line, "leuart") == 0));
+	dbRelease_RXline();
+	CHECK(sim_port[SIM_LEUART0].rxInterrupts == 7);
+
+	return (test_result("test_leuart"));
+}
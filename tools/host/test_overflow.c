@@ -0,0 +1,291 @@
+/***************************************************************************//**
+ * @file test_overflow.c
+ * @brief Host test of the overflow policies of the TX queue and the drop marker.
+ * @details
+ *   The TX handler doesn't run while the records are written (`sim_hold`),
+ *   so the TX queue overflows. Afterwards the output has to consist of whole
+ *   records in order, and the `[N records dropped]` markers have to account
+ *   for every record that is missing. The longest time interrupts are
+ *   disabled is printed per policy, for short and long records.
+ * @version 7.9
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include <stdlib.h>
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+/* Records of 32 characters: 8 fit in the TX queue */
+#define RECORD_LENGTH 32
+#define QUEUE_RECORDS (DBPRINT_TX_BUFFER_SIZE / RECORD_LENGTH)
+
+
+/* Result of "parse" */
+typedef struct
+{
+	bool delivered[100]; /* Records in the output */
+	unsigned int records;
+	unsigned int markers;
+	unsigned int markedDrops; /* Sum of the counts of the markers */
+	bool valid;               /* Only whole records and markers, in order */
+} output_t;
+
+
+/* Write record "number" (its level selects the print method) */
+static void writeRecord (unsigned int number, uint8_t level)
+{
+	char message[RECORD_LENGTH];
+
+	/* "Record NN" + padding + CR+LF = 32 characters (INFO: and WARN: are 6 characters,
+	 *   the color codes of WARN and CRIT records make those longer) */
+	snprintf(message, sizeof(message), "Record %02u ..................", number);
+	if (level == DBPRINT_LEVEL_CRIT) dbcrit(message);
+	else if (level == DBPRINT_LEVEL_WARN) dbwarn(message);
+	else dbprintln(message);
+}
+
+
+/* Parse the output of USART1 (and discard it) */
+static output_t parse (void)
+{
+	output_t result;
+	char *text = sim_port[SIM_USART1].output;
+	size_t length = sim_port[SIM_USART1].length;
+	int last = -1;
+
+	memset(&result, 0, sizeof(result));
+	result.valid = true;
+
+	for (size_t start = 0; start < length; )
+	{
+		char *end = memchr(&text[start], '\n', length - start);
+		if (end == NULL)
+		{
+			result.valid = false;
+			break;
+		}
+
+		unsigned int number, count;
+		char *record = strstr(&text[start], "Record ");
+
+		if (sscanf(&text[start], "[%u records dropped]", &count) == 1)
+		{
+			result.markers++;
+			result.markedDrops += count;
+		}
+		else if ((record != NULL) && (record < end) && (sscanf(record, "Record %u", &number) == 1) &&
+		         ((int)number > last) && (number < 100))
+		{
+			result.delivered[number] = true;
+			result.records++;
+			last = (int)number;
+		}
+		else
+		{
+			result.valid = false;
+		}
+
+		start = (size_t)(end - text) + 1;
+	}
+
+	sim_clearOutput(SIM_USART1);
+	return (result);
+}
+
+
+/* Initialize the default instance with an overflow policy */
+static void start (dbprint_overflow_t overflow)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+
+	sim_reset();
+	init.overflow = overflow;
+	dbprint_INIT_config(&init);
+	sim_service();
+	sim_clearOutput(SIM_USART1); /* Welcome banner */
+}
+
+
+/* Print the longest time interrupts are disabled (host) with records of 32 and 200 characters, the TX queue overflows
+ *   -> The best of 10 runs, so the measurement isn't disturbed by the host itself
+ *   -> OVERFLOW_BLOCK waits for the TX handler, the TX line isn't held for it */
+static void lockTime (dbprint_overflow_t overflow, const char *name)
+{
+	char text[201];
+	uint64_t max[2] = { UINT64_MAX, UINT64_MAX };
+
+	memset(text, '.', 200);
+	text[200] = '\0';
+
+	for (unsigned int run = 0; run < 20; run++)
+	{
+		unsigned int size = run & 1;
+
+		start(overflow);
+		memset(&sim_lock, 0, sizeof(sim_lock));
+		sim_hold = (overflow != OVERFLOW_BLOCK);
+		for (unsigned int i = 0; i < 50; i++) dbinfo(&text[size ? 6 : 174]); /* "INFO: " + 26 or 194 + CR+LF */
+		sim_hold = false;
+		sim_service();
+		sim_clearOutput(SIM_USART1);
+		if (sim_lock.max < max[size]) max[size] = sim_lock.max;
+	}
+
+	printf("test_overflow: %-26s interrupts disabled %5llu ns at most with records of 32 characters, %5llu ns with 200 (host)\n",
+	       name, (unsigned long long)max[0], (unsigned long long)max[1]);
+}
+
+
+/* Interrupt handler that lets the TX line go */
+static void release (void)
+{
+	sim_hold = false;
+}
+
+
+/* Interrupt handler that writes a record while the TX queue is full (and lets the TX line go afterwards) */
+static void isr (void)
+{
+	writeRecord(50, DBPRINT_LEVEL_INFO);
+	release();
+}
+
+
+int main (void)
+{
+	output_t out;
+
+	/* Drop newest: the first records are kept, the marker comes in front of the next record */
+	start(OVERFLOW_DROP_NEWEST);
+	sim_hold = true;
+	for (unsigned int i = 0; i < QUEUE_RECORDS + 3; i++) writeRecord(i, DBPRINT_LEVEL_INFO);
+	sim_hold = false;
+	sim_service();
+	CHECK(dbGet_TXdropped() == 3);
+	writeRecord(20, DBPRINT_LEVEL_INFO);
+	sim_service();
+	CHECK_OUTPUT(SIM_USART1, "Record 00 ..................\r\nRecord 01 ..................\r\n"
+	             "Record 02 ..................\r\nRecord 03 ..................\r\n"
+	             "Record 04 ..................\r\nRecord 05 ..................\r\n"
+	             "Record 06 ..................\r\nRecord 07 ..................\r\n"
+	             "[3 records dropped]\r\nRecord 20 ..................\r\n");
+
+	/* Drop oldest: the newest records are kept, every missing record is counted by a marker */
+	start(OVERFLOW_DROP_OLDEST);
+	sim_hold = true;
+	for (unsigned int i = 0; i < 20; i++) writeRecord(i, DBPRINT_LEVEL_INFO);
+	sim_hold = false;
+	sim_service();
+	writeRecord(20, DBPRINT_LEVEL_INFO);
+	sim_service();
+	out = parse();
+	CHECK(out.valid);
+	CHECK(out.delivered[19] && out.delivered[20]);
+	CHECK(out.markers > 0);
+	CHECK(out.records + out.markedDrops == 21);
+	CHECK(out.markedDrops == dbGet_TXdropped());
+
+	/* Drop low priority: CRIT records replace INFO records, not the other way around */
+	start(OVERFLOW_DROP_LOW_PRIORITY);
+	sim_hold = true;
+	for (unsigned int i = 0; i < QUEUE_RECORDS; i++) writeRecord(i, DBPRINT_LEVEL_INFO);
+	for (unsigned int i = 10; i < 13; i++) writeRecord(i, DBPRINT_LEVEL_CRIT);
+	sim_hold = false;
+	sim_service();
+	out = parse();
+	CHECK(out.valid);
+	CHECK(out.delivered[10] && out.delivered[11] && out.delivered[12]);
+	CHECK(out.delivered[0]); /* The oldest record stays (it could be transmitting) */
+
+	/* Drops after the last queued marker are counted by the next one */
+	unsigned int pending = dbGet_TXdropped() - out.markedDrops;
+	unsigned int queued = 0;
+
+	sim_hold = true;
+	for (unsigned int i = 20; i < 40; i++) writeRecord(i, DBPRINT_LEVEL_CRIT);
+	for (unsigned int i = 0; i < 3; i++) writeRecord(40 + i, DBPRINT_LEVEL_INFO);
+	sim_hold = false;
+	sim_service();
+	writeRecord(60, DBPRINT_LEVEL_CRIT);
+	sim_service();
+	out = parse();
+	CHECK(out.valid);
+	/* The CRIT records that fit (5 of 45 characters) aren't replaced, an INFO record only uses the room that's left */
+	unsigned int crit = 0;
+	for (unsigned int i = 0; i < 5; i++) crit += out.delivered[20 + i];
+	for (unsigned int i = 0; i < 3; i++) queued += out.delivered[40 + i];
+	CHECK(crit == 5);
+	CHECK(queued <= 1);
+	CHECK(out.delivered[60]);
+	CHECK(out.records + out.markedDrops == 21 + 3 + pending);
+
+	/* Block: nothing is lost, the print method waits until there is room (the TX line is let go while it waits) */
+	start(OVERFLOW_BLOCK);
+	sim_hold = true;
+	for (unsigned int i = 0; i < QUEUE_RECORDS; i++) writeRecord(i, DBPRINT_LEVEL_INFO);
+	sim_preempt = release;
+	sim_preemptAt = sim_exits + 1;
+	for (unsigned int i = QUEUE_RECORDS; i < 3 * QUEUE_RECORDS; i++) writeRecord(i, DBPRINT_LEVEL_INFO);
+	sim_preempt = NULL;
+	sim_service();
+	out = parse();
+	CHECK(out.valid && (out.records == 3 * QUEUE_RECORDS) && (out.markers == 0));
+	CHECK(dbGet_TXdropped() == 0);
+
+	/* Block in an interrupt handler: waiting isn't possible, the record is dropped */
+	sim_hold = true;
+	for (unsigned int i = 0; i < QUEUE_RECORDS; i++) writeRecord(i, DBPRINT_LEVEL_INFO);
+	sim_preempt = isr;
+	sim_preemptAt = sim_exits + 1;
+	writeRecord(QUEUE_RECORDS, DBPRINT_LEVEL_INFO); /* Waits, the interrupt handler preempts it */
+	sim_preempt = NULL;
+	sim_service();
+	writeRecord(60, DBPRINT_LEVEL_INFO);
+	sim_service();
+	out = parse();
+	CHECK(out.valid && !out.delivered[50] && out.delivered[QUEUE_RECORDS] && out.delivered[60]);
+	CHECK((out.markers == 1) && (out.markedDrops == 1));
+
+	/* The marker isn't dropped itself: more drops while it's queued get their own marker */
+	start(OVERFLOW_DROP_OLDEST);
+	sim_hold = true;
+	for (unsigned int round = 0; round < 5; round++)
+	{
+		for (unsigned int i = 0; i < QUEUE_RECORDS + 2; i++) writeRecord(round * 10 + i, DBPRINT_LEVEL_INFO);
+	}
+	sim_hold = false;
+	sim_service();
+	out = parse();
+	CHECK(out.valid);
+	CHECK(out.records + out.markedDrops + (dbGet_TXdropped() - out.markedDrops) == 5 * (QUEUE_RECORDS + 2));
+
+	/* The critical sections don't depend on the length of the records */
+	lockTime(OVERFLOW_BLOCK, "OVERFLOW_BLOCK");
+	lockTime(OVERFLOW_DROP_NEWEST, "OVERFLOW_DROP_NEWEST");
+	lockTime(OVERFLOW_DROP_OLDEST, "OVERFLOW_DROP_OLDEST");
+	lockTime(OVERFLOW_DROP_LOW_PRIORITY, "OVERFLOW_DROP_LOW_PRIORITY");
+
+	return (test_result("test_overflow"));
+}
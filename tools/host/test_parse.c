@@ -0,0 +1,142 @@
+/***************************************************************************//**
+ * @file test_parse.c
+ * @brief Host test of the parser for received numbers (`init.rxParse`).
+ * @details
+ *   Built with `DBPRINT_RX_PARSE` set to `1`. The bounds of decimal and
+ *   hexadecimal numbers, signs, malformed input and a full value queue are
+ *   received one character at a time.
+ * @version 7.23
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+#if DBPRINT_RX_PARSE != 1
+#error "test_parse needs to be built with DBPRINT_RX_PARSE set to 1!"
+#endif
+
+
+/** Receive a string on USART1. */
+static void receive (const char *data)
+{
+	sim_receive(SIM_USART1, data, strlen(data));
+}
+
+
+/** Receive a string and check the parsed values and the amount of malformed numbers. */
+#define CHECK_PARSE(data, invalid, ...) \
+	check_parse(__LINE__, data, invalid, (const int32_t []){ __VA_ARGS__ }, sizeof((const int32_t []){ __VA_ARGS__ }) / sizeof(int32_t))
+
+
+/** Receive a string that doesn't complete a (valid) number. */
+#define CHECK_NONE(data, invalid) \
+	check_parse(__LINE__, data, invalid, NULL, 0)
+
+
+/** See `CHECK_PARSE`. */
+static void check_parse (int line, const char *data, uint32_t invalid, const int32_t *expected, size_t count)
+{
+	dbprint_stats_t before, after;
+	int32_t value;
+	size_t i = 0;
+
+	dbprint_stats(&before);
+	receive(data);
+	dbprint_stats(&after);
+
+	while (dbGet_RXvalue(&value))
+	{
+		if ((i >= count) || (value != expected[i]))
+		{
+			test_failures++;
+			fprintf(stderr, "%s:%d: value %zu is %ld\n", __FILE__, line, i, (long)value);
+		}
+		i++;
+	}
+
+	if (i != count)
+	{
+		test_failures++;
+		fprintf(stderr, "%s:%d: %zu values instead of %zu\n", __FILE__, line, i, count);
+	}
+	if ((after.rxInvalid - before.rxInvalid) != invalid)
+	{
+		test_failures++;
+		fprintf(stderr, "%s:%d: %lu malformed numbers instead of %lu\n", __FILE__, line,
+		        (unsigned long)(after.rxInvalid - before.rxInvalid), (unsigned long)invalid);
+	}
+}
+
+
+int main (void)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+	dbprint_stats_t stats;
+	int32_t value;
+
+	sim_reset();
+	init.banner = false;
+	init.rxParse = true;
+	dbprint_INIT_config(&init);
+
+	/* Decimal bounds */
+	CHECK_PARSE("2147483647 -2147483648 ", 0, INT32_MAX, INT32_MIN);
+	CHECK_NONE("2147483648 -2147483649 4294967295 21474836470 ", 4);
+	CHECK_NONE("99999999999999999999999 ", 1); /* Counted once */
+	CHECK_PARSE("0 -0 +5 007 -0012 ", 0, 0, 0, 5, 7, -12);
+
+	/* Hexadecimal bounds */
+	CHECK_PARSE("0xFFFFFFFF 0x80000000 0X1f 0xaBc -0x1 +0x10 ", 0, -1, INT32_MIN, 0x1F, 0xABC, -1, 0x10);
+	CHECK_NONE("0x100000000 0x0FFFFFFFF0 ", 2);
+	CHECK_PARSE("0x00000000000001 ", 0, 1); /* Leading zeros don't overflow */
+
+	/* Malformed numbers */
+	CHECK_NONE("12a 0x - + x 0xg 1-2 ", 7);
+	CHECK_PARSE("1,2;3\t4\r5\n6\f7  ,, ;\r\n", 0, 1, 2, 3, 4, 5, 6, 7);
+
+	/* A number is only complete after a separator */
+	CHECK_NONE("123", 0);
+	CHECK_PARSE("45 ", 0, 12345);
+
+	/* The value queue is full: new numbers are dropped */
+	dbprint_stats(&stats);
+	uint32_t overruns = stats.rxOverruns;
+	for (unsigned int i = 0; i < DBPRINT_RX_VALUES + 2; i++)
+	{
+		char number[16];
+		snprintf(number, sizeof(number), "%u ", i);
+		receive(number);
+	}
+	dbprint_stats(&stats);
+	CHECK(stats.rxOverruns == overruns + 2);
+	for (unsigned int i = 0; i < DBPRINT_RX_VALUES; i++) CHECK(dbGet_RXvalue(&value) && (value == (int32_t)i));
+	CHECK(!dbGet_RXvalue(&value));
+
+	/* Received lines aren't queued in this mode */
+	CHECK(dbGet_RXline(NULL) == NULL);
+
+	return (test_result("test_parse"));
+}
@@ -0,0 +1,81 @@
+/***************************************************************************//**
+ * @file test_print.c
+ * @brief Host test of the basic print methods and `string_length`.
+ * @details
+ *   Strings of every length up to 40 characters at every alignment are
+ *   printed from exactly sized heap buffers, so AddressSanitizer reports
+ *   reads past the end (other than the intentional aligned over-read).
+ * @version 7.20
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include <stdlib.h>
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+int main (void)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+
+	sim_reset();
+	dbprint_INIT_config(&init);
+	dbFlush();
+	CHECK(sim_port[SIM_USART1].length > 0);
+	sim_clearOutput(SIM_USART1);
+
+	/* Every length and alignment */
+	for (size_t length = 0; length <= 40; length++)
+	{
+		for (size_t offset = 0; offset < 4; offset++)
+		{
+			char *buffer = malloc(offset + length + 1);
+			char *string = buffer + offset;
+
+			for (size_t i = 0; i < length; i++) string[i] = (char)('a' + (i % 26));
+			string[length] = '\0';
+
+			dbprint(string);
+			dbFlush();
+			CHECK(sim_port[SIM_USART1].length == length);
+			CHECK(memcmp(sim_port[SIM_USART1].output, string, length) == 0);
+			sim_clearOutput(SIM_USART1);
+
+			free(buffer);
+		}
+	}
+
+	/* Numbers and records */
+	dbprintInt(-123);
+	dbprintlnInt(0);
+	dbprintInt_hex(0x1A);
+	dbprintlnInt_hex(-1);
+	dbinfo("Info");
+	dbwarnInt("Value ", 42, " units");
+	dbFlush();
+	CHECK_OUTPUT(SIM_USART1, "-1230\r\n0x001A0xFFFF FFFF\r\nINFO: Info\r\n"
+	             YELLOW_ "WARN: Value " RESET_ "42" YELLOW_ " units" RESET_ "\r\n");
+
+	return (test_result("test_print"));
+}
@@ -0,0 +1,246 @@
+/***************************************************************************//**
+ * @file test_records.c
+ * @brief Host test of the records: never split up, truncated if too long.
+ * @details
+ *   An interrupt handler that prints a `dbcrit` record preempts the print
+ *   method at the end of every critical section in turn, its record has to
+ *   end up before or after the other one, never in the middle. The amount
+ *   of critical sections per record and the time interrupts are disabled
+ *   (on the host) are printed. Long records are truncated (and counted),
+ *   long unleveled data is written as several records. Blocking mode writes
+ *   the same records directly.
+ * @version 7.10
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include <stdlib.h>
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+#define ISR_RECORD RED_ "CRIT: isr" RESET_ "\r\n"
+
+
+static char text[301];
+static char expected[1024];
+
+
+/* Interrupt handler that preempts the print method */
+static void isr (void)
+{
+	dbcrit("isr");
+}
+
+
+/* Check that the output of "print" is "expected" and the record of the ISR is never inside it */
+static void preempt (void (*print) (void), const char *expected, const char *name)
+{
+	size_t length = strlen(expected);
+	size_t isrLength = sizeof(ISR_RECORD) - 1;
+	unsigned long exits = 0;
+
+	/* Amount of critical sections of the print method itself */
+	sim_preempt = NULL;
+	unsigned long start = sim_exits;
+	print();
+	sim_service();
+	exits = sim_exits - start;
+	CHECK((sim_port[SIM_USART1].length == length) && (memcmp(sim_port[SIM_USART1].output, expected, length) == 0));
+	sim_clearOutput(SIM_USART1);
+
+	for (unsigned long at = 1; at <= exits; at++)
+	{
+		const char *output = sim_port[SIM_USART1].output;
+
+		sim_preempt = isr;
+		sim_preemptAt = sim_exits + at;
+		print();
+		sim_service();
+		sim_preempt = NULL;
+
+		bool before = (memcmp(output, ISR_RECORD, isrLength) == 0) && (memcmp(output + isrLength, expected, length) == 0);
+		bool after = (memcmp(output, expected, length) == 0) && (memcmp(output + length, ISR_RECORD, isrLength) == 0);
+
+		if ((sim_port[SIM_USART1].length != length + isrLength) || !(before || after))
+		{
+			test_failures++;
+			fprintf(stderr, "%s: preempted after critical section %lu: \"%.*s\"\n", name, at,
+			        (int)sim_port[SIM_USART1].length, output);
+		}
+		sim_clearOutput(SIM_USART1);
+	}
+}
+
+
+static void printLong (void) { dbinfo(&text[100]); /* 200 characters */ }
+static void printShort (void) { dbinfo("Short"); }
+static void printLine (void) { dbprintln("Line"); }
+static void printInt (void) { dbprintInt(-123); }
+static void printlnInt (void) { dbprintlnInt(-123); }
+static void printHex (void) { dbprintInt_hex(0x1234ABCD); }
+static void printlnHex (void) { dbprintlnInt_hex(0x1A); }
+static void printColor (void) { dbprint_color("Green", GREEN); }
+static void printlnColor (void) { dbprintln_color("Blue", BLUE); }
+static void printWarnInt (void) { dbwarnInt("Value ", -42, " units"); }
+static void printCritHex (void) { dbcritInt_hex("Register ", 0x55, ""); }
+
+
+/* Check the output of USART1 (and discard it) */
+static void expect (const char *string, const char *name)
+{
+	size_t length = strlen(string);
+
+	if ((sim_port[SIM_USART1].length != length) || (memcmp(sim_port[SIM_USART1].output, string, length) != 0))
+	{
+		test_failures++;
+		fprintf(stderr, "test_records: %s: \"%.*s\"\n", name, (int)sim_port[SIM_USART1].length, sim_port[SIM_USART1].output);
+	}
+	sim_clearOutput(SIM_USART1);
+}
+
+
+/* Records written in blocking mode (the same layout as in interrupt mode) */
+static void blocking (void)
+{
+	dbwarn("Battery voltage is low");
+	expect(YELLOW_ "WARN: Battery voltage is low" RESET_ "\r\n", "dbwarn");
+
+	dbwarnInt("Value ", -42, " units");
+	expect(YELLOW_ "WARN: Value " RESET_ "-42" YELLOW_ " units" RESET_ "\r\n", "dbwarnInt");
+
+	dbinfoInt_hex("Device ID: ", 0x1234ABCD, "");
+	expect("INFO: Device ID: 0x1234 ABCD\r\n", "dbinfoInt_hex (eight nibbles)");
+
+	dbcritInt("Minimum ", INT32_MIN, " (INT32_MIN)");
+	expect(RED_ "CRIT: Minimum " RESET_ "-2147483648" RED_ " (INT32_MIN)" RESET_ "\r\n", "dbcritInt (INT32_MIN)");
+
+	dbinfo(text);
+	snprintf(expected, sizeof(expected), "INFO: %s\r\n", text);
+	expect(expected, "dbinfo (not truncated)");
+}
+
+
+int main (void)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+
+	for (int i = 0; i < 300; i++) text[i] = (char)('A' + (i % 26));
+
+	sim_reset();
+	dbprint_INIT_config(&init);
+	sim_service();
+	sim_clearOutput(SIM_USART1); /* Welcome banner */
+
+	/* Every print method writes one unit */
+	snprintf(expected, sizeof(expected), "INFO: %s\r\n", &text[100]);
+	preempt(printLong, expected, "dbinfo (200 characters)");
+	preempt(printShort, "INFO: Short\r\n", "dbinfo");
+	preempt(printLine, "Line\r\n", "dbprintln");
+	preempt(printInt, "-123", "dbprintInt");
+	preempt(printlnInt, "-123\r\n", "dbprintlnInt");
+	preempt(printHex, "0x1234 ABCD", "dbprintInt_hex");
+	preempt(printlnHex, "0x001A\r\n", "dbprintlnInt_hex");
+	preempt(printColor, "\x1b[32mGreen" RESET_, "dbprint_color");
+	preempt(printlnColor, "\x1b[34mBlue" RESET_ "\r\n", "dbprintln_color");
+	preempt(printWarnInt, YELLOW_ "WARN: Value " RESET_ "-42" YELLOW_ " units" RESET_ "\r\n", "dbwarnInt");
+	preempt(printCritHex, RED_ "CRIT: Register " RESET_ "0x0055\r\n", "dbcritInt_hex");
+
+	/* The critical sections of a record don't depend on its length */
+	unsigned long start = sim_exits;
+	sim_hold = true;
+	printShort();
+	unsigned long shortExits = sim_exits - start;
+	start = sim_exits;
+	printLong();
+	unsigned long longExits = sim_exits - start;
+	sim_hold = false;
+	sim_service();
+	sim_clearOutput(SIM_USART1);
+	CHECK(shortExits == longExits);
+
+	memset(&sim_lock, 0, sizeof(sim_lock));
+	for (int i = 0; i < 1000; i++) printLong();
+	sim_service();
+	sim_clearOutput(SIM_USART1);
+	printf("test_records: %lu critical section(s) per record, interrupts disabled %.0f ns on average, %llu ns at most (host)\n",
+	       longExits, (double)sim_lock.total / sim_lock.count, (unsigned long long)sim_lock.max);
+
+	/* Longer records are truncated to DBPRINT_RECORD_SIZE characters (and counted) */
+	dbprint_stats_t stats;
+	dbprintStats_reset();
+	dbinfo(text);
+	dbwarnInt(text, 1, "");
+	sim_service();
+	snprintf(expected, sizeof(expected), "INFO: %.*s" RESET_ "[truncated]\r\n", DBPRINT_RECORD_SIZE - 23, text);
+	CHECK(strlen(expected) == DBPRINT_RECORD_SIZE);
+	snprintf(expected + DBPRINT_RECORD_SIZE, sizeof(expected) - DBPRINT_RECORD_SIZE, YELLOW_ "WARN: %.*s" RESET_ "[truncated]\r\n",
+	         DBPRINT_RECORD_SIZE - 17 - (int)strlen(YELLOW_ "WARN: "), text);
+	CHECK((sim_port[SIM_USART1].length == 2 * DBPRINT_RECORD_SIZE) &&
+	      (memcmp(sim_port[SIM_USART1].output, expected, 2 * DBPRINT_RECORD_SIZE) == 0));
+	dbprint_stats(&stats);
+	CHECK(stats.truncated == 2);
+	sim_clearOutput(SIM_USART1);
+
+	/* Longer unleveled data is written as several records, nothing is lost */
+	dbprint(text);
+	dbprintln(text);
+	dbprint_color(text, GREEN);
+	sim_service();
+	snprintf(expected, sizeof(expected), "%s%s\r\n\x1b[32m%s" RESET_, text, text, text);
+	CHECK((sim_port[SIM_USART1].length == strlen(expected)) &&
+	      (memcmp(sim_port[SIM_USART1].output, expected, strlen(expected)) == 0));
+	dbprint_stats(&stats);
+	CHECK(stats.truncated == 2);
+	sim_clearOutput(SIM_USART1);
+
+	/* An interrupt handler can only print between the records of split up data */
+	sim_preempt = isr;
+	sim_preemptAt = sim_exits + 1;
+	dbprint(text);
+	sim_preempt = NULL;
+	sim_service();
+	const char *output = sim_port[SIM_USART1].output;
+	size_t isrLength = sizeof(ISR_RECORD) - 1;
+	CHECK(sim_port[SIM_USART1].length == 300 + isrLength);
+	CHECK((memcmp(output, ISR_RECORD, isrLength) == 0) ||
+	      (memcmp(output + DBPRINT_RECORD_SIZE, ISR_RECORD, isrLength) == 0) ||
+	      (memcmp(output + 300, ISR_RECORD, isrLength) == 0));
+	sim_clearOutput(SIM_USART1);
+
+	/* A record of exactly DBPRINT_RECORD_SIZE characters isn't truncated */
+	text[DBPRINT_RECORD_SIZE] = '\0';
+	dbprint(text);
+	sim_service();
+	CHECK((sim_port[SIM_USART1].length == DBPRINT_RECORD_SIZE) &&
+	      (memcmp(sim_port[SIM_USART1].output, text, DBPRINT_RECORD_SIZE) == 0));
+	sim_clearOutput(SIM_USART1);
+
+	/* Blocking mode writes the same records directly */
+	sim_reset();
+	dbprint_INIT(USART1, 4, true, false);
+	sim_clearOutput(SIM_USART1); /* Welcome banner */
+	blocking();
+
+	return (test_result("test_records"));
+}
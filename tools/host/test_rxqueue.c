@@ -0,0 +1,153 @@
+/***************************************************************************//**
+ * @file test_rxqueue.c
+ * @brief Host test of the RX queue (received lines).
+ * @details
+ *   Lines are received until the RX queue is full, the lines after that are
+ *   dropped as a whole (and counted in the `rxOverruns` statistic) until a
+ *   line is released again. Lines returned by `dbGet_RXline` don't change
+ *   while more data is received.
+ * @version 7.22
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+/** Receive a string on USART1. */
+static void receive (const char *data)
+{
+	sim_receive(SIM_USART1, data, strlen(data));
+}
+
+
+/** Check the oldest line in the RX queue and release it. */
+static void checkLine (const char *expected)
+{
+	uint32_t length = 0;
+	char *line = dbGet_RXline(&length);
+
+	CHECK(line != NULL);
+	if (line == NULL) return;
+	CHECK(length == strlen(expected));
+	CHECK(strcmp(line, expected) == 0);
+	dbRelease_RXline();
+}
+
+
+/** Amount of lost received data so far. */
+static uint32_t overruns (void)
+{
+	dbprint_stats_t stats;
+
+	dbprint_stats(&stats);
+	return (stats.rxOverruns);
+}
+
+
+int main (void)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+	char buffer[DBPRINT_BUFFER_SIZE];
+
+	sim_reset();
+	init.banner = false;
+	dbprint_INIT_config(&init);
+
+	/* Empty queue */
+	CHECK(!dbGet_RXstatus());
+	CHECK(dbGet_RXline(NULL) == NULL);
+	dbRelease_RXline(); /* Nothing to release */
+	CHECK(dbGet_RXline(NULL) == NULL);
+
+	/* Fill the queue (CR and FF end a line), the next lines are dropped as a whole */
+	for (unsigned int i = 0; i < DBPRINT_RX_LINES; i++)
+	{
+		char line[] = "Line 0\r";
+		line[5] = (char)('0' + i);
+		if (i == 1) line[6] = '\f';
+		receive(line);
+	}
+	CHECK(overruns() == 0);
+	receive("Dropped line\r");
+	receive("Another dropped line\r");
+	CHECK(overruns() == 2);
+
+	/* The returned line doesn't change while data is received, releasing it makes room */
+	uint32_t length = 0;
+	char *first = dbGet_RXline(&length);
+	CHECK((first != NULL) && (length == 6) && (strcmp(first, "Line 0") == 0));
+	receive("Also dropped\r");
+	CHECK((first != NULL) && (strcmp(first, "Line 0") == 0));
+	dbRelease_RXline();
+	CHECK(overruns() == 3);
+
+	receive("Line 4\r");
+	for (unsigned int i = 1; i <= DBPRINT_RX_LINES; i++)
+	{
+		char line[] = "Line 0";
+		line[5] = (char)('0' + i);
+		checkLine(line);
+	}
+	CHECK(dbGet_RXline(NULL) == NULL);
+
+	/* A line that is dropped while it's being received doesn't leave a fragment behind */
+	for (unsigned int i = 0; i < DBPRINT_RX_LINES; i++) receive("Full\r");
+	receive("Dropped ");
+	dbRelease_RXline(); /* Room in the queue, but this line started while it was full */
+	receive("until its end\r");
+	receive("Next\r");
+	for (unsigned int i = 1; i < DBPRINT_RX_LINES; i++) checkLine("Full");
+	checkLine("Next");
+	CHECK(dbGet_RXline(NULL) == NULL);
+	CHECK(overruns() == 4);
+
+	/* Long lines are split when the line buffer is full */
+	char longLine[DBPRINT_BUFFER_SIZE + 10];
+	for (unsigned int i = 0; i < sizeof(longLine) - 2; i++) longLine[i] = (char)('a' + (i % 26));
+	longLine[sizeof(longLine) - 2] = '\r';
+	longLine[sizeof(longLine) - 1] = '\0';
+	receive(longLine);
+	CHECK(dbGet_RXline(&length) != NULL);
+	CHECK(length == DBPRINT_BUFFER_SIZE - 2);
+	dbRelease_RXline();
+	CHECK(dbGet_RXline(&length) != NULL);
+	CHECK(length == (sizeof(longLine) - 2) - (DBPRINT_BUFFER_SIZE - 2));
+	dbRelease_RXline();
+	CHECK(overruns() == 4);
+
+	/* The copying getters work on top of the queue */
+	receive("Copied\r");
+	CHECK(dbGet_RXstatus());
+	dbGet_RXbuffer(buffer);
+	CHECK(strcmp(buffer, "Copied") == 0);
+	CHECK(!dbGet_RXstatus());
+
+	/* Characters lost in the RX buffer of the USART are counted too */
+	USART1->STATUS |= USART_STATUS_RXDATAV;
+	receive("x");
+	CHECK(overruns() == 5);
+
+	return (test_result("test_rxqueue"));
+}
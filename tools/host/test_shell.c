@@ -0,0 +1,146 @@
+/***************************************************************************//**
+ * @file test_shell.c
+ * @brief Host test of the command shell (`dbShell`) with a table generated by `dbshellgen`.
+ * @details
+ *   Every command of `test_shell.txt` has to reach its own handler (the hash
+ *   of `dbshellgen` and `shell_hash` agree). Unknown commands, `help`, empty
+ *   lines and lines with too many arguments are also checked.
+ * @version 7.24
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+/** Table generated from `test_shell.txt`. */
+extern const dbprint_shell_t dbshell;
+
+/** Handler that was called last (`NULL` - none). */
+static const char *called;
+
+/** Arguments of that call. */
+static uint32_t calledArgc;
+static char calledArgv[DBPRINT_SHELL_ARGS][16];
+
+
+/** Handler of a command: remember the command and its arguments. */
+#define HANDLER(name)                                                \
+	void cmd_##name (dbprint_t *db, uint32_t argc, char *argv[]);    \
+	void cmd_##name (dbprint_t *db, uint32_t argc, char *argv[])     \
+	{                                                                \
+		called = #name;                                              \
+		calledArgc = argc;                                           \
+		for (uint32_t i = 0; i < argc; i++)                          \
+		{                                                            \
+			snprintf(calledArgv[i], sizeof(calledArgv[i]), "%s", argv[i]); \
+		}                                                            \
+	}
+
+HANDLER(led) HANDLER(reset) HANDLER(status) HANDLER(version) HANDLER(baud) HANDLER(echo)
+HANDLER(dump) HANDLER(read) HANDLER(write) HANDLER(erase) HANDLER(sleep) HANDLER(adc)
+HANDLER(dac) HANDLER(pwm) HANDLER(gpio) HANDLER(timer) HANDLER(rtc) HANDLER(temp)
+HANDLER(vdd) HANDLER(stats) HANDLER(clear) HANDLER(log)
+
+
+/** Receive a line on USART1 and execute it. */
+static void execute (const char *line)
+{
+	called = NULL;
+	calledArgc = 0;
+	sim_receive(SIM_USART1, line, strlen(line));
+	CHECK(dbShell(&dbshell));
+	CHECK(!dbShell(&dbshell));
+	dbFlush();
+}
+
+
+int main (void)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+	char line[64];
+
+	sim_reset();
+	init.banner = false;
+	dbprint_INIT_config(&init);
+
+	CHECK(!dbShell(&dbshell)); /* Nothing received */
+
+	/* Every command reaches its own handler */
+	unsigned int commands = 0;
+	for (uint32_t i = 0; i < dbshell.size; i++)
+	{
+		const char *name = dbshell.slots[i].name;
+		if (name == NULL) continue;
+
+		snprintf(line, sizeof(line), "%s\r", name);
+		execute(line);
+		CHECK((called != NULL) && (strcmp(called, name) == 0) && (calledArgc == 1));
+		CHECK(sim_port[SIM_USART1].length == 0);
+		commands++;
+	}
+	CHECK(commands == 22);
+
+	/* Arguments (spaces and tabs) */
+	execute("  led \t on\t 42  \r");
+	CHECK((called != NULL) && (strcmp(called, "led") == 0) && (calledArgc == 3));
+	CHECK((strcmp(calledArgv[1], "on") == 0) && (strcmp(calledArgv[2], "42") == 0));
+
+	/* Unknown commands (also a prefix of a command) and an empty line */
+	execute("ledx\r");
+	CHECK(called == NULL);
+	CHECK_OUTPUT(SIM_USART1, YELLOW_ "WARN: Unknown command: ledx" RESET_ "\r\n");
+	execute("le\r");
+	CHECK(called == NULL);
+	sim_clearOutput(SIM_USART1);
+	execute(" \t \r");
+	CHECK((called == NULL) && (sim_port[SIM_USART1].length == 0));
+
+	/* Help lists every command */
+	execute("help\r");
+	CHECK(called == NULL);
+	sim_port[SIM_USART1].output[sim_port[SIM_USART1].length] = '\0';
+	for (uint32_t i = 0; i < dbshell.size; i++)
+	{
+		if (dbshell.slots[i].name == NULL) continue;
+		snprintf(line, sizeof(line), "%s - %s\r\n", dbshell.slots[i].name, dbshell.slots[i].help);
+		CHECK(strstr(sim_port[SIM_USART1].output, line) != NULL);
+	}
+	sim_clearOutput(SIM_USART1);
+
+	/* At most DBPRINT_SHELL_ARGS arguments (including the command) */
+	strcpy(line, "echo");
+	for (unsigned int i = 1; i < DBPRINT_SHELL_ARGS; i++) strcat(line, " a");
+	strcat(line, "\r");
+	execute(line);
+	CHECK((called != NULL) && (calledArgc == DBPRINT_SHELL_ARGS));
+
+	line[strlen(line) - 1] = '\0';
+	strcat(line, " b\r");
+	execute(line);
+	CHECK(called == NULL);
+	CHECK_OUTPUT(SIM_USART1, YELLOW_ "WARN: Too many arguments: echo" RESET_ "\r\n");
+
+	return (test_result("test_shell"));
+}
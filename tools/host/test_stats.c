@@ -0,0 +1,168 @@
+/***************************************************************************//**
+ * @file test_stats.c
+ * @brief Host test of the statistics of the logging path (`dbprint_stats`).
+ * @details
+ *   The counters have to start at zero, count the characters queued and
+ *   sent (the output), the records per level (not the unleveled data or
+ *   the `dbtrace` statements removed by `DBPRINT_LEVEL`), the high-water
+ *   mark of the TX queue, the dropped records and the lost received data
+ *   (RX buffer of the USART or RX queue full), per instance. After
+ *   `dbprintStats_reset` they have to be zero again.
+ * @version 7.22
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+
+
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+/* Amount of records written while the TX line is held to overflow the TX queue */
+#define FLOOD 40
+
+
+/** Check that all of the counters are zero. */
+static void checkZero (const dbprint_stats_t *stats)
+{
+	const dbprint_stats_t zero = { 0 };
+
+	CHECK(memcmp(stats, &zero, sizeof(zero)) == 0);
+}
+
+
+/** Receive a string on USART1. */
+static void receive (const char *data)
+{
+	sim_receive(SIM_USART1, data, strlen(data));
+}
+
+
+int main (void)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+	dbprint_stats_t stats;
+
+	sim_reset();
+	init.banner = false;
+	init.overflow = OVERFLOW_DROP_NEWEST;
+	dbprint_INIT_config(&init);
+
+	dbprint_stats(&stats);
+	checkZero(&stats);
+
+	/* Records per level (unleveled data isn't counted, dbtrace is removed at DBPRINT_LEVEL_INFO) */
+	dbcrit("Critical");
+	dbwarn("Warning");
+	dbwarnInt("Value ", 42, "");
+	dbinfo("Info");
+	dbinfoInt_hex("Value ", 42, "");
+	dbinfo("Info");
+	dbtrace("Trace");
+	dbprintln("Unleveled");
+	dbFlush();
+
+	dbprint_stats(&stats);
+	CHECK(stats.records[DBPRINT_LEVEL_CRIT - 1] == 1);
+	CHECK(stats.records[DBPRINT_LEVEL_WARN - 1] == 2);
+	CHECK(stats.records[DBPRINT_LEVEL_INFO - 1] == 3);
+	CHECK(stats.records[DBPRINT_LEVEL_TRACE - 1] == 0);
+
+	/* Every queued character is sent (the output) */
+	CHECK(stats.queued == sim_port[SIM_USART1].length);
+	CHECK(stats.sent == sim_port[SIM_USART1].length);
+	CHECK(stats.dropped == 0);
+	CHECK(stats.rxOverruns == 0);
+
+	/* High-water mark: the records written while the TX line is held */
+	uint32_t highWater = stats.highWater;
+	uint32_t queued = stats.queued;
+	sim_clearOutput(SIM_USART1);
+	sim_hold = true;
+	for (int i = 0; i < 5; i++) dbinfo("Battery voltage: 3300 mV");
+	sim_hold = false;
+	dbFlush();
+
+	dbprint_stats(&stats);
+	uint32_t written = stats.queued - queued;
+	CHECK(written == 5 * strlen("INFO: Battery voltage: 3300 mV\r\n"));
+	CHECK(written == sim_port[SIM_USART1].length);
+	CHECK(stats.highWater >= highWater);
+	CHECK((stats.highWater >= (written - 1)) && (stats.highWater <= written)); /* The first character can already be in the USART */
+
+	/* Drops: more records than the TX queue can hold, the high-water mark stays within the TX queue */
+	sim_clearOutput(SIM_USART1);
+	sim_hold = true;
+	for (int i = 0; i < FLOOD; i++) dbinfo("Battery voltage: 3300 mV");
+	sim_hold = false;
+	dbFlush();
+	dbinfo("Marker");
+	dbFlush();
+
+	dbprint_stats(&stats);
+	CHECK(stats.dropped > 0);
+	CHECK(stats.dropped == dbGet_TXdropped());
+	CHECK(stats.highWater <= DBPRINT_TX_BUFFER_SIZE);
+	CHECK(stats.highWater > (DBPRINT_TX_BUFFER_SIZE - strlen("INFO: Battery voltage: 3300 mV\r\n")));
+	CHECK(stats.records[DBPRINT_LEVEL_INFO - 1] == 3 + 5 + FLOOD + 1); /* Dropped records are counted too */
+	CHECK(stats.queued == stats.sent);
+
+	char marker[32];
+	snprintf(marker, sizeof(marker), "[%lu records dropped]\r\n", (unsigned long)stats.dropped);
+	CHECK(strstr(sim_port[SIM_USART1].output, marker) != NULL);
+
+	/* RX overruns: a character that wasn't read yet (RX buffer of the USART full) */
+	sim_hold = true;
+	receive("ab");
+	sim_hold = false;
+	sim_service();
+	dbprint_stats(&stats);
+	CHECK(stats.rxOverruns == 1);
+	CHECK(stats.rxInterrupts > 0);
+
+	/* RX overruns: lines dropped because the RX queue is full */
+	receive("\r");
+	for (unsigned int i = 1; i < DBPRINT_RX_LINES; i++) receive("Line\r");
+	receive("Dropped\r");
+	receive("Dropped\r");
+	dbprint_stats(&stats);
+	CHECK(stats.rxOverruns == 3);
+
+	/* Per instance: the counters of USART0 aren't touched */
+	dbprint_t usart0;
+	dbprint_init_t init0 = DBPRINT_INIT_DEFAULT;
+	init0.pointer = USART0;
+	init0.location = 0;
+	init0.banner = false;
+	dbprint_INIT_config_ctx(&usart0, &init0);
+	dbprint_stats_ctx(&usart0, &stats);
+	checkZero(&stats);
+
+	/* Reset */
+	dbprintStats_reset();
+	dbprint_stats(&stats);
+	checkZero(&stats);
+
+	return (test_result("test_stats"));
+}
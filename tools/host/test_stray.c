@@ -0,0 +1,103 @@
+/***************************************************************************//**
+ * @file test_stray.c
+ * @brief Host test of interrupts of peripherals that aren't used by an instance.
+ * @details
+ *   The USART0/1 RX/TX and LEUART0 interrupt handlers are called (pending
+ *   interrupts and pending flags) before and after an instance is
+ *   initialized on USART1 only. They have to ignore and disable the
+ *   interrupt instead of using a `NULL` instance or firing forever.
+ *   Without `DBPRINT_LEUART` the LEUART0 interrupt isn't handled by dbprint.
+ * @version 7.22
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include "em_leuart.h"
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+/** Interrupts that aren't served by an instance yet. */
+static const IRQn_Type unused[] = { USART0_RX_IRQn, USART0_TX_IRQn, LEUART0_IRQn };
+
+/** Calls of the LEUART0 handler per stray interrupt (it only exists with `DBPRINT_LEUART`). */
+#if DBPRINT_LEUART == 1
+#define LEUART_CALLS 1
+#else
+#define LEUART_CALLS 0
+#endif
+
+
+/** Make the interrupts of USART0 and LEUART0 pending (flags and NVIC), they are handled once and disabled. */
+static void stray (void)
+{
+	USART0->IEN = USART_IEN_TXBL | USART_IEN_RXDATAV;
+	USART0->IF = USART_IF_TXBL | USART_IF_RXDATAV;
+	LEUART0->IEN = LEUART_IEN_TXBL;
+	LEUART0->IF = LEUART_IF_TXBL;
+
+	unsigned long tx = sim_port[SIM_USART0].txInterrupts;
+	unsigned long rx = sim_port[SIM_USART0].rxInterrupts;
+	unsigned long le = sim_port[SIM_LEUART0].txInterrupts;
+
+	for (unsigned int i = 0; i < sizeof(unused) / sizeof(unused[0]); i++)
+	{
+		NVIC_EnableIRQ(unused[i]);
+		NVIC_SetPendingIRQ(unused[i]);
+	}
+
+	CHECK(sim_port[SIM_USART0].txInterrupts == tx + 1);
+	CHECK(sim_port[SIM_USART0].rxInterrupts == rx + 1);
+	CHECK(sim_port[SIM_LEUART0].txInterrupts == le + LEUART_CALLS);
+}
+
+
+int main (void)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+
+	/* Before any instance is initialized (also USART1) */
+	sim_reset();
+	stray();
+	USART1->IEN = USART_IEN_TXBL;
+	USART1->IF = USART_IF_TXBL;
+	NVIC_EnableIRQ(USART1_TX_IRQn);
+	NVIC_EnableIRQ(USART1_RX_IRQn);
+	NVIC_SetPendingIRQ(USART1_RX_IRQn);
+	CHECK(sim_port[SIM_USART1].txInterrupts == 1);
+	CHECK(sim_port[SIM_USART1].rxInterrupts == 1);
+	CHECK(sim_port[SIM_USART1].length == 0);
+
+	/* An instance on USART1 keeps working, USART0 and LEUART0 are still ignored */
+	sim_reset();
+	init.banner = false;
+	dbprint_INIT_config(&init);
+	stray();
+	dbprintln("Still working");
+	stray();
+	dbFlush();
+	CHECK_OUTPUT(SIM_USART1, "Still working\r\n");
+	CHECK(sim_port[SIM_USART0].length == 0);
+
+	return (test_result("test_stray"));
+}
@@ -0,0 +1,202 @@
+/***************************************************************************//**
+ * @file test_stress.c
+ * @brief Randomized stress test of the TX queue with preemption and overflows.
+ * @details
+ *   The main code writes records of random levels and lengths while an
+ *   interrupt handler that also writes records preempts it after a random
+ *   critical section, again and again. The TX line is randomly held
+ *   (`sim_hold`) so the TX queue overflows, for every overflow policy. The
+ *   output has to consist of whole records (in order per writer) and
+ *   `[N records dropped]` markers that account for every missing record.
+ *   The seed can be given as argument (it's printed if a check fails).
+ * @version 7.22
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include <stdlib.h>
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+/* Records written by the main code per policy */
+#define RECORDS 3000
+
+/* Longest padding of a record */
+#define PADDING 80
+
+
+/* Records written per writer ('M' - main code, 'I' - interrupt handler) */
+static unsigned int written[2];
+
+
+/* Random number in [0, n[ */
+static unsigned int randomBelow (unsigned int n)
+{
+	return ((unsigned int)rand() % n);
+}
+
+
+/* Write a record "#<writer><number>:<length>:" + <length> dots with a random level (or unleveled) */
+static void writeRecord (char writer)
+{
+	static const char dots[PADDING + 1] =
+		"................................................................................";
+	char message[PADDING + 32];
+	unsigned int length = randomBelow(PADDING + 1);
+	unsigned int number = written[writer == 'I']++;
+
+	snprintf(message, sizeof(message), "#%c%u:%u:%s", writer, number, length, &dots[PADDING - length]);
+
+	switch (randomBelow(4))
+	{
+		case 0: dbcrit(message); break;
+		case 1: dbwarn(message); break;
+		case 2: dbinfo(message); break;
+		default: dbprintln(message);
+	}
+}
+
+
+/* Interrupt handler: write a record and preempt the main code again later */
+static void isr (void)
+{
+	writeRecord('I');
+	sim_preemptAt = sim_exits + 1 + randomBelow(8);
+}
+
+
+/* Check the output of USART1 (and discard it), returns the sum of the counts of the markers */
+static unsigned int parse (unsigned int delivered[2])
+{
+	char *text = sim_port[SIM_USART1].output;
+	size_t length = sim_port[SIM_USART1].length;
+	int last[2] = { -1, -1 };
+	unsigned int marked = 0;
+
+	delivered[0] = 0;
+	delivered[1] = 0;
+
+	for (size_t start = 0; start < length; )
+	{
+		char *end = memchr(&text[start], '\n', length - start);
+		if (end == NULL)
+		{
+			CHECK(end != NULL); /* The output ends in the middle of a record */
+			break;
+		}
+
+		char *record = memchr(&text[start], '#', (size_t)(end - &text[start]));
+		unsigned int count, number, padding;
+		char writer;
+		int header;
+
+		if (sscanf(&text[start], "[%u records dropped]\r", &count) == 1)
+		{
+			marked += count;
+		}
+		else if ((record != NULL) && (sscanf(record, "#%c%u:%u:%n", &writer, &number, &padding, &header) == 3) &&
+		         ((writer == 'M') || (writer == 'I')))
+		{
+			/* In order per writer, all the padding (a split or mixed up record has the wrong amount) */
+			unsigned int dots = 0;
+			while (record[header + dots] == '.') dots++;
+
+			CHECK((int)number > last[writer == 'I']);
+			CHECK(dots == padding);
+			last[writer == 'I'] = (int)number;
+			delivered[writer == 'I']++;
+		}
+		else
+		{
+			fprintf(stderr, "test_stress: invalid line \"%.*s\"\n", (int)(end - &text[start]), &text[start]);
+			test_failures++;
+		}
+
+		start = (size_t)(end - text) + 1;
+	}
+
+	sim_clearOutput(SIM_USART1);
+	return (marked);
+}
+
+
+/* Run the stress test with an overflow policy */
+static void run (dbprint_overflow_t overflow, const char *name)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+	unsigned int delivered[2];
+
+	sim_reset();
+	init.banner = false;
+	init.overflow = overflow;
+	dbprint_INIT_config(&init);
+	written[0] = 0;
+	written[1] = 0;
+
+	sim_preempt = isr;
+	sim_preemptAt = sim_exits + 1;
+
+	for (unsigned int i = 0; i < RECORDS; i++)
+	{
+		/* The TX line is held for a random burst of records */
+		if (randomBelow(16) == 0) sim_hold = !sim_hold;
+		writeRecord('M');
+	}
+
+	sim_preempt = NULL;
+	sim_hold = false;
+	sim_service();
+	dbFlush();
+
+	/* The last record gets the marker of the records dropped before it */
+	writeRecord('M');
+	dbFlush();
+
+	unsigned int marked = parse(delivered);
+	unsigned int dropped = dbGet_TXdropped();
+
+	CHECK(delivered[0] + delivered[1] + dropped == written[0] + written[1]);
+	CHECK(marked == dropped);
+	if (overflow == OVERFLOW_BLOCK) CHECK(delivered[0] == written[0]); /* Only the interrupt handler can't wait */
+
+	printf("test_stress: %-26s %u + %u records written, %u + %u delivered, %u dropped\n", name,
+	       written[0], written[1], delivered[0], delivered[1], dropped);
+}
+
+
+int main (int argc, char *argv[])
+{
+	unsigned int seed = (argc > 1) ? (unsigned int)strtoul(argv[1], NULL, 0) : 1;
+
+	srand(seed);
+
+	run(OVERFLOW_BLOCK, "OVERFLOW_BLOCK");
+	run(OVERFLOW_DROP_NEWEST, "OVERFLOW_DROP_NEWEST");
+	run(OVERFLOW_DROP_OLDEST, "OVERFLOW_DROP_OLDEST");
+	run(OVERFLOW_DROP_LOW_PRIORITY, "OVERFLOW_DROP_LOW_PRIORITY");
+
+	if (test_failures) fprintf(stderr, "test_stress: seed %u\n", seed);
+
+	return (test_result("test_stress"));
+}
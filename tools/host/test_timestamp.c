@@ -0,0 +1,146 @@
+/***************************************************************************//**
+ * @file test_timestamp.c
+ * @brief Host test of the timestamps (`init.timestamp`, `init.timestampMask`).
+ * @details
+ *   Leveled records have to start with the delta to the previous record
+ *   (`+delta `, unleveled data not), also when the counter wraps around
+ *   (8-bit mask). With mask `0` (the value of `DBPRINT_INIT_DEFAULT`) all
+ *   32 bits are used: the deltas aren't `0` and the timeouts of
+ *   `dbFlush_timeout` and `dbReadAsync` pass. Without a counter a finite
+ *   timeout is refused instead of waiting (or checking) silently.
+ * @version 7.25
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+/** Events given to the callback of the asynchronous read. */
+static unsigned int timeouts;
+static unsigned int lines;
+
+
+/** Callback of the asynchronous read: count the events. */
+static void callback (dbprint_t *db, dbprint_rxevent_t event, char *data, uint32_t length)
+{
+	if (event == RX_TIMEOUT) timeouts++;
+	else if (event == RX_LINE) lines++;
+}
+
+
+/** Reset the model and initialize the default instance with the counter starting at "start". */
+static void start (volatile uint32_t *counter, uint32_t mask, uint32_t start)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+
+	sim_reset();
+	sim_time = start;
+	init.banner = false;
+	init.timestamp = counter;
+	init.timestampMask = mask;
+	dbprint_INIT_config(&init);
+}
+
+
+int main (void)
+{
+	/* Deltas to the previous record (unleveled data doesn't get one) */
+	start(&sim_time, 0xFFFFFFFF, 1000);
+	sim_time = 1250;
+	dbinfo("First");
+	dbprintln("Unleveled");
+	sim_time = 1257;
+	dbinfoInt("Value ", 42, "");
+	dbinfo("Same time");
+	dbFlush();
+	CHECK_OUTPUT(SIM_USART1, "+250 INFO: First\r\nUnleveled\r\n+7 INFO: Value 42\r\n+0 INFO: Same time\r\n");
+
+	/* 8-bit counter: the mask handles the wrap-around */
+	start(&sim_time, 0xFF, 0xF0);
+	sim_time = 0x105;
+	dbinfo("Wrapped");
+	sim_time = 0x1FF;
+	dbinfo("Almost a period");
+	dbFlush();
+	CHECK_OUTPUT(SIM_USART1, "+21 INFO: Wrapped\r\n+250 INFO: Almost a period\r\n");
+
+	/* Mask 0 (DBPRINT_INIT_DEFAULT): all 32 bits */
+	start(&sim_time, 0, 0xFFFFFFF0);
+	sim_time = 0x00010000;
+	dbinfo("Default mask");
+	dbFlush();
+	CHECK_OUTPUT(SIM_USART1, "+65552 INFO: Default mask\r\n");
+
+	/* Mask 0: the timeout of dbFlush_timeout passes (the TX line is stuck) */
+	sim_exitTicks = 1;
+	sim_stall = true;
+	dbprintln("Stuck");
+	uint32_t begin = sim_time;
+	CHECK(!dbFlush_timeout(100));
+	CHECK(((sim_time - begin) >= 100) && ((sim_time - begin) < 200));
+	sim_stall = false;
+	sim_service();
+	CHECK(dbFlush_timeout(1000));
+	sim_clearOutput(SIM_USART1);
+	sim_exitTicks = 0;
+
+	/* Mask 0: the timeout of dbReadAsync passes */
+	timeouts = 0;
+	lines = 0;
+	CHECK(dbReadAsync(0, 50, callback, false));
+	sim_time += 49;
+	dbReadAsync_poll();
+	CHECK(timeouts == 0);
+	sim_time += 1;
+	dbReadAsync_poll();
+	CHECK(timeouts == 1);
+
+	/* Received data restarts the timeout (RX handler) */
+	sim_time += 30;
+	sim_receive(SIM_USART1, "ab", 2);
+	sim_time += 30;
+	dbReadAsync_poll();
+	CHECK(timeouts == 1);
+	sim_time += 20;
+	dbReadAsync_poll();
+	CHECK(timeouts == 2);
+	CHECK(lines == 0);
+
+	/* Without a counter: no deltas, a finite timeout is refused */
+	start(NULL, 0, 0);
+	sim_stall = true;
+	dbinfo("No counter");
+	unsigned long exits = sim_exits;
+	CHECK(!dbFlush_timeout(100));
+	CHECK(sim_exits == exits);
+	CHECK(!dbFlush_timeout(0));
+	CHECK(!dbReadAsync(0, 50, callback, false));
+	sim_stall = false;
+	sim_service();
+	dbFlush();
+	CHECK_OUTPUT(SIM_USART1, "INFO: No counter\r\n");
+
+	return (test_result("test_timestamp"));
+}
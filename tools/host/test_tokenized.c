@@ -0,0 +1,144 @@
+/***************************************************************************//**
+ * @file test_tokenized.c
+ * @brief Host test of tokenized logging (`DBPRINT_TOKENIZED`).
+ * @details
+ *   A representative log mix (`dbinfo`, `dbwarn`, `dbcrit` and their
+ *   `Int(_hex)` variants, unleveled lines and records with timestamps) is
+ *   written to USART1. The capture is written to `<dir>/token_capture.bin`
+ *   and the text the records would have printed without tokens to
+ *   `<dir>/token_expected.txt`. `make test` extracts the `dbprint_tokens`
+ *   section of this executable with `objcopy` and checks that `dbdecode`
+ *   turns the capture into the expected text. The size of the capture is
+ *   printed compared to the text.
+ * @version 7.22
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+
+
+/* Rounds of the log mix */
+#define ROUNDS 200
+
+
+static char expected[ROUNDS * 160];
+static size_t length;
+
+
+/** Append the text a record would have printed without tokens. */
+#define EXPECT(...) \
+	(length += (size_t)snprintf(&expected[length], sizeof(expected) - length, __VA_ARGS__))
+
+
+/** Write a file. */
+static int save (const char *dir, const char *name, const char *data, size_t size)
+{
+	char path[512];
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	FILE *file = fopen(path, "wb");
+	if (file == NULL) return (1);
+	fwrite(data, 1, size, file);
+	return (fclose(file) != 0);
+}
+
+
+int main (int argc, char **argv)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+	const char *dir = (argc > 1) ? argv[1] : ".";
+
+	sim_reset();
+	init.banner = false;
+	dbprint_INIT_config(&init);
+
+	/* Log mix of a sensor node: mostly info records with a value, some warnings, few errors and plain lines */
+	for (int32_t r = 0; r < ROUNDS; r++)
+	{
+		dbinfoInt("Battery voltage: ", 3300 - r, " mV");
+		EXPECT("INFO: Battery voltage: %ld mV\r\n", (long)(3300 - r));
+
+		dbinfo("Sample taken");
+		EXPECT("INFO: Sample taken\r\n");
+
+		dbinfoInt("Samples in buffer: ", r % 64, "");
+		EXPECT("INFO: Samples in buffer: %ld\r\n", (long)(r % 64));
+
+		if ((r % 4) == 0)
+		{
+			dbwarnInt("Temperature high: ", -40 + r, " C");
+			EXPECT(YELLOW_ "WARN: Temperature high: " RESET_ "%ld" YELLOW_ " C" RESET_ "\r\n", (long)(-40 + r));
+		}
+		if ((r % 10) == 0)
+		{
+			dbprintln("--- Measurement cycle ---");
+			EXPECT("--- Measurement cycle ---\r\n");
+		}
+		if ((r % 20) == 0)
+		{
+			dbinfoInt_hex("Status: ", (int32_t)(0xDEADBE00u + (uint32_t)r), "");
+			EXPECT("INFO: Status: 0x%04X %04X\r\n", 0xDEADu, (unsigned int)(0xBE00 + r));
+		}
+		if ((r % 50) == 0)
+		{
+			dbcritInt_hex("Fault register: ", 0x1A00 + r, "");
+			EXPECT(RED_ "CRIT: Fault register: " RESET_ "0x%04X\r\n", (unsigned int)(0x1A00 + r));
+			dbcrit("Sensor not responding");
+			EXPECT(RED_ "CRIT: Sensor not responding" RESET_ "\r\n");
+		}
+	}
+	dbFlush();
+
+	size_t textLength = length;
+	size_t tokenLength = sim_port[SIM_USART1].length;
+
+	/* Timestamps ("+delta " in front of the record) */
+	init.timestamp = &sim_time;
+	sim_time = 0;
+	dbprint_INIT_config(&init);
+	sim_time = 1000;
+	dbinfo("Timestamped");
+	EXPECT("+1000 INFO: Timestamped\r\n");
+	sim_time = 1000 + 200000;
+	dbwarnInt("Late by ", 12, " ms");
+	EXPECT("+200000 " YELLOW_ "WARN: Late by " RESET_ "12" YELLOW_ " ms" RESET_ "\r\n");
+	dbFlush();
+
+	CHECK(length < sizeof(expected));
+	CHECK(tokenLength < textLength);
+
+	printf("test_tokenized: %d rounds of the log mix, %zu bytes instead of %zu characters (%.1f %% of the text)\n",
+	       ROUNDS, tokenLength, textLength, 100.0 * tokenLength / textLength);
+
+	if (save(dir, "token_capture.bin", sim_port[SIM_USART1].output, sim_port[SIM_USART1].length) ||
+	    save(dir, "token_expected.txt", expected, length))
+	{
+		fprintf(stderr, "test_tokenized: can't write the captures to %s\n", dir);
+		test_failures++;
+	}
+
+	return (test_result("test_tokenized"));
+}
@@ -0,0 +1,129 @@
+/***************************************************************************//**
+ * @file test_txqueue.c
+ * @brief Host test of the non-blocking print methods (interrupt mode, TX queue).
+ * @details
+ *   While the TX line is busy (`sim_hold`, interrupts are only delivered
+ *   when the core sleeps) a print method has to return without waiting:
+ *   the core doesn't sleep, no TX interrupt runs and nothing is
+ *   transmitted during the call, the record is only copied into the TX
+ *   queue. Records of 5 and 200 characters use the same amount of critical
+ *   sections, so the time per call only grows with the copy (printed).
+ * @version 7.22
+ * @author Brecht Van Eeckhoudt
+ *
+ * ******************************************************************************
+ *
+ * @section License
+ *
+ *   **Copyright (C) 2019 - Brecht Van Eeckhoudt**
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the **GNU General Public License** as published by
+ *   the Free Software Foundation, either **version 3** of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   *A copy of the GNU General Public License can be found in the `LICENSE`
+ *   file along with this source code.*
+ *
+ ******************************************************************************/
+
+
+
+
+#define _POSIX_C_SOURCE 199309L /* clock_gettime */
+
+#include <stdlib.h>
+#include <time.h>
+#include "debug_dbprint.h"
+#include "test.h"
+
+
+/* Calls per length */
+#define CALLS 2000
+
+
+static double times[CALLS];
+
+
+/* Host time in nanoseconds */
+static double now (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e9 + ts.tv_nsec);
+}
+
+
+static int compare (const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+	return ((x > y) - (x < y));
+}
+
+
+/* Print records of "length" characters while the TX line is busy, returns the median host time per call */
+static double run (unsigned int length, unsigned long *locks)
+{
+	char text[201];
+	char expected[203];
+
+	memset(text, 'a', length);
+	text[length] = '\0';
+	snprintf(expected, sizeof(expected), "%s\r\n", text);
+
+	for (unsigned int i = 0; i < CALLS; i++)
+	{
+		unsigned long sleeps = sim_sleeps;
+		unsigned long interrupts = sim_port[SIM_USART1].txInterrupts;
+		unsigned long count = sim_lock.count;
+
+		sim_hold = true;
+		double start = now();
+		dbprintln(text);
+		times[i] = now() - start;
+
+		/* Nothing waited for or transmitted, only copied */
+		CHECK(sim_sleeps == sleeps);
+		CHECK(sim_port[SIM_USART1].txInterrupts == interrupts);
+		CHECK(sim_port[SIM_USART1].length == 0);
+		if (i == 0) *locks = sim_lock.count - count;
+		CHECK((sim_lock.count - count) == *locks);
+
+		/* The TX line catches up */
+		sim_hold = false;
+		sim_service();
+		dbFlush();
+		CHECK((sim_port[SIM_USART1].length == length + 2) && (memcmp(sim_port[SIM_USART1].output, expected, length + 2) == 0));
+		sim_clearOutput(SIM_USART1);
+	}
+
+	qsort(times, CALLS, sizeof(times[0]), compare);
+	return (times[CALLS / 2]);
+}
+
+
+int main (void)
+{
+	dbprint_init_t init = DBPRINT_INIT_DEFAULT;
+	unsigned long shortLocks, longLocks;
+
+	sim_reset();
+	init.banner = false;
+	dbprint_INIT_config(&init);
+
+	double shortTime = run(5, &shortLocks);
+	double longTime = run(200, &longLocks);
+
+	/* The same bookkeeping for both lengths */
+	CHECK(shortLocks == longLocks);
+
+	printf("test_txqueue: %lu critical section(s) per call, %.0f ns per call with 5 characters, %.0f ns with 200 "
+	       "(%.2f ns per extra character copied, host)\n", shortLocks, shortTime, longTime, (longTime - shortTime) / 195);
+
+	return (test_result("test_txqueue"));
+}